@@ -0,0 +1,123 @@
+#include "cpu_features.hpp"
+#include "blowfish_kernel.hpp"
+
+#if defined(CRYPTO_X86)
+#include <immintrin.h>
+
+// everything defined below may use avx2; the scalar inline functions of blowfish_kernel.hpp are included
+// above, so the copies other files link against never get compiled for avx2
+#if defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+namespace
+{
+	// 4 blocks of 8 bytes to their 8 32-bit halves, each read big-endian
+	inline __m256i load_halves(const uint8_t* bytes)
+	{
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		return _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes)), swap);
+	}
+
+	inline void store_halves(__m256i halves, uint8_t* bytes)
+	{
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes), _mm256_shuffle_epi8(halves, swap));
+	}
+
+	// left halves of blocks 0, 1, 4, 5, 2, 3, 6, 7 in left, the right ones in right
+	inline void load_block_halves(const uint8_t* bytes, __m256i& left, __m256i& right)
+	{
+		const __m256i low = load_halves(bytes);
+		const __m256i high = load_halves(bytes + 32);
+
+		left = _mm256_castps_si256(_mm256_shuffle_ps(
+			_mm256_castsi256_ps(low), _mm256_castsi256_ps(high), _MM_SHUFFLE(2, 0, 2, 0)));
+		right = _mm256_castps_si256(_mm256_shuffle_ps(
+			_mm256_castsi256_ps(low), _mm256_castsi256_ps(high), _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	// left || right per block, interleaving undoes the lane order of load_block_halves
+	inline void store_block_halves(__m256i left, __m256i right, uint8_t* bytes)
+	{
+		store_halves(_mm256_unpacklo_epi32(left, right), bytes);
+		store_halves(_mm256_unpackhi_epi32(left, right), bytes + 32);
+	}
+
+	inline __m256i lookup(const uint32_t* box, __m256i indices)
+	{
+		return _mm256_i32gather_epi32(reinterpret_cast<const int*>(box), indices, 4);
+	}
+
+	// ((S1[a] + S2[b]) ^ S3[c]) + S4[d] for the bytes a, b, c, d of x, most significant first
+	inline __m256i blowfish_func(__m256i x, const uint32_t* const boxes[4])
+	{
+		const __m256i byte_mask = _mm256_set1_epi32(0xff);
+
+		const __m256i first = lookup(boxes[0], _mm256_srli_epi32(x, 24));
+		const __m256i second = lookup(boxes[1], _mm256_and_si256(_mm256_srli_epi32(x, 16), byte_mask));
+		const __m256i third = lookup(boxes[2], _mm256_and_si256(_mm256_srli_epi32(x, 8), byte_mask));
+		const __m256i fourth = lookup(boxes[3], _mm256_and_si256(x, byte_mask));
+
+		return _mm256_add_epi32(_mm256_xor_si256(_mm256_add_epi32(first, second), third), fourth);
+	}
+
+	// groups_count groups of lanes per call, so the gathers of one hide the latency of the others'
+	template <uint32_t groups_count>
+	inline void crypt_groups(const uint8_t* input, uint8_t* output, const __m256i round_keys[18], const uint32_t* const boxes[4])
+	{
+		__m256i left[groups_count], right[groups_count];
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			load_block_halves(input + group * BLOWFISH_AVX2_LANES * 8, left[group], right[group]);
+		}
+
+		for (uint32_t i = 0; i < 16; i += 2)
+		{
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				left[group] = _mm256_xor_si256(left[group], round_keys[i]);
+				right[group] = _mm256_xor_si256(right[group], blowfish_func(left[group], boxes));
+				right[group] = _mm256_xor_si256(right[group], round_keys[i + 1]);
+			}
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				left[group] = _mm256_xor_si256(left[group], blowfish_func(right[group], boxes));
+			}
+		}
+
+		// the halves leave swapped
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			store_block_halves(_mm256_xor_si256(right[group], round_keys[17]),
+				_mm256_xor_si256(left[group], round_keys[16]), output + group * BLOWFISH_AVX2_LANES * 8);
+		}
+	}
+}
+
+void blowfish_crypt_blocks_avx2(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4])
+{
+	__m256i round_keys[18];
+	for (uint32_t i = 0; i < 18; ++i)
+	{
+		round_keys[i] = _mm256_set1_epi32(static_cast<int>(keys[i]));
+	}
+
+	uint64_t block = 0;
+	for (; block + 2 * BLOWFISH_AVX2_LANES <= blocks_count; block += 2 * BLOWFISH_AVX2_LANES)
+	{
+		crypt_groups<2>(input + block * 8, output + block * 8, round_keys, boxes);
+	}
+	for (; block + BLOWFISH_AVX2_LANES <= blocks_count; block += BLOWFISH_AVX2_LANES)
+	{
+		crypt_groups<1>(input + block * 8, output + block * 8, round_keys, boxes);
+	}
+
+	blowfish_crypt_blocks(input + block * 8, output + block * 8, blocks_count - block, keys, boxes);
+}
+#endif
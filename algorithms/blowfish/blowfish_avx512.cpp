@@ -0,0 +1,124 @@
+#include "cpu_features.hpp"
+#include "blowfish_kernel.hpp"
+
+#if defined(CRYPTO_X86)
+// gcc 12 flags the deliberately undefined registers inside its own avx-512 intrinsics (bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+// everything defined below may use avx-512; the scalar inline functions of blowfish_kernel.hpp are included
+// above, so the copies other files link against never get compiled for avx-512
+#if defined(__GNUC__)
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+namespace
+{
+	// 8 blocks of 8 bytes to their 16 32-bit halves, each read big-endian
+	inline __m512i load_halves(const uint8_t* bytes)
+	{
+		const __m512i swap = _mm512_set4_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203);
+		return _mm512_shuffle_epi8(_mm512_loadu_si512(bytes), swap);
+	}
+
+	inline void store_halves(__m512i halves, uint8_t* bytes)
+	{
+		const __m512i swap = _mm512_set4_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203);
+		_mm512_storeu_si512(bytes, _mm512_shuffle_epi8(halves, swap));
+	}
+
+	// left halves of 16 blocks in order in first, the right ones in second
+	inline void load_block_halves(const uint8_t* bytes, __m512i& first, __m512i& second)
+	{
+		const __m512i low = load_halves(bytes);
+		const __m512i high = load_halves(bytes + 64);
+
+		const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+		const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+		first = _mm512_permutex2var_epi32(low, even, high);
+		second = _mm512_permutex2var_epi32(low, odd, high);
+	}
+
+	// first || second per block
+	inline void store_block_halves(__m512i first, __m512i second, uint8_t* bytes)
+	{
+		const __m512i low = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+		const __m512i high = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+		store_halves(_mm512_permutex2var_epi32(first, low, second), bytes);
+		store_halves(_mm512_permutex2var_epi32(first, high, second), bytes + 64);
+	}
+
+	inline __m512i lookup(const uint32_t* box, __m512i indices)
+	{
+		return _mm512_i32gather_epi32(indices, box, 4);
+	}
+
+	inline __m512i blowfish_func(__m512i x, const uint32_t* const boxes[4])
+	{
+		const __m512i byte_mask = _mm512_set1_epi32(0xff);
+
+		const __m512i first = lookup(boxes[0], _mm512_srli_epi32(x, 24));
+		const __m512i second = lookup(boxes[1], _mm512_and_si512(_mm512_srli_epi32(x, 16), byte_mask));
+		const __m512i third = lookup(boxes[2], _mm512_and_si512(_mm512_srli_epi32(x, 8), byte_mask));
+		const __m512i fourth = lookup(boxes[3], _mm512_and_si512(x, byte_mask));
+
+		return _mm512_add_epi32(_mm512_xor_si512(_mm512_add_epi32(first, second), third), fourth);
+	}
+
+	// groups_count groups of lanes per call, so the gathers of one hide the latency of the others'
+	template <uint32_t groups_count>
+	inline void crypt_groups(const uint8_t* input, uint8_t* output, const __m512i round_keys[18], const uint32_t* const boxes[4])
+	{
+		__m512i left[groups_count], right[groups_count];
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			load_block_halves(input + group * BLOWFISH_AVX512_LANES * 8, left[group], right[group]);
+		}
+
+		for (uint32_t i = 0; i < 16; i += 2)
+		{
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				left[group] = _mm512_xor_si512(left[group], round_keys[i]);
+				right[group] = _mm512_ternarylogic_epi32(right[group], blowfish_func(left[group], boxes), round_keys[i + 1], 0x96);
+			}
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				left[group] = _mm512_xor_si512(left[group], blowfish_func(right[group], boxes));
+			}
+		}
+
+		// the halves leave swapped
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			store_block_halves(_mm512_xor_si512(right[group], round_keys[17]),
+				_mm512_xor_si512(left[group], round_keys[16]), output + group * BLOWFISH_AVX512_LANES * 8);
+		}
+	}
+}
+
+void blowfish_crypt_blocks_avx512(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4])
+{
+	__m512i round_keys[18];
+	for (uint32_t i = 0; i < 18; ++i)
+	{
+		round_keys[i] = _mm512_set1_epi32(static_cast<int>(keys[i]));
+	}
+
+	uint64_t block = 0;
+	for (; block + 2 * BLOWFISH_AVX512_LANES <= blocks_count; block += 2 * BLOWFISH_AVX512_LANES)
+	{
+		crypt_groups<2>(input + block * 8, output + block * 8, round_keys, boxes);
+	}
+	for (; block + BLOWFISH_AVX512_LANES <= blocks_count; block += BLOWFISH_AVX512_LANES)
+	{
+		crypt_groups<1>(input + block * 8, output + block * 8, round_keys, boxes);
+	}
+
+	blowfish_crypt_blocks(input + block * 8, output + block * 8, blocks_count - block, keys, boxes);
+}
+#endif
@@ -1,21 +1,26 @@
 #include "blowfish_encrypter.hpp"
 #include <string>
+#include <cstring>
 
 #include "bit_utils.hpp"
 #include <vector>
+#include <array>
 #include <functional>
+#include <algorithm>
+
+#include "kernel_table.hpp"
 
 constexpr uint32_t ROUNDS_COUNT = 16;
 constexpr uint32_t KEY_LENGTH = 4;
 
-static std::vector<uint32_t> P =
+constexpr std::array<uint32_t, 18> P =
 {
 	0x243f6a88L, 0x85a308d3L, 0x13198a2eL, 0x03707344L, 0xa4093822L, 0x299f31d0L,
 	0x082efa98L, 0xec4e6c89L, 0x452821e6L, 0x38d01377L, 0xbe5466cfL, 0x34e90c6cL,
 	0xc0ac29b7L, 0xc97c50ddL, 0x3f84d5b5L, 0xb5470917L, 0x9216d5d9L, 0x8979fb1bL,
 };
 
-static std::vector<uint32_t> S_BOX_1 =
+constexpr std::array<uint32_t, 256> S_BOX_1 =
 {
 	0xd1310ba6L, 0x98dfb5acL, 0x2ffd72dbL, 0xd01adfb7L, 0xb8e1afedL, 0x6a267e96L,
 	0xba7c9045L, 0xf12c7f99L, 0x24a19947L, 0xb3916cf7L, 0x0801f2e2L, 0x858efc16L,
@@ -62,7 +67,7 @@ static std::vector<uint32_t> S_BOX_1 =
 	0x53b02d5dL, 0xa99f8fa1L, 0x08ba4799L, 0x6e85076aL,
 };
 
-static std::vector<uint32_t> S_BOX_2 =
+constexpr std::array<uint32_t, 256> S_BOX_2 =
 {
 	0x4b7a70e9L, 0xb5b32944L, 0xdb75092eL, 0xc4192623L, 0xad6ea6b0L, 0x49a7df7dL,
 	0x9cee60b8L, 0x8fedb266L, 0xecaa8c71L, 0x699a17ffL, 0x5664526cL, 0xc2b19ee1L,
@@ -109,7 +114,7 @@ static std::vector<uint32_t> S_BOX_2 =
 	0x153e21e7L, 0x8fb03d4aL, 0xe6e39f2bL, 0xdb83adf7L,
 };
 
-static std::vector<uint32_t> S_BOX_3 =
+constexpr std::array<uint32_t, 256> S_BOX_3 =
 {
 	0xe93d5a68L, 0x948140f7L, 0xf64c261cL, 0x94692934L, 0x411520f7L, 0x7602d4f7L,
 	0xbcf46b2eL, 0xd4a20068L, 0xd4082471L, 0x3320f46aL, 0x43b7d4b7L, 0x500061afL,
@@ -156,7 +161,7 @@ static std::vector<uint32_t> S_BOX_3 =
 	0xd79a3234L, 0x92638212L, 0x670efa8eL, 0x406000e0L,
 };
 
-static std::vector<uint32_t> S_BOX_4 =
+constexpr std::array<uint32_t, 256> S_BOX_4 =
 {
 	0x3a39ce37L, 0xd3faf5cfL, 0xabc27737L, 0x5ac52d1bL, 0x5cb0679eL, 0x4fa33742L,
 	0xd3822740L, 0x99bc9bbeL, 0xd5118e9dL, 0xbf0f7315L, 0xd62d1c7eL, 0xc700c47bL,
@@ -203,14 +208,35 @@ static std::vector<uint32_t> S_BOX_4 =
 	0xb74e6132L, 0xce77e25bL, 0x578fdfe3L, 0x3ac372e6L,
 };
 
-static std::vector<std::vector<uint32_t>> S_BOX =
+constexpr std::array<std::array<uint32_t, 256>, 4> S_BOX =
 {
 	S_BOX_1, S_BOX_2, S_BOX_3, S_BOX_4,
 };
 
-blowfish_encrypter::blowfish_encrypter(const std::string& key)
-	: _key(_check_key(key))
+#if defined(CRYPTO_X86)
+constexpr kernel_table<blowfish_crypt_function> CRYPT_KERNELS =
+{
+	{ blowfish_crypt_blocks, nullptr, blowfish_crypt_blocks_avx2, blowfish_crypt_blocks_avx512 },
+};
+#else
+constexpr kernel_table<blowfish_crypt_function> CRYPT_KERNELS = { { blowfish_crypt_blocks } };
+#endif
+
+std::vector<cpu_features::isa> blowfish_encrypter::get_kernels()
+{
+	return CRYPT_KERNELS.get_supported();
+}
+
+blowfish_encrypter::blowfish_encrypter(const std::string& key, cpu_features::isa level)
+	: _kernel(CRYPT_KERNELS.select(level))
+	, _crypt(CRYPT_KERNELS.get(level))
+	, _key(_check_key(key))
 {
+	if (!cpu_features::is_supported(level))
+	{
+		throw unsupported_kernel();
+	}
+
 	_generate_keys();
 }
 
@@ -230,17 +256,75 @@ std::string blowfish_encrypter::decrypt(const std::string& message) const
 	return _internal_run(message, _e_action::decrypt);
 }
 
-std::vector<std::string> blowfish_encrypter::_build_message_blocks(const std::string& message)
+std::string blowfish_encrypter::crypt_ctr(const std::string& message, const std::string& iv) const
 {
-	std::vector<std::string> blocks;
-	size_t blocks_count = message.size() / BLOCK_SIZE * 2;
-	blocks.reserve(blocks_count);
-	for (uint64_t i = 0; i < blocks_count; ++i)
+	if (iv.size() != BLOCK_SIZE)
 	{
-		blocks.push_back(message.substr(static_cast<size_t>(i) * BLOCK_SIZE / 2, BLOCK_SIZE / 2));
+		throw invalid_iv();
 	}
 
-	return blocks;
+	uint64_t counter = 0;
+	for (char byte : iv)
+	{
+		counter = (counter << CHAR_BIT) | static_cast<uint8_t>(byte);
+	}
+
+	// keystream for a few kernel steps at a time
+	constexpr uint64_t batch_blocks = 8 * BLOWFISH_AVX512_LANES;
+	uint8_t keystream[batch_blocks * BLOCK_SIZE];
+
+	std::string output = message;
+	const uint64_t blocks_count = (message.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	for (uint64_t batch_begin = 0; batch_begin < blocks_count; batch_begin += batch_blocks)
+	{
+		const uint64_t batch_end = std::min(blocks_count, batch_begin + batch_blocks);
+		for (uint64_t block = batch_begin; block < batch_end; ++block)
+		{
+			// the counter wraps around modulo 2^64
+			uint64_t block_counter = counter + block;
+			for (uint32_t i = BLOCK_SIZE; i > 0; --i)
+			{
+				keystream[(block - batch_begin) * BLOCK_SIZE + i - 1] = static_cast<uint8_t>(block_counter);
+				block_counter >>= CHAR_BIT;
+			}
+		}
+
+		encrypt_blocks(keystream, keystream, batch_end - batch_begin);
+
+		// a block at a time, then the bytes of a partial last block
+		const uint64_t bytes_begin = batch_begin * BLOCK_SIZE;
+		const uint64_t bytes_end = std::min<uint64_t>(output.size(), batch_end * BLOCK_SIZE);
+		uint64_t i = bytes_begin;
+		for (; i + BLOCK_SIZE <= bytes_end; i += BLOCK_SIZE)
+		{
+			uint64_t data = 0, pad = 0;
+			std::memcpy(&data, &output[i], BLOCK_SIZE);
+			std::memcpy(&pad, keystream + i - bytes_begin, BLOCK_SIZE);
+			data ^= pad;
+			std::memcpy(&output[i], &data, BLOCK_SIZE);
+		}
+		for (; i < bytes_end; ++i)
+		{
+			output[i] ^= keystream[i - bytes_begin];
+		}
+	}
+
+	return output;
+}
+
+void blowfish_encrypter::encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt_blocks(input, output, blocks_count, _e_action::encrypt);
+}
+
+void blowfish_encrypter::decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt_blocks(input, output, blocks_count, _e_action::decrypt);
+}
+
+cpu_features::isa blowfish_encrypter::get_kernel() const
+{
+	return _kernel;
 }
 
 std::string blowfish_encrypter::_try_remove_padding(const std::string& message)
@@ -348,45 +432,32 @@ void blowfish_encrypter::_generate_keys()
 			_generated_boxes[i][j] = L;
 			_generated_boxes[i][j + 1L] = R;
 		}
-	}	
+	}
+
+	std::reverse_copy(_generated_keys.begin(), _generated_keys.end(), _reversed_keys.begin());
 }
 
-std::string blowfish_encrypter::_internal_run(const std::string& message, _e_action action) const
+void blowfish_encrypter::_crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count, _e_action action) const
 {
-	std::string message_to_process = _construct_padding_message(message);
-	std::vector<std::string> source_blocks = _build_message_blocks(message_to_process);
-	std::vector<uint32_t> result_blocks;
-	result_blocks.reserve(source_blocks.size());
+	if (action != _e_action::encrypt && action != _e_action::decrypt)
+	{
+		throw invalid_action();
+	}
 
-	for (uint64_t i = 0; i < source_blocks.size(); i += 2)
+	const uint32_t* const boxes[4] =
 	{
-		// TODO: test swap
-		uint32_t left = bit_utils::string_to_int32(source_blocks[i]);
-		uint32_t right = bit_utils::string_to_int32(source_blocks[i + 1L]);
+		_generated_boxes[0].data(), _generated_boxes[1].data(), _generated_boxes[2].data(), _generated_boxes[3].data(),
+	};
+	const uint32_t* keys = action == _e_action::encrypt ? _generated_keys.data() : _reversed_keys.data();
 
-		switch (action)
-		{
-		case _e_action::encrypt:
-			std::tie(left, right) = _encrypt(left, right);
-			break;
-		case _e_action::decrypt:
-			std::tie(left, right) = _decrypt(left, right);
-			break;
-		default:
-			throw invalid_action();
-		}
+	_crypt(input, output, blocks_count, keys, boxes);
+}
 
-		result_blocks.push_back(left);
-		result_blocks.push_back(right);
-	}
-	
-	std::string result_message;
-	result_message.reserve(BLOCK_SIZE / 2 * result_blocks.size());
-	
-	for (uint32_t block : result_blocks)
-	{
-		result_message += bit_utils::int32_to_string(block);
-	}
+std::string blowfish_encrypter::_internal_run(const std::string& message, _e_action action) const
+{
+	std::string result_message = _construct_padding_message(message);
+	uint8_t* data = bit_utils::stob(result_message);
+	_crypt_blocks(data, data, result_message.size() / BLOCK_SIZE, action);
 
 	if (action == _e_action::decrypt)
 	{
@@ -401,6 +472,16 @@ const char* blowfish_encrypter::invalid_key::what() const throw ()
 	return "Invalid key! Key should be no less than 4 chars";
 }
 
+const char* blowfish_encrypter::invalid_iv::what() const throw ()
+{
+	return "Invalid initial counter block! It should be exactly 8 bytes";
+}
+
+const char* blowfish_encrypter::unsupported_kernel::what() const throw ()
+{
+	return "The CPU does not support the requested Blowfish kernel!";
+}
+
 const char* blowfish_encrypter::invalid_action::what() const throw ()
 {
 	return "Invalid action passed! Encrypt logical error";
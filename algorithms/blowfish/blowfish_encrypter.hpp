@@ -2,7 +2,11 @@
 
 #include <string>
 #include <vector>
-#include <bitset>
+#include <array>
+#include <tuple>
+
+#include "blowfish_kernel.hpp"
+#include "cpu_features.hpp"
 
 constexpr uint32_t BLOCK_SIZE = 8;
 
@@ -14,12 +18,39 @@ public:
 		const char* what() const throw ();
 	};
 
-	blowfish_encrypter(const std::string& key);
+	struct invalid_iv : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct unsupported_kernel : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// the tiers with a block kernel of their own this CPU runs: scalar one block at a time, avx2 and
+	// avx512 8 and 16 blocks at once with gathered S-box lookups
+	static std::vector<cpu_features::isa> get_kernels();
+
+	// runs the best kernel at or below level, throws unsupported_kernel for a level this CPU lacks
+	blowfish_encrypter(const std::string& key, cpu_features::isa level = cpu_features::get_isa());
 	~blowfish_encrypter() = default;
 
+	// ECB
 	std::string encrypt(const std::string& message) const;
 	std::string decrypt(const std::string& message) const;
 
+	// CTR: message ^ E(iv) || E(iv + 1) || ..., iv being BLOCK_SIZE bytes read as a big-endian counter.
+	// The same call encrypts and decrypts, the output is as long as the message. Throws invalid_iv
+	std::string crypt_ctr(const std::string& message, const std::string& iv) const;
+
+	// blocks_count blocks of BLOCK_SIZE bytes each, input and output may be the same buffer
+	void encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+	void decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+
+	// the tier of the kernel in use
+	cpu_features::isa get_kernel() const;
+
 private:
 	struct invalid_action : public std::exception
 	{
@@ -33,7 +64,6 @@ private:
 		undefined,
 	};
 
-	static std::vector<std::string> _build_message_blocks(const std::string& message);
 	static std::string _try_remove_padding(const std::string& message);
 	static std::vector<uint32_t> _check_key(const std::string& key);
 	static std::string _construct_padding_message(const std::string& message);
@@ -43,11 +73,16 @@ private:
 	std::tuple<uint32_t, uint32_t> _encrypt(uint32_t left_block, uint32_t right_block) const;
 	std::tuple<uint32_t, uint32_t> _decrypt(uint32_t left_block, uint32_t right_block) const;
 
+	void _crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count, _e_action action) const;
 	std::string _internal_run(const std::string& message, _e_action action) const;
 
 	void _generate_keys();
 
+	cpu_features::isa _kernel;
+	blowfish_crypt_function _crypt;
 	std::vector<uint32_t> _key;
-	std::vector<uint32_t> _generated_keys;
-	std::vector<std::vector<uint32_t>> _generated_boxes;
+	std::array<uint32_t, 18> _generated_keys;
+	// _generated_keys back to front, the order the block kernels apply them in when decrypting
+	std::array<uint32_t, 18> _reversed_keys;
+	std::array<std::array<uint32_t, 256>, 4> _generated_boxes;
 };
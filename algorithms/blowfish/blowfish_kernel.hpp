@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// blocks the vector kernels take at a time, one per 32-bit lane
+constexpr uint64_t BLOWFISH_AVX2_LANES = 8;
+constexpr uint64_t BLOWFISH_AVX512_LANES = 16;
+
+// ((S1[a] + S2[b]) ^ S3[c]) + S4[d] for the bytes a, b, c, d of x, most significant first
+inline uint32_t blowfish_round(uint32_t x, const uint32_t* const boxes[4])
+{
+	return ((boxes[0][x >> 24] + boxes[1][(x >> 16) & 0xff]) ^ boxes[2][(x >> 8) & 0xff]) + boxes[3][x & 0xff];
+}
+
+/*
+  blocks_count BLOCK_SIZE-byte blocks through the Blowfish rounds. keys holds the 18 subkeys in the
+  order they are applied, reversed for decryption, and boxes the four 256-entry S-boxes; input and
+  output may be the same buffer
+*/
+inline void blowfish_crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4])
+{
+	for (uint64_t block = 0; block < blocks_count; ++block)
+	{
+		const uint8_t* in = input + block * 8;
+		uint32_t left = (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | in[3];
+		uint32_t right = (uint32_t(in[4]) << 24) | (uint32_t(in[5]) << 16) | (uint32_t(in[6]) << 8) | in[7];
+
+		for (uint32_t i = 0; i < 16; i += 2)
+		{
+			left ^= keys[i];
+			right ^= blowfish_round(left, boxes) ^ keys[i + 1];
+			left ^= blowfish_round(right, boxes);
+		}
+
+		// the halves leave swapped
+		const uint32_t first = right ^ keys[17];
+		const uint32_t second = left ^ keys[16];
+
+		uint8_t* out = output + block * 8;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			out[i] = static_cast<uint8_t>(first >> (24 - 8 * i));
+			out[4 + i] = static_cast<uint8_t>(second >> (24 - 8 * i));
+		}
+	}
+}
+
+using blowfish_crypt_function = void (*)(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4]);
+
+// the same rounds on BLOWFISH_AVX2_LANES (BLOWFISH_AVX512_LANES) blocks per step with vpgatherdd doing the
+// S-box lookups, a tail of fewer blocks goes through blowfish_crypt_blocks; x86 builds only, picked
+// through a kernel_table
+void blowfish_crypt_blocks_avx2(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4]);
+void blowfish_crypt_blocks_avx512(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[18], const uint32_t* const boxes[4]);
@@ -3,8 +3,29 @@
 #include <iostream>
 #include <cassert>
 
+#include <vector>
+#include <random>
+
 #include "blowfish_encrypter.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "bit_utils.hpp"
+#include "cpu_features.hpp"
+
+namespace
+{
+	std::string random_bytes(uint64_t size, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::string bytes(size, '\0');
+		for (auto& byte : bytes)
+		{
+			byte = static_cast<char>(generator() & 0xff);
+		}
+
+		return bytes;
+	}
+}
 
 TEST_CASE_BEGIN(cipher_base_encrypt_decrypt)
 {
@@ -46,12 +67,110 @@ TEST_CASE_BEGIN(cipher_long_message_encrypt_decrypt)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(cipher_known_answers)
+{
+	// ciphertexts of the one-block-at-a-time implementation this class started with
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+	const std::string expected = bit_utils::from_hex(
+		"ea0911ed33e3791b1192c7bbdf39ec59d484be5ab52a318a650acfac"
+		"f20309a903ae314b845f96c7113c4c897303691bfe3e1c64a8c7a743");
+
+	for (auto kernel : blowfish_encrypter::get_kernels())
+	{
+		blowfish_encrypter encrypter("secret_s", kernel);
+		assert(encrypter.get_kernel() == kernel);
+		assert(encrypter.encrypt(message) == expected);
+		assert(encrypter.encrypt(std::string(BLOCK_SIZE, '\0')) == bit_utils::from_hex("8934fe2ac607c4e5"));
+		assert(encrypter.decrypt(expected) == message);
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_kernels_ecb_ctr)
+{
+	blowfish_encrypter scalar("secret_s", cpu_features::isa::scalar);
+
+	for (uint64_t size : { 0, 5, 8, 63, 64, 1000, 8 * 1024 + 3 })
+	{
+		const std::string message = random_bytes(size, static_cast<uint32_t>(size));
+		const std::string encrypted = scalar.encrypt(message);
+		const std::string iv = bit_utils::from_hex("FFFFFFFFFFFFFFFE");
+		const std::string ciphertext = scalar.crypt_ctr(message, iv);
+		assert(ciphertext.size() == message.size());
+
+		// counter blocks iv, iv + 1, ... through ECB, wrapping around 2^64
+		const std::string counters = bit_utils::from_hex("FFFFFFFFFFFFFFFEFFFFFFFFFFFFFFFF0000000000000000");
+		const std::string keystream = scalar.encrypt(counters);
+		for (uint64_t i = 0; i < std::min<uint64_t>(size, 3 * BLOCK_SIZE); ++i)
+		{
+			assert(static_cast<char>(ciphertext[i] ^ keystream[i]) == message[i]);
+		}
+
+		// every kernel gives the scalar output, full lane groups and the scalar tail alike
+		for (auto kernel : blowfish_encrypter::get_kernels())
+		{
+			blowfish_encrypter encrypter("secret_s", kernel);
+			assert(encrypter.encrypt(message) == encrypted);
+			assert(encrypter.decrypt(encrypted) == message);
+			assert(encrypter.crypt_ctr(message, iv) == ciphertext);
+			assert(encrypter.crypt_ctr(ciphertext, iv) == message);
+		}
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		scalar.crypt_ctr("message", "short");
+	}
+	catch (const blowfish_encrypter::invalid_iv&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(kernel_throughput_benchmark)
+{
+	constexpr uint64_t megabyte = 1 << 20;
+	const std::string message = random_bytes(megabyte, 1);
+	const std::string iv(BLOCK_SIZE, '\0');
+
+	std::string output(message.size(), '\0');
+	for (auto kernel : blowfish_encrypter::get_kernels())
+	{
+		blowfish_encrypter encrypter("secret_s", kernel);
+		const std::string name = "blowfish " + std::string(cpu_features::get_isa_name(kernel));
+
+		const double blocks_seconds = benchmark::measure(name + " encrypt_blocks 1 MiB", 8, [&]()
+		{
+			encrypter.encrypt_blocks(reinterpret_cast<const uint8_t*>(message.data()),
+				reinterpret_cast<uint8_t*>(&output[0]), message.size() / BLOCK_SIZE);
+		});
+		const double ecb_seconds = benchmark::measure(name + " encrypt 1 MiB", 8, [&]()
+		{
+			encrypter.encrypt(message);
+		});
+		const double ctr_seconds = benchmark::measure(name + " crypt_ctr 1 MiB", 8, [&]()
+		{
+			encrypter.crypt_ctr(message, iv);
+		});
+		std::cerr << name << ": blocks " << 8 / blocks_seconds << " MB/s, ECB " << 8 / ecb_seconds
+			<< " MB/s, CTR " << 8 / ctr_seconds << " MB/s" << std::endl;
+	}
+}
+TEST_CASE_END()
+
 int main()
 {
 	try
 	{
 		cipher_base_encrypt_decrypt();
 		cipher_long_message_encrypt_decrypt();
+		cipher_known_answers();
+		cipher_kernels_ecb_ctr();
+		kernel_throughput_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
@@ -0,0 +1,242 @@
+#include "des_bitslice.hpp"
+#include <algorithm>
+#include <climits>
+
+#include "kernel_table.hpp"
+#include "des_encrypter.hpp"
+#include "des_tables.hpp"
+
+namespace _bitslice_utils
+{
+	constexpr uint32_t ROUND_KEY_BITS = 48;
+
+	constexpr des_bitslice_tables build_tables()
+	{
+		des_bitslice_tables tables = {};
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			tables.initial[i] = PI[i] - 1;
+			tables.final[i] = PI_1[i] - 1;
+		}
+		for (uint32_t i = 0; i < 48; ++i)
+		{
+			tables.expansion[i] = E[i] - 1;
+		}
+		for (uint32_t i = 0; i < 32; ++i)
+		{
+			tables.permutation[i] = P[i] - 1;
+		}
+
+		for (uint32_t box = 0; box < 8; ++box)
+		{
+			for (uint32_t row = 0; row < 4; ++row)
+			{
+				for (uint32_t bit = 0; bit < 4; ++bit)
+				{
+					uint32_t count = 0;
+					for (uint8_t column = 0; column < 16; ++column)
+					{
+						if ((S_BOX[box][row][column] >> (3 - bit)) & 1)
+						{
+							tables.columns[box][row][bit][count++] = column;
+						}
+					}
+				}
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr des_bitslice_tables TABLES = build_tables();
+
+	uint64_t load_block(const uint8_t* bytes)
+	{
+		uint64_t block = 0;
+		for (uint32_t i = 0; i < BLOCK_SIZE; ++i)
+		{
+			block = (block << CHAR_BIT) | bytes[i];
+		}
+
+		return block;
+	}
+
+	void store_block(uint64_t block, uint8_t* bytes)
+	{
+		for (uint32_t i = BLOCK_SIZE; i > 0; --i)
+		{
+			bytes[i - 1] = static_cast<uint8_t>(block);
+			block >>= CHAR_BIT;
+		}
+	}
+
+	// transposes the 64x64 bit matrix whose row i is words[i], most significant bit first
+	// (Hacker's Delight 7-3): swaps ever smaller off-diagonal blocks, 32x32 down to 1x1
+	void transpose(uint64_t words[64])
+	{
+		uint64_t mask = 0x00000000ffffffffULL;
+		for (uint32_t width = 32; width != 0; width >>= 1, mask ^= mask << width)
+		{
+			for (uint32_t k = 0; k < 64; k = ((k | width) + 1) & ~width)
+			{
+				const uint64_t swapped = (words[k] ^ (words[k | width] >> width)) & mask;
+				words[k] ^= swapped;
+				words[k | width] ^= swapped << width;
+			}
+		}
+	}
+
+	// slices of up to 64 blocks, missing blocks are zeros
+	void load_slices(const uint8_t* input, uint64_t blocks_count, uint64_t slices[64])
+	{
+		for (uint64_t i = 0; i < 64; ++i)
+		{
+			slices[i] = i < blocks_count ? load_block(input + i * BLOCK_SIZE) : 0;
+		}
+
+		transpose(slices);
+	}
+
+	void store_slices(uint64_t slices[64], uint8_t* output, uint64_t blocks_count)
+	{
+		transpose(slices);
+		for (uint64_t i = 0; i < blocks_count; ++i)
+		{
+			store_block(slices[i], output + i * BLOCK_SIZE);
+		}
+	}
+
+	void crypt_portable(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables)
+	{
+		des_bitslice_crypt(slices, key_masks, decrypt, tables);
+	}
+
+#if defined(CRYPTO_X86)
+	constexpr kernel_table<des_bitslice_function> KERNELS =
+	{
+		{ crypt_portable, des_bitslice_crypt_sse41, des_bitslice_crypt_avx2, des_bitslice_crypt_avx512 },
+	};
+#else
+	constexpr kernel_table<des_bitslice_function> KERNELS = { { crypt_portable } };
+#endif
+
+	// 64-block groups per kernel call, by tier
+	constexpr uint64_t GROUPS[cpu_features::ISA_COUNT] = { 1, 2, 4, 8 };
+}
+
+std::vector<cpu_features::isa> des_bitslice::get_kernels()
+{
+	return _bitslice_utils::KERNELS.get_supported();
+}
+
+des_bitslice::des_bitslice(const std::string& key, cpu_features::isa level)
+	: _kernel(_bitslice_utils::KERNELS.select(level))
+	, _function(_bitslice_utils::KERNELS.get(level))
+	, _groups(_bitslice_utils::GROUPS[static_cast<uint32_t>(_kernel)])
+	, _key_masks(ROUNDS_COUNT * _bitslice_utils::ROUND_KEY_BITS)
+{
+	if (key.size() < KEY_LENGTH)
+	{
+		throw des_encrypter::invalid_key();
+	}
+	if (!cpu_features::is_supported(level))
+	{
+		throw unsupported_kernel();
+	}
+
+	const auto round_keys = des_round_keys(_bitslice_utils::load_block(reinterpret_cast<const uint8_t*>(key.data())));
+	for (uint32_t round = 0; round < ROUNDS_COUNT; ++round)
+	{
+		for (uint32_t i = 0; i < _bitslice_utils::ROUND_KEY_BITS; ++i)
+		{
+			const uint64_t bit = (round_keys[round] >> (_bitslice_utils::ROUND_KEY_BITS - 1 - i)) & 1;
+			_key_masks[round * _bitslice_utils::ROUND_KEY_BITS + i] = bit != 0 ? ~uint64_t(0) : 0;
+		}
+	}
+}
+
+void des_bitslice::encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt(input, output, blocks_count, false);
+}
+
+void des_bitslice::decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt(input, output, blocks_count, true);
+}
+
+cpu_features::isa des_bitslice::get_kernel() const
+{
+	return _kernel;
+}
+
+uint64_t des_bitslice::get_batch_blocks() const
+{
+	return _groups * DES_BITSLICE_BLOCKS;
+}
+
+void des_bitslice::_crypt(const uint8_t* input, uint8_t* output, uint64_t blocks_count, bool decrypt) const
+{
+	const uint64_t batch_blocks = get_batch_blocks();
+
+	uint64_t done = 0;
+	while (done < blocks_count)
+	{
+		const uint64_t left = blocks_count - done;
+
+		// a tail that fits the portable kernel does not pay for the wider registers
+		uint64_t batch = std::min(left, DES_BITSLICE_BLOCKS);
+		if (left > DES_BITSLICE_BLOCKS)
+		{
+			batch = std::min(left, batch_blocks);
+			_crypt_batch(input + done * BLOCK_SIZE, output + done * BLOCK_SIZE, batch, decrypt, _function, _groups);
+		}
+		else
+		{
+			_crypt_batch(input + done * BLOCK_SIZE, output + done * BLOCK_SIZE, batch, decrypt,
+				_bitslice_utils::crypt_portable, 1);
+		}
+
+		done += batch;
+	}
+}
+
+void des_bitslice::_crypt_batch(const uint8_t* input, uint8_t* output, uint64_t blocks_count, bool decrypt,
+	des_bitslice_function kernel, uint64_t groups) const
+{
+	constexpr uint64_t max_groups = _bitslice_utils::GROUPS[cpu_features::ISA_COUNT - 1];
+
+	uint64_t slices[64 * max_groups];
+	for (uint64_t group = 0; group < groups; ++group)
+	{
+		const uint64_t begin = std::min(blocks_count, group * DES_BITSLICE_BLOCKS);
+		const uint64_t count = std::min(blocks_count - begin, DES_BITSLICE_BLOCKS);
+
+		uint64_t group_slices[64];
+		_bitslice_utils::load_slices(input + begin * BLOCK_SIZE, count, group_slices);
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			slices[i * groups + group] = group_slices[i];
+		}
+	}
+
+	kernel(slices, _key_masks.data(), decrypt, _bitslice_utils::TABLES);
+
+	for (uint64_t group = 0; group < groups; ++group)
+	{
+		const uint64_t begin = std::min(blocks_count, group * DES_BITSLICE_BLOCKS);
+		const uint64_t count = std::min(blocks_count - begin, DES_BITSLICE_BLOCKS);
+
+		uint64_t group_slices[64];
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			group_slices[i] = slices[i * groups + group];
+		}
+		_bitslice_utils::store_slices(group_slices, output + begin * BLOCK_SIZE, count);
+	}
+}
+
+const char* des_bitslice::unsupported_kernel::what() const throw ()
+{
+	return "The CPU does not support the requested bitsliced DES kernel!";
+}
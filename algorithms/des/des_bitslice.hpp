@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cpu_features.hpp"
+#include "des_bitslice_kernel.hpp"
+
+// blocks one call of the portable kernel encrypts, the vector ones take a multiple of it
+constexpr uint64_t DES_BITSLICE_BLOCKS = 64;
+
+/*
+  DES over many independent blocks at once: the blocks are transposed into 64 slices, one per bit
+  position, and the rounds run as boolean circuits on whole slices (des_bitslice_kernel.hpp). The
+  portable kernel packs 64 blocks into uint64_t words, the sse4.1, avx2 and avx512 ones 128, 256
+  and 512 into their registers. A call costs the same for one block as for a full batch, so it
+  pays off from a few blocks on
+*/
+class des_bitslice
+{
+public:
+	struct unsupported_kernel : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// the tiers with a kernel of their own this CPU runs, scalar being the portable one
+	static std::vector<cpu_features::isa> get_kernels();
+
+	// the first KEY_LENGTH bytes of key, throws des_encrypter::invalid_key for a shorter one; runs the
+	// best kernel at or below level and throws unsupported_kernel for a level this CPU lacks
+	explicit des_bitslice(const std::string& key, cpu_features::isa level = cpu_features::get_isa());
+	~des_bitslice() = default;
+
+	// blocks_count blocks of BLOCK_SIZE bytes each, input and output may be the same buffer
+	void encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+	void decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+
+	// the tier of the kernel in use
+	cpu_features::isa get_kernel() const;
+	// blocks one kernel call takes, splitting work on multiples of it wastes no slices
+	uint64_t get_batch_blocks() const;
+
+private:
+	void _crypt(const uint8_t* input, uint8_t* output, uint64_t blocks_count, bool decrypt) const;
+	// up to 64 * groups blocks through a kernel taking groups 64-block groups
+	void _crypt_batch(const uint8_t* input, uint8_t* output, uint64_t blocks_count, bool decrypt,
+		des_bitslice_function kernel, uint64_t groups) const;
+
+	cpu_features::isa _kernel;
+	des_bitslice_function _function;
+	uint64_t _groups;
+	// all ones or all zeros per bit of every round key, see des_bitslice_crypt
+	std::vector<uint64_t> _key_masks;
+};
@@ -0,0 +1,69 @@
+#include "cpu_features.hpp"
+
+#if defined(CRYPTO_X86)
+#include <cstdint>
+#include <immintrin.h>
+
+// everything defined below may use avx2; this file includes no standard header past this point, so
+// no inline function shared with other files gets compiled for avx2
+#if defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include "des_bitslice_kernel.hpp"
+
+namespace
+{
+	constexpr uint32_t KEY_MASKS_COUNT = 16 * 48;
+
+	struct avx2_word
+	{
+		__m256i value;
+
+		avx2_word() = default;
+		avx2_word(__m256i init) : value(init) {}
+	};
+
+	inline avx2_word operator & (avx2_word first, avx2_word second)
+	{
+		return _mm256_and_si256(first.value, second.value);
+	}
+
+	inline avx2_word operator | (avx2_word first, avx2_word second)
+	{
+		return _mm256_or_si256(first.value, second.value);
+	}
+
+	inline avx2_word operator ^ (avx2_word first, avx2_word second)
+	{
+		return _mm256_xor_si256(first.value, second.value);
+	}
+
+	inline avx2_word operator ~ (avx2_word word)
+	{
+		return _mm256_xor_si256(word.value, _mm256_set1_epi32(-1));
+	}
+}
+
+void des_bitslice_crypt_avx2(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables)
+{
+	avx2_word masks[KEY_MASKS_COUNT];
+	for (uint32_t i = 0; i < KEY_MASKS_COUNT; ++i)
+	{
+		masks[i] = _mm256_set1_epi64x(static_cast<long long>(key_masks[i]));
+	}
+
+	avx2_word words[64];
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		words[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slices + 4 * i));
+	}
+
+	des_bitslice_crypt(words, masks, decrypt, tables);
+
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(slices + 4 * i), words[i].value);
+	}
+}
+#endif
@@ -0,0 +1,74 @@
+#include "cpu_features.hpp"
+
+#if defined(CRYPTO_X86)
+// gcc 12 flags the deliberately undefined registers inside its own avx-512 intrinsics (bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <cstdint>
+#include <immintrin.h>
+
+// everything defined below may use avx-512; this file includes no standard header past this point, so
+// no inline function shared with other files gets compiled for avx-512
+#if defined(__GNUC__)
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+#include "des_bitslice_kernel.hpp"
+
+namespace
+{
+	constexpr uint32_t KEY_MASKS_COUNT = 16 * 48;
+
+	struct avx512_word
+	{
+		__m512i value;
+
+		avx512_word() = default;
+		avx512_word(__m512i init) : value(init) {}
+	};
+
+	inline avx512_word operator & (avx512_word first, avx512_word second)
+	{
+		return _mm512_and_si512(first.value, second.value);
+	}
+
+	inline avx512_word operator | (avx512_word first, avx512_word second)
+	{
+		return _mm512_or_si512(first.value, second.value);
+	}
+
+	inline avx512_word operator ^ (avx512_word first, avx512_word second)
+	{
+		return _mm512_xor_si512(first.value, second.value);
+	}
+
+	inline avx512_word operator ~ (avx512_word word)
+	{
+		return _mm512_xor_si512(word.value, _mm512_set1_epi32(-1));
+	}
+}
+
+void des_bitslice_crypt_avx512(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables)
+{
+	avx512_word masks[KEY_MASKS_COUNT];
+	for (uint32_t i = 0; i < KEY_MASKS_COUNT; ++i)
+	{
+		masks[i] = _mm512_set1_epi64(static_cast<long long>(key_masks[i]));
+	}
+
+	avx512_word words[64];
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		words[i] = _mm512_loadu_si512(slices + 8 * i);
+	}
+
+	des_bitslice_crypt(words, masks, decrypt, tables);
+
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		_mm512_storeu_si512(slices + 8 * i, words[i].value);
+	}
+}
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+
+// the des tables as 0-based slice indices, plus the s-boxes unrolled into the column sets the circuits OR together
+struct des_bitslice_tables
+{
+	uint8_t initial[64];
+	uint8_t expansion[48];
+	uint8_t permutation[32];
+	uint8_t final[64];
+
+	// columns[box][row][bit]: the 8 columns of the row whose output has bit (counted from the most
+	// significant one) set. Every row is a permutation of 0..15, so each bit is set in exactly 8 of them
+	uint8_t columns[8][4][4][8];
+};
+
+/*
+  Bitsliced DES rounds for any word type W with &, |, ^ and ~: slice i holds bit i + 1 of every block,
+  one block per bit of the word, so each boolean operation below works on all the blocks at once.
+  S-boxes are circuits decoding the two row bits and the four column bits into minterms and ORing
+  the minterms of the entries with an output bit set; permutations and the expansion only pick slices
+*/
+template <typename W>
+inline void des_bitslice_sbox(const uint8_t columns[4][4][8], const W in[6], W out[4])
+{
+	const W not_in[6] = { ~in[0], ~in[1], ~in[2], ~in[3], ~in[4], ~in[5] };
+
+	W row[4], high[4], low[4];
+	for (uint32_t v = 0; v < 4; ++v)
+	{
+		row[v] = ((v & 2) ? in[0] : not_in[0]) & ((v & 1) ? in[5] : not_in[5]);
+		high[v] = ((v & 2) ? in[1] : not_in[1]) & ((v & 1) ? in[2] : not_in[2]);
+		low[v] = ((v & 2) ? in[3] : not_in[3]) & ((v & 1) ? in[4] : not_in[4]);
+	}
+
+	W column[16];
+	for (uint32_t v = 0; v < 16; ++v)
+	{
+		column[v] = high[v >> 2] & low[v & 3];
+	}
+
+	for (uint32_t bit = 0; bit < 4; ++bit)
+	{
+		W result = row[0] & (
+			column[columns[0][bit][0]] | column[columns[0][bit][1]] | column[columns[0][bit][2]] | column[columns[0][bit][3]] |
+			column[columns[0][bit][4]] | column[columns[0][bit][5]] | column[columns[0][bit][6]] | column[columns[0][bit][7]]);
+		for (uint32_t r = 1; r < 4; ++r)
+		{
+			result = result | (row[r] & (
+				column[columns[r][bit][0]] | column[columns[r][bit][1]] | column[columns[r][bit][2]] | column[columns[r][bit][3]] |
+				column[columns[r][bit][4]] | column[columns[r][bit][5]] | column[columns[r][bit][6]] | column[columns[r][bit][7]]));
+		}
+
+		out[bit] = result;
+	}
+}
+
+// key_masks[48 * round + i] is all ones where bit i + 1 of the round key is set, all zeros elsewhere
+template <typename W>
+void des_bitslice_crypt(W slices[64], const W* key_masks, bool decrypt, const des_bitslice_tables& tables)
+{
+	constexpr uint32_t rounds_count = 16;
+
+	W left[32], right[32];
+	for (uint32_t i = 0; i < 32; ++i)
+	{
+		left[i] = slices[tables.initial[i]];
+		right[i] = slices[tables.initial[32 + i]];
+	}
+
+	for (uint32_t round = 0; round < rounds_count; ++round)
+	{
+		const W* key = key_masks + 48 * (decrypt ? rounds_count - round - 1 : round);
+
+		W f[32];
+		for (uint32_t box = 0; box < 8; ++box)
+		{
+			W in[6];
+			for (uint32_t i = 0; i < 6; ++i)
+			{
+				in[i] = right[tables.expansion[6 * box + i]] ^ key[6 * box + i];
+			}
+
+			des_bitslice_sbox(tables.columns[box], in, f + 4 * box);
+		}
+
+		for (uint32_t i = 0; i < 32; ++i)
+		{
+			const W new_right = left[i] ^ f[tables.permutation[i]];
+			left[i] = right[i];
+			right[i] = new_right;
+		}
+	}
+
+	// R16 || L16 through the final permutation
+	W preoutput[64];
+	for (uint32_t i = 0; i < 32; ++i)
+	{
+		preoutput[i] = right[i];
+		preoutput[32 + i] = left[i];
+	}
+
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		slices[i] = preoutput[tables.final[i]];
+	}
+}
+
+// the rounds on groups 64-block groups at once, slices[groups * i + group] holding slice i of a group
+using des_bitslice_function = void (*)(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables);
+
+// 2, 4 and 8 groups in 128-, 256- and 512-bit registers; x86 builds only, picked through a kernel_table
+void des_bitslice_crypt_sse41(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables);
+void des_bitslice_crypt_avx2(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables);
+void des_bitslice_crypt_avx512(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables);
@@ -0,0 +1,69 @@
+#include "cpu_features.hpp"
+
+#if defined(CRYPTO_X86)
+#include <cstdint>
+#include <immintrin.h>
+
+// everything defined below may use sse4.1; this file includes no standard header past this point, so
+// no inline function shared with other files gets compiled for sse41
+#if defined(__GNUC__)
+#pragma GCC target("sse4.1")
+#endif
+
+#include "des_bitslice_kernel.hpp"
+
+namespace
+{
+	constexpr uint32_t KEY_MASKS_COUNT = 16 * 48;
+
+	struct sse41_word
+	{
+		__m128i value;
+
+		sse41_word() = default;
+		sse41_word(__m128i init) : value(init) {}
+	};
+
+	inline sse41_word operator & (sse41_word first, sse41_word second)
+	{
+		return _mm_and_si128(first.value, second.value);
+	}
+
+	inline sse41_word operator | (sse41_word first, sse41_word second)
+	{
+		return _mm_or_si128(first.value, second.value);
+	}
+
+	inline sse41_word operator ^ (sse41_word first, sse41_word second)
+	{
+		return _mm_xor_si128(first.value, second.value);
+	}
+
+	inline sse41_word operator ~ (sse41_word word)
+	{
+		return _mm_xor_si128(word.value, _mm_set1_epi32(-1));
+	}
+}
+
+void des_bitslice_crypt_sse41(uint64_t* slices, const uint64_t* key_masks, bool decrypt, const des_bitslice_tables& tables)
+{
+	sse41_word masks[KEY_MASKS_COUNT];
+	for (uint32_t i = 0; i < KEY_MASKS_COUNT; ++i)
+	{
+		masks[i] = _mm_set1_epi64x(static_cast<long long>(key_masks[i]));
+	}
+
+	sse41_word words[64];
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		words[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slices + 2 * i));
+	}
+
+	des_bitslice_crypt(words, masks, decrypt, tables);
+
+	for (uint32_t i = 0; i < 64; ++i)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(slices + 2 * i), words[i].value);
+	}
+}
+#endif
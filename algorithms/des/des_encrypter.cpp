@@ -1,180 +1,45 @@
 #include "des_encrypter.hpp"
 #include <string>
+#include <algorithm>
+#include <climits>
 
-#include "bit_utils.hpp"
-
-constexpr uint32_t ROUNDS_COUNT = 16;
-constexpr uint32_t KEY_LENGTH = 8;
-
-// initial permutations matrix for the data
-const std::vector<uint8_t> PI = {
-	58, 50, 42, 34, 26, 18, 10, 2,
-	60, 52, 44, 36, 28, 20, 12, 4,
-	62, 54, 46, 38, 30, 22, 14, 6,
-	64, 56, 48, 40, 32, 24, 16, 8,
-	57, 49, 41, 33, 25, 17, 9, 1,
-	59, 51, 43, 35, 27, 19, 11, 3,
-	61, 53, 45, 37, 29, 21, 13, 5,
-	63, 55, 47, 39, 31, 23, 15, 7,
-};
-
-// initial permutations made on the key
-const std::vector<uint8_t> CP_1 = 
-{ 
-	57, 49, 41, 33, 25, 17, 9,
-	1, 58, 50, 42, 34, 26, 18,
-	10, 2, 59, 51, 43, 35, 27,
-	19, 11, 3, 60, 52, 44, 36,
-	63, 55, 47, 39, 31, 23, 15,
-	7, 62, 54, 46, 38, 30, 22,
-	14, 6, 61, 53, 45, 37, 29,
-	21, 13, 5, 28, 20, 12, 4,
-};
-
-// permutations applied on shifted key to get Ki + 1
-const std::vector<uint8_t> CP_2 =
-{
-	14, 17, 11, 24, 1, 5, 3, 28,
-	15, 6, 21, 10, 23, 19, 12, 4,
-	26, 8, 16, 7, 27, 20, 13, 2,
-	41, 52, 31, 37, 47, 55, 30, 40,
-	51, 45, 33, 48, 44, 49, 39, 56,
-	34, 53, 46, 42, 50, 36, 29, 32,
-};
-
-// expand matrix to get a 48bits matrix of data to apply the xor with Ki
-const std::vector<uint8_t> E =
-{
-	32, 1, 2, 3, 4, 5,
-	4, 5, 6, 7, 8, 9,
-	8, 9, 10, 11, 12, 13,
-	12, 13, 14, 15, 16, 17,
-	16, 17, 18, 19, 20, 21,
-	20, 21, 22, 23, 24, 25,
-	24, 25, 26, 27, 28, 29,
-	28, 29, 30, 31, 32, 1,
-};
-
-// final permutations for data after the 16 rounds
-const std::vector<uint8_t> PI_1 = {
-	40, 8, 48, 16, 56, 24, 64, 32,
-	39, 7, 47, 15, 55, 23, 63, 31,
-	38, 6, 46, 14, 54, 22, 62, 30,
-	37, 5, 45, 13, 53, 21, 61, 29,
-	36, 4, 44, 12, 52, 20, 60, 28,
-	35, 3, 43, 11, 51, 19, 59, 27,
-	34, 2, 42, 10, 50, 18, 58, 26,
-	33, 1, 41, 9, 49, 17, 57, 25,
-};
-
-// permutations made after each SBox substitution for each round
-const std::vector<uint8_t> P =
-{
-	16, 7, 20, 21, 29, 12, 28, 17,
-	1, 15, 23, 26, 5, 18, 31, 10,
-	2, 8, 24, 14, 32, 27, 3, 9,
-	19, 13, 30, 6, 22, 11, 4, 25,
-};
-
-// matrix that determine the shift for each round of keys
-const std::vector<uint8_t> SHIFT = { 1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1 };
-
-const std::vector<std::vector<uint8_t>> S_BOX_1 =
-{
-	{14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7},
-	{0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
-	{4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0},
-	{15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_2 =
-{
-	{15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10},
-	{3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5},
-	{0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15},
-	{13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_3 =
-{
-	{10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8},
-	{13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1},
-	{13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7},
-	{1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_4 =
-{
-	{7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15},
-	{13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9},
-	{10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4},
-	{3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_5 =
-{
-	{2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9},
-	{14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6},
-	{4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14},
-	{11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_6 =
-{
-	{12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11},
-	{10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8},
-	{9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6},
-	{4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_7 =
-{
-	{4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1},
-	{13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6},
-	{1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2},
-	{6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12},
-};
-
-const std::vector<std::vector<uint8_t>> S_BOX_8 =
-{
-	{13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7},
-	{1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2},
-	{7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8},
-	{2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11},
-};
-
-const std::vector<std::vector<std::vector<uint8_t>>> S_BOX =
-{
-	S_BOX_1, S_BOX_2, S_BOX_3, S_BOX_4, S_BOX_5, S_BOX_6, S_BOX_7, S_BOX_8,
-};
+#include "des_tables.hpp"
 
 des_encrypter::des_encrypter(const std::string& key)
 	: _key(_check_key(key))
+	, _bitslice(_key)
 {
 	_generate_keys();
 }
 
 std::string des_encrypter::encrypt(const std::string& message) const
 {
-	return _internal_run(message, _e_action::encrypt);
+	return _internal_run(message, _e_action::encrypt, nullptr);
 }
 
 std::string des_encrypter::decrypt(const std::string& message) const
 {
-	return _internal_run(message, _e_action::decrypt);
+	return _internal_run(message, _e_action::decrypt, nullptr);
 }
 
-std::vector<std::string> des_encrypter::_build_message_blocks(const std::string& message)
+std::string des_encrypter::encrypt(const std::string& message, thread_pool& pool) const
 {
-	std::vector<std::string> blocks;
-	size_t blocks_count = message.size() / BLOCK_SIZE;
-	blocks.reserve(blocks_count);
-	for (uint32_t i = 0; i < blocks_count; ++i)
-	{
-		blocks.push_back(message.substr(static_cast<size_t>(i) * BLOCK_SIZE, BLOCK_SIZE));
-	}
+	return _internal_run(message, _e_action::encrypt, &pool);
+}
 
-	return blocks;
+std::string des_encrypter::decrypt(const std::string& message, thread_pool& pool) const
+{
+	return _internal_run(message, _e_action::decrypt, &pool);
+}
+
+std::string des_encrypter::crypt_ctr(const std::string& message, const std::string& iv) const
+{
+	return _crypt_ctr(message, iv, nullptr);
+}
+
+std::string des_encrypter::crypt_ctr(const std::string& message, const std::string& iv, thread_pool& pool) const
+{
+	return _crypt_ctr(message, iv, &pool);
 }
 
 std::string des_encrypter::_try_remove_padding(const std::string& message)
@@ -206,120 +71,176 @@ std::string des_encrypter::_construct_padding_message(const std::string& message
 
 void des_encrypter::_generate_keys()
 {
-	_generated_keys.reserve(ROUNDS_COUNT);
+	uint64_t key = 0;
+	for (char byte : _key)
+	{
+		key = (key << CHAR_BIT) | static_cast<uint8_t>(byte);
+	}
+
+	const auto round_keys = des_round_keys(key);
+	_generated_keys.assign(round_keys.begin(), round_keys.end());
+}
+
+std::string des_encrypter::_internal_run(const std::string& message, _e_action action, thread_pool* pool) const
+{
+	std::string message_to_process = _construct_padding_message(message);
+
+	const uint64_t blocks_count = message_to_process.size() / BLOCK_SIZE;
+	if (blocks_count >= DES_BITSLICE_MIN_BLOCKS)
+	{
+		const bool decrypt = action == _e_action::decrypt;
+		auto crypt = [&](uint64_t begin, uint64_t end)
+		{
+			uint8_t* data = reinterpret_cast<uint8_t*>(&message_to_process[0]) + begin * BLOCK_SIZE;
+			if (decrypt)
+			{
+				_bitslice.decrypt_blocks(data, data, end - begin);
+			}
+			else
+			{
+				_bitslice.encrypt_blocks(data, data, end - begin);
+			}
+		};
+
+		// whole batches per task, so no kernel call runs on a partly empty batch but the last one
+		const uint64_t batch_blocks = _bitslice.get_batch_blocks();
+		const uint64_t batches_count = (blocks_count + batch_blocks - 1) / batch_blocks;
+		if (pool != nullptr && batches_count > 1)
+		{
+			pool->parallel_for(batches_count, [&](uint64_t batch)
+			{
+				crypt(batch * batch_blocks, std::min(blocks_count, (batch + 1) * batch_blocks));
+			});
+		}
+		else
+		{
+			crypt(0, blocks_count);
+		}
 
-	auto key = bit_utils::bytes_to_bitset<BLOCK_SIZE>(bit_utils::stob(_key));
-	auto permutated_key = bit_utils::perform_permutations<BLOCK_SIZE, (BLOCK_SIZE - 1)>(key, CP_1);
-	auto pair = bit_utils::split_bitset<(BLOCK_SIZE - 1)>(permutated_key);
-	auto left = pair[0], right = pair[1];
+		return decrypt ? _try_remove_padding(message_to_process) : message_to_process;
+	}
 
-	for (uint64_t i = 0; i < ROUNDS_COUNT; ++i)
+	for (uint64_t offset = 0; offset < message_to_process.size(); offset += BLOCK_SIZE)
 	{
-		left = bit_utils::shift_bitset_cyclic<(BLOCK_SIZE - 1) * CHAR_BIT / 2>(left, SHIFT[i]);
-		right = bit_utils::shift_bitset_cyclic<(BLOCK_SIZE - 1) * CHAR_BIT / 2>(right, SHIFT[i]);
+		uint64_t block = 0;
+		for (uint32_t i = 0; i < BLOCK_SIZE; ++i)
+		{
+			block = (block << CHAR_BIT) | static_cast<uint8_t>(message_to_process[offset + i]);
+		}
 
-		auto merged_bitset = bit_utils::merge_bitset<(BLOCK_SIZE - 1)>(left, right);
-		auto generated_key_bitset = bit_utils::perform_permutations<(BLOCK_SIZE - 1), (BLOCK_SIZE - 2)>(
-			merged_bitset, CP_2);
-		_generated_keys.push_back(std::move(generated_key_bitset));
+		block = _encrypt_block(block, action);
+		for (uint32_t i = BLOCK_SIZE; i > 0; --i)
+		{
+			message_to_process[offset + i - 1] = static_cast<char>(block & 0xff);
+			block >>= CHAR_BIT;
+		}
 	}
+
+	return action == _e_action::decrypt ? _try_remove_padding(message_to_process) : message_to_process;
 }
 
-std::string des_encrypter::_internal_run(const std::string& message, _e_action action) const
+std::string des_encrypter::_crypt_ctr(const std::string& message, const std::string& iv, thread_pool* pool) const
 {
-	std::string message_to_process = _construct_padding_message(message);
-	std::vector<std::string> source_blocks = _build_message_blocks(message_to_process);
-	std::vector<std::bitset<BLOCK_SIZE * CHAR_BIT>> result_blocks;
-	result_blocks.reserve(source_blocks.size());
-
-	for (const auto& block : source_blocks)
+	if (iv.size() != BLOCK_SIZE)
 	{
-        auto&& encrypted_block = _encrypt_block(block, action);
-		result_blocks.push_back(std::move(encrypted_block));
+		throw invalid_iv();
 	}
-	
-	std::string result_message;
-	result_message.reserve(BLOCK_SIZE * result_blocks.size());
-	
-	for (const auto& block : result_blocks)
+
+	uint64_t counter = 0;
+	for (char byte : iv)
 	{
-		result_message += bit_utils::bitset_to_bytes<BLOCK_SIZE>(block);
+		counter = (counter << CHAR_BIT) | static_cast<uint8_t>(byte);
 	}
 
-	if (action == _e_action::decrypt)
+	std::string output = message;
+	const uint64_t blocks_count = (message.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const uint64_t batch_blocks = _bitslice.get_batch_blocks();
+	const uint64_t batches_count = (blocks_count + batch_blocks - 1) / batch_blocks;
+	if (pool != nullptr && batches_count > 1)
+	{
+		pool->parallel_for(batches_count, [&](uint64_t batch)
+		{
+			_crypt_ctr_range(counter, output, batch * batch_blocks, std::min(blocks_count, (batch + 1) * batch_blocks));
+		});
+	}
+	else
 	{
-		result_message = _try_remove_padding(result_message);
+		_crypt_ctr_range(counter, output, 0, blocks_count);
 	}
 
-	return result_message;
+	return output;
 }
 
-std::bitset<BLOCK_SIZE* CHAR_BIT> des_encrypter::_encrypt_block(const std::string& block, _e_action action) const
+void des_encrypter::_crypt_ctr_range(uint64_t iv, std::string& output, uint64_t begin, uint64_t end) const
 {
-	auto bitset_block = bit_utils::bytes_to_bitset<BLOCK_SIZE>(bit_utils::stob(block));
-	auto permutated_block = bit_utils::perform_permutations<BLOCK_SIZE, BLOCK_SIZE>(bitset_block, PI);
-    
-	auto pair = bit_utils::split_bitset<BLOCK_SIZE>(permutated_block);
-	auto left = pair[0], right = pair[1];
+	const uint64_t batch_blocks = _bitslice.get_batch_blocks();
+	std::vector<uint8_t> keystream(batch_blocks * BLOCK_SIZE);
 
-	for (uint64_t i = 0; i < ROUNDS_COUNT; ++i)
+	for (uint64_t batch_begin = begin; batch_begin < end; batch_begin += batch_blocks)
 	{
-		auto right_e = bit_utils::perform_permutations<BLOCK_SIZE / 2, (BLOCK_SIZE - 2)>(right, E);
+		const uint64_t batch_end = std::min(end, batch_begin + batch_blocks);
+		for (uint64_t block = batch_begin; block < batch_end; ++block)
+		{
+			// the counter wraps around modulo 2^64
+			uint64_t counter = iv + block;
+			for (uint32_t i = BLOCK_SIZE; i > 0; --i)
+			{
+				keystream[(block - batch_begin) * BLOCK_SIZE + i - 1] = static_cast<uint8_t>(counter);
+				counter >>= CHAR_BIT;
+			}
+		}
 
-		uint64_t key_index = 0;
-		switch (action)
+		_bitslice.encrypt_blocks(keystream.data(), keystream.data(), batch_end - batch_begin);
+
+		const uint64_t bytes_begin = batch_begin * BLOCK_SIZE;
+		const uint64_t bytes_end = std::min<uint64_t>(output.size(), batch_end * BLOCK_SIZE);
+		for (uint64_t i = bytes_begin; i < bytes_end; ++i)
 		{
-		case des_encrypter::_e_action::encrypt:
-			key_index = i;
-			break;
-		case des_encrypter::_e_action::decrypt:
-			key_index = ROUNDS_COUNT - i - 1;
-			break;
-		default:
-			throw invalid_action();
-			break;
+			output[i] ^= keystream[i - bytes_begin];
 		}
+	}
+}
 
-		auto new_right_xor = _generated_keys[key_index] ^ right_e;
-        auto new_right_subs = _substitude_block(new_right_xor);
-		auto new_right_permutated =
-			bit_utils::perform_permutations<BLOCK_SIZE / 2, BLOCK_SIZE / 2>(new_right_subs, P);
-		auto result_new_right = left ^ new_right_permutated;
+uint64_t des_encrypter::_encrypt_block(uint64_t block, _e_action action) const
+{
+	if (action != _e_action::encrypt && action != _e_action::decrypt)
+	{
+		throw invalid_action();
+	}
 
+	const uint64_t permutated_block = _des_utils::permute(block, 64, PI);
+	uint32_t left = static_cast<uint32_t>(permutated_block >> 32);
+	uint32_t right = static_cast<uint32_t>(permutated_block);
 
+	for (uint32_t i = 0; i < ROUNDS_COUNT; ++i)
+	{
+		const uint64_t key = _generated_keys[action == _e_action::encrypt ? i : ROUNDS_COUNT - i - 1];
+
+		// E puts bits 4b..4b+5 of the half (1-based, wrapping around) into group b, a rotation each
+		uint32_t substituted = 0;
+		for (uint32_t box = 0; box < 8; ++box)
+		{
+			const uint32_t shift = (27 - 4 * box) & 31;
+			const uint32_t expanded = ((right >> shift) | (right << ((32 - shift) & 31))) & 0x3f;
+			substituted |= SP[box][expanded ^ ((key >> (42 - 6 * box)) & 0x3f)];
+		}
+
+		const uint32_t new_right = left ^ substituted;
 		left = right;
-		right = result_new_right;
+		right = new_right;
 	}
 
-	auto merged_bitset = bit_utils::merge_bitset<BLOCK_SIZE>(right, left);
-	auto result_block = bit_utils::perform_permutations<BLOCK_SIZE, BLOCK_SIZE>(merged_bitset, PI_1);
-
-	return result_block;
+	return _des_utils::permute((uint64_t(right) << 32) | left, 64, PI_1);
 }
 
-std::bitset<BLOCK_SIZE * CHAR_BIT / 2> des_encrypter::_substitude_block(const std::bitset<(BLOCK_SIZE - 2) * CHAR_BIT>& block)
+const char* des_encrypter::invalid_key::what() const throw ()
 {
-    std::bitset<BLOCK_SIZE * CHAR_BIT / 2> result_subs;
-    auto subblocks = bit_utils::split_bitset<(BLOCK_SIZE - 2), BLOCK_SIZE>(block);
-    for (uint64_t i = 0; i < CHAR_BIT; ++i)
-    {
-        auto &subblock = subblocks[i];
-        uint32_t row = 0b10 * subblock[0] + 0b01 * subblock[5];
-        uint32_t col = 0b1000 * subblock[1] + 0b0100 * subblock[2] + 0b0010 * subblock[3] + 0b0001 * subblock[4];
-        auto val = std::bitset<BLOCK_SIZE / 2>(S_BOX[i][row][col]);
-        for (uint64_t j = 0; j < BLOCK_SIZE / 2; ++j)
-        {
-            // default bitset conversion inversed, because of that we have to flip values
-            result_subs[i * BLOCK_SIZE / 2 + j] = val[BLOCK_SIZE / 2 - j - 1];
-        }
-    }
-    
-	return result_subs;
+	return "Invalid key! Key should be no less than 8 chars";
 }
 
-const char* des_encrypter::invalid_key::what() const throw ()
+const char* des_encrypter::invalid_iv::what() const throw ()
 {
-	return "Invalid key! Key should be no less than 8 chars";
+	return "Invalid initial counter block! It should be exactly 8 bytes";
 }
 
 const char* des_encrypter::invalid_action::what() const throw ()
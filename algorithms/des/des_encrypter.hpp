@@ -2,9 +2,13 @@
 
 #include <string>
 #include <vector>
-#include <bitset>
+
+#include "des_bitslice.hpp"
+#include "thread_pool.hpp"
 
 constexpr uint32_t BLOCK_SIZE = 8;
+// messages of fewer blocks go through the scalar rounds, longer ones through des_bitslice
+constexpr uint64_t DES_BITSLICE_MIN_BLOCKS = 4;
 
 class des_encrypter
 {
@@ -14,11 +18,25 @@ public:
 		const char* what() const throw ();
 	};
 
+	struct invalid_iv : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
 	des_encrypter(const std::string& key);
 	~des_encrypter() = default;
 
+	// ECB
 	std::string encrypt(const std::string& message) const;
 	std::string decrypt(const std::string& message) const;
+	// the same output, with the bitsliced batches spread over the workers of the pool
+	std::string encrypt(const std::string& message, thread_pool& pool) const;
+	std::string decrypt(const std::string& message, thread_pool& pool) const;
+
+	// CTR: message ^ E(iv) || E(iv + 1) || ..., iv being BLOCK_SIZE bytes read as a big-endian counter.
+	// The same call encrypts and decrypts, the output is as long as the message. Throws invalid_iv
+	std::string crypt_ctr(const std::string& message, const std::string& iv) const;
+	std::string crypt_ctr(const std::string& message, const std::string& iv, thread_pool& pool) const;
 
 private:
 	struct invalid_action : public std::exception
@@ -33,18 +51,22 @@ private:
 		undefined,
 	};
 
-	static std::vector<std::string> _build_message_blocks(const std::string& message);
 	static std::string _try_remove_padding(const std::string& message);
 	static std::string _check_key(const std::string& key);
 	static std::string _construct_padding_message(const std::string& message);
 
-	static std::bitset<BLOCK_SIZE * CHAR_BIT / 2> _substitude_block(const std::bitset<(BLOCK_SIZE - 2) * CHAR_BIT>& block);
-
-	std::bitset<BLOCK_SIZE * CHAR_BIT> _encrypt_block(const std::string& block, _e_action action) const;
-	std::string _internal_run(const std::string& message, _e_action action) const;
+	// the 16 rounds on one block read as a big-endian integer
+	uint64_t _encrypt_block(uint64_t block, _e_action action) const;
+	std::string _internal_run(const std::string& message, _e_action action, thread_pool* pool) const;
+	// keystream blocks [begin, end) xored into output, which holds the message
+	void _crypt_ctr_range(uint64_t iv, std::string& output, uint64_t begin, uint64_t end) const;
+	std::string _crypt_ctr(const std::string& message, const std::string& iv, thread_pool* pool) const;
 
 	void _generate_keys();
 
 	std::string _key;
-	std::vector<std::bitset<(BLOCK_SIZE - 2) * CHAR_BIT>> _generated_keys;
+	// the 48-bit round keys, right aligned
+	std::vector<uint64_t> _generated_keys;
+
+	des_bitslice _bitslice;
 };
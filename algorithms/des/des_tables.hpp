@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+// tables of FIPS 46-3, bit positions counted from 1 at the most significant bit of the first byte
+
+constexpr uint32_t ROUNDS_COUNT = 16;
+constexpr uint32_t KEY_LENGTH = 8;
+
+// initial permutations matrix for the data
+constexpr std::array<uint8_t, 64> PI = {
+	58, 50, 42, 34, 26, 18, 10, 2,
+	60, 52, 44, 36, 28, 20, 12, 4,
+	62, 54, 46, 38, 30, 22, 14, 6,
+	64, 56, 48, 40, 32, 24, 16, 8,
+	57, 49, 41, 33, 25, 17, 9, 1,
+	59, 51, 43, 35, 27, 19, 11, 3,
+	61, 53, 45, 37, 29, 21, 13, 5,
+	63, 55, 47, 39, 31, 23, 15, 7,
+};
+
+// initial permutations made on the key
+constexpr std::array<uint8_t, 56> CP_1 = 
+{ 
+	57, 49, 41, 33, 25, 17, 9,
+	1, 58, 50, 42, 34, 26, 18,
+	10, 2, 59, 51, 43, 35, 27,
+	19, 11, 3, 60, 52, 44, 36,
+	63, 55, 47, 39, 31, 23, 15,
+	7, 62, 54, 46, 38, 30, 22,
+	14, 6, 61, 53, 45, 37, 29,
+	21, 13, 5, 28, 20, 12, 4,
+};
+
+// permutations applied on shifted key to get Ki + 1
+constexpr std::array<uint8_t, 48> CP_2 =
+{
+	14, 17, 11, 24, 1, 5, 3, 28,
+	15, 6, 21, 10, 23, 19, 12, 4,
+	26, 8, 16, 7, 27, 20, 13, 2,
+	41, 52, 31, 37, 47, 55, 30, 40,
+	51, 45, 33, 48, 44, 49, 39, 56,
+	34, 53, 46, 42, 50, 36, 29, 32,
+};
+
+// expand matrix to get a 48bits matrix of data to apply the xor with Ki
+constexpr std::array<uint8_t, 48> E =
+{
+	32, 1, 2, 3, 4, 5,
+	4, 5, 6, 7, 8, 9,
+	8, 9, 10, 11, 12, 13,
+	12, 13, 14, 15, 16, 17,
+	16, 17, 18, 19, 20, 21,
+	20, 21, 22, 23, 24, 25,
+	24, 25, 26, 27, 28, 29,
+	28, 29, 30, 31, 32, 1,
+};
+
+// final permutations for data after the 16 rounds
+constexpr std::array<uint8_t, 64> PI_1 = {
+	40, 8, 48, 16, 56, 24, 64, 32,
+	39, 7, 47, 15, 55, 23, 63, 31,
+	38, 6, 46, 14, 54, 22, 62, 30,
+	37, 5, 45, 13, 53, 21, 61, 29,
+	36, 4, 44, 12, 52, 20, 60, 28,
+	35, 3, 43, 11, 51, 19, 59, 27,
+	34, 2, 42, 10, 50, 18, 58, 26,
+	33, 1, 41, 9, 49, 17, 57, 25,
+};
+
+// permutations made after each SBox substitution for each round
+constexpr std::array<uint8_t, 32> P =
+{
+	16, 7, 20, 21, 29, 12, 28, 17,
+	1, 15, 23, 26, 5, 18, 31, 10,
+	2, 8, 24, 14, 32, 27, 3, 9,
+	19, 13, 30, 6, 22, 11, 4, 25,
+};
+
+// matrix that determine the shift for each round of keys
+constexpr std::array<uint8_t, 16> SHIFT = { 1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1 };
+
+// four rows of 16 columns, the row picked by the outer bits of a 6-bit group and the column by the inner ones
+using des_s_box = std::array<std::array<uint8_t, 16>, 4>;
+
+constexpr des_s_box S_BOX_1 =
+{{
+	{14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7},
+	{0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
+	{4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0},
+	{15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13},
+}};
+
+constexpr des_s_box S_BOX_2 =
+{{
+	{15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10},
+	{3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5},
+	{0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15},
+	{13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9},
+}};
+
+constexpr des_s_box S_BOX_3 =
+{{
+	{10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8},
+	{13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1},
+	{13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7},
+	{1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12},
+}};
+
+constexpr des_s_box S_BOX_4 =
+{{
+	{7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15},
+	{13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9},
+	{10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4},
+	{3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14},
+}};
+
+constexpr des_s_box S_BOX_5 =
+{{
+	{2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9},
+	{14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6},
+	{4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14},
+	{11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3},
+}};
+
+constexpr des_s_box S_BOX_6 =
+{{
+	{12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11},
+	{10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8},
+	{9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6},
+	{4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13},
+}};
+
+constexpr des_s_box S_BOX_7 =
+{{
+	{4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1},
+	{13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6},
+	{1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2},
+	{6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12},
+}};
+
+constexpr des_s_box S_BOX_8 =
+{{
+	{13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7},
+	{1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2},
+	{7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8},
+	{2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11},
+}};
+
+constexpr std::array<des_s_box, 8> S_BOX =
+{
+	S_BOX_1, S_BOX_2, S_BOX_3, S_BOX_4, S_BOX_5, S_BOX_6, S_BOX_7, S_BOX_8,
+};
+
+namespace _des_utils
+{
+	// bit position (counted from 1 at the most significant of width bits) of value
+	constexpr uint64_t get_bit(uint64_t value, uint32_t width, uint32_t position)
+	{
+		return (value >> (width - position)) & 1;
+	}
+
+	// the bits of value at the 1-based positions of table, most significant first
+	template <size_t output_bits>
+	constexpr uint64_t permute(uint64_t value, uint32_t width, const std::array<uint8_t, output_bits>& table)
+	{
+		uint64_t result = 0;
+		for (uint8_t position : table)
+		{
+			result = (result << 1) | get_bit(value, width, position);
+		}
+
+		return result;
+	}
+
+	constexpr std::array<std::array<uint32_t, 64>, 8> build_sp_tables()
+	{
+		std::array<std::array<uint32_t, 64>, 8> tables = {};
+		for (uint32_t box = 0; box < 8; ++box)
+		{
+			for (uint32_t group = 0; group < 64; ++group)
+			{
+				const uint32_t row = ((group >> 4) & 2) | (group & 1);
+				const uint32_t column = (group >> 1) & 0x0f;
+				const uint64_t substituted = uint64_t(S_BOX[box][row][column]) << (28 - 4 * box);
+				tables[box][group] = static_cast<uint32_t>(permute(substituted, 32, P));
+			}
+		}
+
+		return tables;
+	}
+}
+
+// SP[box][group]: a 6-bit group of the expanded half (first bit most significant) through its S-box,
+// placed among the 32 output bits and permuted by P, so a round is eight lookups ORed together
+constexpr std::array<std::array<uint32_t, 64>, 8> SP = _des_utils::build_sp_tables();
+
+// the 48-bit round keys of a 64-bit key, right aligned
+inline std::array<uint64_t, ROUNDS_COUNT> des_round_keys(uint64_t key)
+{
+	constexpr uint32_t half_bits = 28;
+	constexpr uint64_t half_mask = (uint64_t(1) << half_bits) - 1;
+
+	const uint64_t permutated_key = _des_utils::permute(key, 64, CP_1);
+	uint64_t left = permutated_key >> half_bits;
+	uint64_t right = permutated_key & half_mask;
+
+	std::array<uint64_t, ROUNDS_COUNT> keys = {};
+	for (uint32_t round = 0; round < ROUNDS_COUNT; ++round)
+	{
+		left = ((left << SHIFT[round]) | (left >> (half_bits - SHIFT[round]))) & half_mask;
+		right = ((right << SHIFT[round]) | (right >> (half_bits - SHIFT[round]))) & half_mask;
+		keys[round] = _des_utils::permute((left << half_bits) | right, 2 * half_bits, CP_2);
+	}
+
+	return keys;
+}
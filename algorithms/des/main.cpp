@@ -3,9 +3,32 @@
 #include <iostream>
 #include <cassert>
 
+#include <vector>
+#include <random>
+
 #include "des_encrypter.hpp"
+#include "des_bitslice.hpp"
 #include "triple_des.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "bit_utils.hpp"
+#include "thread_pool.hpp"
+#include "cpu_features.hpp"
+
+namespace
+{
+	std::string random_bytes(uint64_t size, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::string bytes(size, '\0');
+		for (auto& byte : bytes)
+		{
+			byte = static_cast<char>(generator() & 0xff);
+		}
+
+		return bytes;
+	}
+}
 
 TEST_CASE_BEGIN(cipher_base_encrypt_decrypt)
 {
@@ -113,6 +136,200 @@ TEST_CASE_BEGIN(triple_des_ede2_encrypt_decrypt)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(bitslice_known_answers)
+{
+	// FIPS 81 / NBS SP 500-20 vectors: key, plaintext, ciphertext
+	const std::vector<std::vector<std::string>> vectors =
+	{
+		{ "133457799BBCDFF1", "0123456789ABCDEF", "85E813540F0AB405" },
+		{ "0101010101010101", "95F8A5E5DD31D900", "8000000000000000" },
+		{ "0101010101010101", "0000000000000000", "8CA64DE9C1B123A7" },
+		{ "0123456789ABCDEF", "4E6F772069732074", "3FA40E8A984D4815" },
+	};
+
+	for (const auto& vector : vectors)
+	{
+		const std::string key = bit_utils::from_hex(vector[0]);
+		const std::string plain = bit_utils::from_hex(vector[1]);
+		const std::string cipher = bit_utils::from_hex(vector[2]);
+
+		// the scalar rounds, one block is below DES_BITSLICE_MIN_BLOCKS
+		assert(des_encrypter(key).encrypt(plain) == cipher);
+
+		for (auto kernel : des_bitslice::get_kernels())
+		{
+			des_bitslice bitslice(key, kernel);
+			std::string block = plain;
+			bitslice.encrypt_blocks(reinterpret_cast<const uint8_t*>(plain.data()), 
+				reinterpret_cast<uint8_t*>(&block[0]), 1);
+			assert(block == cipher);
+
+			bitslice.decrypt_blocks(reinterpret_cast<const uint8_t*>(cipher.data()), 
+				reinterpret_cast<uint8_t*>(&block[0]), 1);
+			assert(block == plain);
+		}
+	}
+
+	// every kernel matches the scalar rounds block by block, full and partial batches alike
+	const std::string key = "secret_k";
+	des_encrypter scalar(key);
+	for (uint64_t blocks_count : { 1, 63, 64, 65, 255, 256, 257, 700 })
+	{
+		const std::string message = random_bytes(blocks_count * BLOCK_SIZE, static_cast<uint32_t>(blocks_count));
+
+		std::string expected;
+		for (uint64_t i = 0; i < blocks_count; ++i)
+		{
+			expected += scalar.encrypt(message.substr(i * BLOCK_SIZE, BLOCK_SIZE));
+		}
+
+		for (auto kernel : des_bitslice::get_kernels())
+		{
+			des_bitslice bitslice(key, kernel);
+			std::string encrypted(message.size(), '\0');
+			bitslice.encrypt_blocks(reinterpret_cast<const uint8_t*>(message.data()), 
+				reinterpret_cast<uint8_t*>(&encrypted[0]), blocks_count);
+			assert(encrypted == expected);
+
+			// in place
+			bitslice.decrypt_blocks(reinterpret_cast<const uint8_t*>(encrypted.data()), 
+				reinterpret_cast<uint8_t*>(&encrypted[0]), blocks_count);
+			assert(encrypted == message);
+		}
+	}
+
+	// asking for a tier the CPU lacks is an error rather than a silent fallback
+	for (uint32_t i = 0; i < cpu_features::ISA_COUNT; ++i)
+	{
+		const auto level = static_cast<cpu_features::isa>(i);
+		if (cpu_features::is_supported(level))
+		{
+			continue;
+		}
+
+		[[maybe_unused]]
+		bool thrown = false;
+		try
+		{
+			des_bitslice bitslice(key, level);
+		}
+		catch (const des_bitslice::unsupported_kernel&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_ecb_ctr_modes)
+{
+	const std::string key = "secret_k";
+	des_encrypter encrypter(key);
+	thread_pool pool(4);
+
+	for (uint64_t size : { 0, 5, 8, 31, 32, 1000, 8 * 1024 + 3 })
+	{
+		const std::string message = random_bytes(size, static_cast<uint32_t>(size));
+
+		// the bitsliced path gives what the scalar rounds give, one block at a time
+		const std::string encrypted = encrypter.encrypt(message);
+		if (size > 0 && size <= 64)
+		{
+			std::string expected;
+			const std::string padded = message + std::string((BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE, 
+				static_cast<char>((BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE));
+			for (uint64_t i = 0; i < padded.size(); i += BLOCK_SIZE)
+			{
+				expected += encrypter.encrypt(padded.substr(i, BLOCK_SIZE));
+			}
+			assert(encrypted == expected);
+		}
+
+		assert(encrypter.encrypt(message, pool) == encrypted);
+		assert(encrypter.decrypt(encrypted, pool) == encrypter.decrypt(encrypted));
+
+		// counter blocks iv, iv + 1, ... through the scalar rounds, wrapping around 2^64
+		const std::string iv = bit_utils::from_hex("FFFFFFFFFFFFFFFE");
+		const std::string ciphertext = encrypter.crypt_ctr(message, iv);
+		assert(ciphertext.size() == message.size());
+		assert(encrypter.crypt_ctr(message, iv, pool) == ciphertext);
+		assert(encrypter.crypt_ctr(ciphertext, iv) == message);
+		assert(encrypter.crypt_ctr(ciphertext, iv, pool) == message);
+
+		const std::string counters = bit_utils::from_hex("FFFFFFFFFFFFFFFEFFFFFFFFFFFFFFFF0000000000000000");
+		for (uint64_t i = 0; i < std::min<uint64_t>(size, 3 * BLOCK_SIZE); ++i)
+		{
+			[[maybe_unused]]
+			const char keystream = encrypter.encrypt(counters.substr(i / BLOCK_SIZE * BLOCK_SIZE, BLOCK_SIZE))[i % BLOCK_SIZE];
+			assert(static_cast<char>(ciphertext[i] ^ keystream) == message[i]);
+		}
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		encrypter.crypt_ctr("message", "short");
+	}
+	catch (const des_encrypter::invalid_iv&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(bitslice_throughput_benchmark)
+{
+	constexpr uint64_t megabyte = 1 << 20;
+	const std::string key = "secret_k";
+	const std::string message = random_bytes(megabyte, 1);
+
+	des_encrypter encrypter(key);
+
+	// the scalar rounds on a 64 KiB slice, a full megabyte of them takes seconds
+	const uint64_t scalar_blocks = 8 * 1024;
+	const double scalar_seconds = benchmark::measure("des scalar rounds, 64 KiB", 1, [&]()
+	{
+		for (uint64_t i = 0; i < scalar_blocks; ++i)
+		{
+			encrypter.encrypt(message.substr(i * BLOCK_SIZE, BLOCK_SIZE));
+		}
+	});
+	std::cerr << "des scalar rounds: " << scalar_blocks * BLOCK_SIZE / scalar_seconds / megabyte << " MB/s" << std::endl;
+
+	std::string output(message.size(), '\0');
+	for (auto kernel : des_bitslice::get_kernels())
+	{
+		des_bitslice bitslice(key, kernel);
+		const double seconds = benchmark::measure("des_bitslice " + std::string(cpu_features::get_isa_name(kernel)) + ", 1 MiB", 4, [&]()
+		{
+			bitslice.encrypt_blocks(reinterpret_cast<const uint8_t*>(message.data()), 
+				reinterpret_cast<uint8_t*>(&output[0]), message.size() / BLOCK_SIZE);
+		});
+		std::cerr << "des_bitslice " << cpu_features::get_isa_name(kernel) << ": " << 4 / seconds << " MB/s" << std::endl;
+	}
+
+	for (uint64_t threads_count : { 1, 4 })
+	{
+		thread_pool pool(threads_count);
+		const std::string iv(BLOCK_SIZE, '\0');
+		const std::string threads = " on " + std::to_string(threads_count) + " threads";
+
+		const double ecb_seconds = benchmark::measure("des_encrypter::encrypt 1 MiB" + threads, 4, [&]()
+		{
+			encrypter.encrypt(message, pool);
+		});
+		const double ctr_seconds = benchmark::measure("des_encrypter::crypt_ctr 1 MiB" + threads, 4, [&]()
+		{
+			encrypter.crypt_ctr(message, iv, pool);
+		});
+		std::cerr << "ECB " << 4 / ecb_seconds << " MB/s, CTR " << 4 / ctr_seconds << " MB/s" << threads << std::endl;
+	}
+}
+TEST_CASE_END()
+
 int main()
 {
 	try
@@ -122,6 +339,9 @@ int main()
 		triple_des_eee3_encrypt_decrypt();
 		triple_des_ede3_encrypt_decrypt();
 		triple_des_ede2_encrypt_decrypt();
+		bitslice_known_answers();
+		cipher_ecb_ctr_modes();
+		bitslice_throughput_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
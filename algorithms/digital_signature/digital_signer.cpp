@@ -6,157 +6,363 @@
 #include <iomanip>
 #include <sstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 
 #include "gost_hash.hpp"
+#include "hmac_drbg.hpp"
 #include "prime_utils.hpp"
-
-constexpr uint64_t KEY_ALIGN = 64;
-constexpr uint64_t HASH_EXPECTED_SIZE = 256;
+#include "dsa_parameter_store.hpp"
 
 const std::string DEFAULT_HASH_KEY = "12345678900987654321qwertyuiopas";
 
 namespace _signer_utils
 {
-	big_unsigned generate_multiplicate_order(big_unsigned p, big_unsigned q)
+	// (L, N) pairs of FIPS 186-4
+	const std::pair<uint64_t, uint64_t> PARAMETER_SIZES[] =
+	{
+		{ 1024, 160 },
+		{ 2048, 224 },
+		{ 2048, 256 },
+		{ 3072, 256 },
+	};
+
+	void check_parameter_sizes(uint64_t p_bits, uint64_t q_bits)
 	{
+		for (const auto& [allowed_p_bits, allowed_q_bits] : PARAMETER_SIZES)
+		{
+			if (p_bits == allowed_p_bits && q_bits == allowed_q_bits)
+			{
+				return;
+			}
+		}
+
+		throw digital_signer::invalid_parameter_sizes();
+	}
+
+	big_unsigned generate_multiplicate_order(const montgomery_context& context, const big_unsigned& q)
+	{
+		const big_unsigned exponent = (context.get_module() - 1) / q;
+
 		big_unsigned g = 1, h = 2;
 		while (g == 1)
 		{
-			g = modexp(h, (p - 1) / q, p);
+			g = context.exp(h, exponent);
 			++h;
 		}
 
 		return g;
 	}
 
-	big_unsigned generate_prime_number_with_divider(big_unsigned divider)
+	digital_signer::domain_parameters complete_parameters(const big_unsigned& p, const big_unsigned& q)
+	{
+		return { p, q, generate_multiplicate_order(montgomery_context(p), q) };
+	}
+
+	// one table per (p, q, g, budget) while any signer holds it, so signers of the same parameters build it once
+	std::shared_ptr<const fixed_base_power_table> get_generator_table(
+		const montgomery_context& context, 
+		const digital_signer::domain_parameters& parameters, 
+		uint64_t memory_budget)
 	{
-		big_unsigned k = pow(big_unsigned(2), HASH_EXPECTED_SIZE - HASH_EXPECTED_SIZE);
-		big_unsigned result = divider * k + 1;
+		using table_key = std::tuple<big_unsigned, big_unsigned, big_unsigned, uint64_t>;
+		static std::mutex tables_mutex;
+		static std::map<table_key, std::weak_ptr<const fixed_base_power_table>> tables;
 
-		while (!prime_utils::is_prime(result))
+		std::lock_guard<std::mutex> lock(tables_mutex);
+		auto& cached = tables[table_key(parameters.p, parameters.q, parameters.g, memory_budget)];
+
+		std::shared_ptr<const fixed_base_power_table> table = cached.lock();
+		if (!table)
 		{
-			++k;
-			result = divider * k + 1;
+			table = std::make_shared<const fixed_base_power_table>(
+				context, parameters.g, parameters.q.bitLength(), memory_budget);
+			cached = table;
 		}
 
-		return result;
+		return table;
+	}
+
+	// k^-1 mod q as k^(q - 2), q being prime
+	big_unsigned invert(const montgomery_context& q_context, const big_unsigned& k)
+	{
+		return q_context.exp(k, q_context.get_module() - 2);
 	}
-    
-	big_unsigned str_to_bigint(std::string bytes)
+
+	std::tuple<big_unsigned, big_unsigned> generate_signature(
+		const big_unsigned& hash_value, 
+		hmac_drbg& drbg, 
+		const fixed_base_power_table& generator_table, 
+		const montgomery_context& q_context, 
+		const big_unsigned& private_key)
 	{
-		big_unsigned result = 0;
-		bytes[0] &= 0b01111111;
-		for (uint64_t i = 0; i < bytes.size(); ++i)
+		const big_unsigned& q = q_context.get_module();
+		while (true)
 		{
-			for (uint64_t j = 0; j < CHAR_BIT; ++j)
+			const big_unsigned k = drbg.generate_below(q);
+			const big_unsigned r = generator_table.power(k) % q;
+			if (r.isZero())
 			{
-				// optimization
-				if (((bytes[i] >> j) & 1) != 0)
-				{
-					const big_unsigned two = 2;
-					result += pow(two, 256 - 1 - i * CHAR_BIT - j);
-				}
+				continue;
 			}
-		}
 
-		return result;
-	}
-
-    std::tuple<big_unsigned, big_unsigned> generate_signature(const std::string& generated_hash, 
-		big_unsigned p, big_unsigned q, big_unsigned g, big_unsigned private_key)
-    {
-        big_unsigned k = 1, r = 0, s = 0, x = 0;
-		big_unsigned hash_value = str_to_bigint(generated_hash);
-
-        while (true)
-        {
-			x = modexp(g, k, p);
-			r = x % q;
-            if (r == 0)
-            {
-                ++k;
-                continue;
-            }
-            
-            s = (modinv(k, q) * (hash_value + private_key * r) % q);
-
-			if (s == 0)
+			const big_unsigned s = invert(q_context, k) * (hash_value + private_key * r) % q;
+			if (s.isZero())
 			{
-				++k;
 				continue;
 			}
 
-			break;
-        }
-        
-        return {r, s};
-    }
-
-	std::string key_to_string(big_unsigned key_exp, big_unsigned module)
-	{
-		std::stringstream stream;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << module;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << key_exp;
-
-		std::string result(stream.str());
-
-		return result;
+			return { r, s };
+		}
 	}
 }
 
-bool digital_signer::verify_message(const std::string& message) const
+bool digital_signer::verify_message(
+	const std::string& message, 
+	const std::string& signature, 
+	const std::string& public_key) const
 {
-	gost_hash hash_generator(DEFAULT_HASH_KEY);
-	std::string generated_hash = hash_generator.generate_hash(message);
-	big_unsigned hash_value = _signer_utils::str_to_bigint(generated_hash);
+	return _verify_message(message, signature, _decode_public_key(public_key));
+}
+
+bool digital_signer::_verify_message(const std::string& message, const std::string& signature, const big_unsigned& y) const
+{
+	const big_unsigned& q = _parameters.q;
+
+	const uint64_t part_size = get_signature_size() / 2;
+	if (signature.size() != 2 * part_size)
+	{
+		return false;
+	}
 
-	auto signature_it = _signatures.find(generated_hash);
-	if (signature_it == _signatures.end())
+	const big_unsigned r = bytes_to_big_unsigned(signature.substr(0, part_size));
+	const big_unsigned s = bytes_to_big_unsigned(signature.substr(part_size));
+	if (r.isZero() || r >= q || s.isZero() || s >= q)
 	{
 		return false;
 	}
 
-	auto& [r, s] = signature_it->second;
+	gost_hash hash_generator(DEFAULT_HASH_KEY);
+	const big_unsigned hash_value = hmac_drbg::bits_to_int(hash_generator.generate_hash(message), q);
 
-	big_unsigned w = modinv(s, _q);
-	big_unsigned u_1 = (hash_value * w) % _q;
-	big_unsigned u_2 = (r * w) % _q;
-	big_unsigned x = (modexp(_g, u_1, _p) * modexp(_public_key, u_2, _p)) % _p;
-	big_unsigned v = x % _q;
+	big_unsigned w = modinv(s, q);
+	big_unsigned u_1 = (hash_value * w) % q;
+	big_unsigned u_2 = (r * w) % q;
+	// g^u_1 from the table costs only multiplications, which beats sharing the squarings of y^u_2 in dual_exp;
+	// without a table dual_exp stays the cheaper one. A plain operand times a montgomery one gives the plain product
+	big_unsigned x = _generator_table->get_window_bits() == 0 ? 
+		_context.dual_exp(_parameters.g, u_1, y, u_2) : 
+		_context.multiply(_generator_table->power(u_1), _context.to_montgomery(_context.exp(y, u_2)));
+	big_unsigned v = x % q;
 
 	bool verified = v == r;
 	return verified;
 }
 
-digital_signer::digital_signer()
+std::vector<bool> digital_signer::verify_batch(
+	const std::vector<std::string>& messages, 
+	const std::vector<std::string>& signatures, 
+	const std::string& public_key, 
+	thread_pool& pool) const
+{
+	if (messages.size() != signatures.size())
+	{
+		throw invalid_batch();
+	}
+
+	// decoded and checked once up front, so a malformed key throws here and not inside the workers
+	const big_unsigned y = _decode_public_key(public_key);
+
+	// one byte per result, neighbouring std::vector<bool> bits cannot be written from different threads
+	std::vector<uint8_t> verified(messages.size(), 0);
+	pool.parallel_for(messages.size(), [&](uint64_t i)
+	{
+		verified[i] = _verify_message(messages[i], signatures[i], y);
+	});
+
+	return std::vector<bool>(verified.begin(), verified.end());
+}
+
+digital_signer::digital_signer(uint64_t generator_table_bytes)
+	: _parameters(dsa_parameter_store::get_default().get(DEFAULT_DSA_P_BITS, DEFAULT_DSA_Q_BITS))
+	, _context(_parameters.p)
+	, _q_context(_parameters.q)
+	, _generator_table(_signer_utils::get_generator_table(_context, _parameters, generator_table_bytes))
+{
+	_generate_key();
+}
+
+digital_signer::digital_signer(thread_pool& pool, uint64_t p_bits, uint64_t q_bits, uint64_t generator_table_bytes)
+	: _parameters(generate_domain_parameters(p_bits, q_bits, pool))
+	, _context(_parameters.p)
+	, _q_context(_parameters.q)
+	, _generator_table(_signer_utils::get_generator_table(_context, _parameters, generator_table_bytes))
+{
+	_generate_key();
+}
+
+digital_signer::digital_signer(const domain_parameters& parameters, uint64_t generator_table_bytes)
+	: _parameters(parameters)
+	, _context(_parameters.p)
+	, _q_context(_parameters.q)
+	, _generator_table(_signer_utils::get_generator_table(_context, _parameters, generator_table_bytes))
+{
+	_generate_key();
+}
+
+digital_signer::domain_parameters digital_signer::generate_domain_parameters(uint64_t p_bits, uint64_t q_bits)
+{
+	_signer_utils::check_parameter_sizes(p_bits, q_bits);
+
+	const big_unsigned q = prime_utils::generate_prime_number(q_bits);
+	const big_unsigned p = prime_utils::generate_prime_number_with_divider(p_bits, q);
+	return _signer_utils::complete_parameters(p, q);
+}
+
+digital_signer::domain_parameters digital_signer::generate_domain_parameters(uint64_t p_bits, uint64_t q_bits, thread_pool& pool)
 {
-	_q = prime_utils::generate_prime_number(HASH_EXPECTED_SIZE);
-	_p = _signer_utils::generate_prime_number_with_divider(_q);
-	_g = _signer_utils::generate_multiplicate_order(_p, _q);
+	_signer_utils::check_parameter_sizes(p_bits, q_bits);
 
-	_private_key = rand_int(0, _q);
-	_public_key = modexp(_g, _private_key, _p);
+	const big_unsigned q = prime_utils::generate_prime_number(q_bits, pool);
+	const big_unsigned p = prime_utils::generate_prime_number_with_divider(p_bits, q, pool);
+	return _signer_utils::complete_parameters(p, q);
 }
 
-std::string digital_signer::sign_message(const std::string& message)
+bool digital_signer::is_valid(const domain_parameters& parameters)
 {
+	const auto& [p, q, g] = parameters;
+
+	try
+	{
+		_signer_utils::check_parameter_sizes(p.bitLength(), q.bitLength());
+	}
+	catch (const invalid_parameter_sizes&)
+	{
+		return false;
+	}
+
+	// g of order exactly q, q being prime
+	return (p - 1) % q == 0 && g > 1 && g < p && 
+		prime_utils::is_prime(q) && prime_utils::is_prime(p) && 
+		montgomery_context(p).exp(g, q) == 1;
+}
+
+std::string digital_signer::sign_message(const std::string& message) const
+{
+	// the leftmost N bits of the hash as in FIPS 186-4, also the h RFC 6979 seeds the nonces with
+	const big_unsigned& q = _parameters.q;
 	gost_hash hash_generator(DEFAULT_HASH_KEY);
-	std::string generated_hash = hash_generator.generate_hash(message);
+	const big_unsigned hash_value = hmac_drbg::bits_to_int(hash_generator.generate_hash(message), q);
+
+	big_unsigned r, s;
+
+	nonce precomputed;
+	if (_nonce_pool && _nonce_pool->try_take(precomputed))
+	{
+		r = precomputed.r;
+		s = precomputed.k_inv * (hash_value + _private_key * r) % q;
+	}
 
-    auto [r, s] = _signer_utils::generate_signature(generated_hash, _p, _q, _g, _private_key);
+	// no precomputed nonce, or one giving s == 0
+	if (s.isZero())
+	{
+		hmac_drbg drbg(hash_generator, hmac_drbg::int_to_octets(_private_key, q) + 
+			hmac_drbg::int_to_octets(hash_value % q, q));
+		std::tie(r, s) = _signer_utils::generate_signature(hash_value, drbg, *_generator_table, _q_context, _private_key);
+	}
 
-	_signatures.insert({ generated_hash, {r, s} });
-	
-	return _signer_utils::key_to_string(r, s);
+	const uint64_t part_size = get_signature_size() / 2;
+	return big_unsigned_to_bytes(r, part_size) + big_unsigned_to_bytes(s, part_size);
 }
 
 std::string digital_signer::get_public_key() const
 {
-	return bigUnsignedToString(_public_key);
+	return big_unsigned_to_bytes(_public_key, big_unsigned_bytes_count(_parameters.p));
+}
+
+uint64_t digital_signer::get_signature_size() const
+{
+	return 2 * big_unsigned_bytes_count(_parameters.q);
+}
+
+const digital_signer::domain_parameters& digital_signer::get_domain_parameters() const
+{
+	return _parameters;
+}
+
+const fixed_base_power_table& digital_signer::get_generator_table() const
+{
+	return *_generator_table;
+}
+
+void digital_signer::start_precomputation(uint64_t capacity, uint64_t refill_watermark)
+{
+	stop_precomputation();
+
+	// fresh entropy next to the key, so no two pools, nor a pool and the per-message nonces, share a k
+	hmac_drbg drbg(gost_hash(DEFAULT_HASH_KEY), 
+		hmac_drbg::int_to_octets(_private_key, _parameters.q) + hmac_drbg::get_entropy(DRBG_SEED_SIZE));
+	_nonce_pool = std::make_unique<precomputation_pool<nonce>>(capacity, refill_watermark, 
+		[drbg, generator_table = _generator_table, q_context = _q_context]() mutable
+	{
+		const big_unsigned& q = q_context.get_module();
+		while (true)
+		{
+			const big_unsigned k = drbg.generate_below(q);
+			big_unsigned r = generator_table->power(k) % q;
+			if (!r.isZero())
+			{
+				return nonce{ std::move(r), _signer_utils::invert(q_context, k) };
+			}
+		}
+	});
+}
+
+void digital_signer::stop_precomputation()
+{
+	_nonce_pool.reset();
+}
+
+uint64_t digital_signer::get_precomputed_count() const
+{
+	return _nonce_pool ? _nonce_pool->size() : 0;
+}
+
+big_unsigned digital_signer::_decode_public_key(const std::string& public_key) const
+{
+	if (public_key.size() != big_unsigned_bytes_count(_parameters.p))
+	{
+		throw invalid_key();
+	}
+
+	big_unsigned y = bytes_to_big_unsigned(public_key);
+	if (y <= 1 || y >= _parameters.p)
+	{
+		throw invalid_key();
+	}
+
+	return y;
+}
+
+void digital_signer::_generate_key()
+{
+	// uniform in [1, q - 1] from fresh entropy, generate_below never returns zero
+	hmac_drbg drbg(gost_hash(DEFAULT_HASH_KEY), hmac_drbg::get_entropy(DRBG_SEED_SIZE));
+	_private_key = drbg.generate_below(_parameters.q);
+	_public_key = _generator_table->power(_private_key);
 }
 
 const char* digital_signer::invalid_key::what() const throw ()
 {
-	return "No key for this message exists in current storage!";
+	return "Public key has invalid size or is out of range!";
+}
+
+const char* digital_signer::invalid_parameter_sizes::what() const throw ()
+{
+	return "Domain parameter sizes should be one of the FIPS 186-4 (L, N) pairs!";
+}
+
+const char* digital_signer::invalid_batch::what() const throw ()
+{
+	return "Every message of a batch needs exactly one signature!";
 }
@@ -1,11 +1,29 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 #include "big_integer.hpp"
+#include "thread_pool.hpp"
+#include "montgomery_context.hpp"
+#include "fixed_base_power_table.hpp"
+#include "precomputation_pool.hpp"
 
+// bit lengths of p and q, (L, N) in FIPS 186-4 terms
+constexpr uint64_t DEFAULT_DSA_P_BITS = 2048;
+constexpr uint64_t DEFAULT_DSA_Q_BITS = 256;
+
+/*
+  DSA signer. Signing needs only the private key; verification is a const function of the message,
+  the signature and a public key, so any instance sharing the domain parameters, on any thread, can
+  verify what another one signed. Signatures are r || s (each the byte length of q) and public keys
+  are y (the byte length of p), big-endian and fixed-size. Powers of g, in key generation, signing and
+  verification, come from a fixed-base table of at most generator_table_bytes shared by all signers
+  of the same domain parameters and budget. Nonces are derived from the private key and the message
+  hash as in RFC 6979 (HMAC_DRBG over gost_hash), so signing the same message twice gives the same
+  signature, unless a precomputed one is taken from the pool of start_precomputation()
+*/
 class digital_signer
 {
 public:
@@ -14,22 +32,93 @@ public:
 		const char* what() const throw ();
 	};
 
-	digital_signer();
+	struct invalid_batch : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct invalid_parameter_sizes : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// primes p and q with q | p - 1, g of order q modulo p
+	struct domain_parameters
+	{
+		big_unsigned p;
+		big_unsigned q;
+		big_unsigned g;
+	};
+
+	// domain parameters of the default sizes from dsa_parameter_store::get_default(), so only the first
+	// signer of a process that did not load them from a file waits for their generation
+	explicit digital_signer(uint64_t generator_table_bytes = DEFAULT_POWER_TABLE_BYTES);
+	// fresh domain parameters, with the prime searches of the generation raced on the workers of the pool
+	explicit digital_signer(
+		thread_pool& pool, 
+		uint64_t p_bits = DEFAULT_DSA_P_BITS, 
+		uint64_t q_bits = DEFAULT_DSA_Q_BITS, 
+		uint64_t generator_table_bytes = DEFAULT_POWER_TABLE_BYTES);
+	// new key pair within existing domain parameters, e.g. to verify signatures of another instance
+	explicit digital_signer(const domain_parameters& parameters, uint64_t generator_table_bytes = DEFAULT_POWER_TABLE_BYTES);
 	~digital_signer() = default;
 
-	std::string sign_message(const std::string& message);
-	bool verify_message(const std::string& message) const;
+	// random N-bit q, then p stepping over 1 mod 2q from a random L-bit start with the small primes
+	// sieved out, then g = h^((p - 1) / q) for the first h giving g != 1. Throws invalid_parameter_sizes
+	// unless (p_bits, q_bits) is one of the FIPS 186-4 pairs: (1024, 160), (2048, 224), (2048, 256), (3072, 256)
+	static domain_parameters generate_domain_parameters(uint64_t p_bits, uint64_t q_bits);
+	static domain_parameters generate_domain_parameters(uint64_t p_bits, uint64_t q_bits, thread_pool& pool);
+	// FIPS 186-4 sizes, p and q prime, q | p - 1 and g of order q
+	static bool is_valid(const domain_parameters& parameters);
+
+	std::string sign_message(const std::string& message) const;
+	// false for any malformed signature, throws invalid_key for a malformed public key
+	bool verify_message(const std::string& message, const std::string& signature, const std::string& public_key) const;
+	// verifies signatures[i] of messages[i] on the pool, hashing included, results keep the order of messages.
+	// Randomized linear-combination batching does not apply: r keeps only (g^k mod p) mod q, so the
+	// powers a combined check would multiply cannot be recovered from the signatures
+	std::vector<bool> verify_batch(
+		const std::vector<std::string>& messages, 
+		const std::vector<std::string>& signatures, 
+		const std::string& public_key, 
+		thread_pool& pool) const;
 
 	std::string get_public_key() const;
+	uint64_t get_signature_size() const;
+	const domain_parameters& get_domain_parameters() const;
+	const fixed_base_power_table& get_generator_table() const;
+
+	// (r, k^-1) pairs of nonces drawn from an HMAC_DRBG seeded with the private key and fresh entropy,
+	// generated on a background thread; sign_message takes one when there is any, which leaves it the
+	// hashing and s = k^-1 (h + x r) mod q. Restarts a running pool; neither call may overlap signing
+	void start_precomputation(
+		uint64_t capacity = DEFAULT_PRECOMPUTATION_CAPACITY, 
+		uint64_t refill_watermark = DEFAULT_PRECOMPUTATION_CAPACITY / 2);
+	void stop_precomputation();
+	uint64_t get_precomputed_count() const;
 
 private:
+	struct nonce
+	{
+		big_unsigned r;
+		big_unsigned k_inv;
+	};
+
+	big_unsigned _decode_public_key(const std::string& public_key) const;
+	// verify_message with the public key already decoded
+	bool _verify_message(const std::string& message, const std::string& signature, const big_unsigned& y) const;
+	void _generate_key();
+
 	big_unsigned _private_key;
 	big_unsigned _public_key;
 
-    std::unordered_map<std::string, std::tuple<big_unsigned, big_unsigned>> _signatures;
+	domain_parameters _parameters;
+	// modulo p, every exponentiation of the signer runs in it
+	montgomery_context _context;
+	// modulo q, nonces are inverted as k^(q - 2) in it, in a time that does not depend on k
+	montgomery_context _q_context;
+	// powers of g modulo p for exponents below q
+	std::shared_ptr<const fixed_base_power_table> _generator_table;
 
-	// domain params
-	big_unsigned _p = 0;
-	big_unsigned _q = 0;
-	big_unsigned _g = 0;
+	std::unique_ptr<precomputation_pool<nonce>> _nonce_pool;
 };
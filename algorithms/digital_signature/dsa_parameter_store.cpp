@@ -0,0 +1,144 @@
+#include "dsa_parameter_store.hpp"
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace _store_utils
+{
+	std::string to_hex(const big_unsigned& value)
+	{
+		return std::string(BigUnsignedInABase(value, 16));
+	}
+
+	big_unsigned from_hex(const std::string& hex)
+	{
+		try
+		{
+			return big_unsigned(BigUnsignedInABase(hex, 16));
+		}
+		catch (const char*)
+		{
+			throw dsa_parameter_store::invalid_file();
+		}
+	}
+}
+
+dsa_parameter_store& dsa_parameter_store::get_default()
+{
+	static dsa_parameter_store store;
+	return store;
+}
+
+void dsa_parameter_store::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		throw invalid_file();
+	}
+
+	// parsed and validated in full before anything is stored
+	std::vector<digital_signer::domain_parameters> loaded;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::stringstream line_stream(line);
+		std::string p, q, g, rest;
+		if (!(line_stream >> p) || p[0] == '#')
+		{
+			continue;
+		}
+		if (!(line_stream >> q >> g) || (line_stream >> rest))
+		{
+			throw invalid_file();
+		}
+
+		digital_signer::domain_parameters parameters =
+		{
+			_store_utils::from_hex(p),
+			_store_utils::from_hex(q),
+			_store_utils::from_hex(g),
+		};
+		if (!digital_signer::is_valid(parameters))
+		{
+			throw invalid_file();
+		}
+
+		loaded.push_back(std::move(parameters));
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& parameters : loaded)
+	{
+		_parameters[_get_sizes(parameters)] = std::move(parameters);
+	}
+}
+
+void dsa_parameter_store::save(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		throw invalid_file();
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (const auto& [set_sizes, parameters] : _parameters)
+	{
+		file << "# " << set_sizes.first << " " << set_sizes.second << "\n";
+		file << _store_utils::to_hex(parameters.p) << " " <<
+			_store_utils::to_hex(parameters.q) << " " <<
+			_store_utils::to_hex(parameters.g) << "\n";
+	}
+
+	if (!file.flush())
+	{
+		throw invalid_file();
+	}
+}
+
+digital_signer::domain_parameters dsa_parameter_store::get(uint64_t p_bits, uint64_t q_bits)
+{
+	// generating under the lock, concurrent first requests wait for one generation instead of each running their own
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto found = _parameters.find({ p_bits, q_bits });
+	if (found == _parameters.end())
+	{
+		found = _parameters.emplace(sizes(p_bits, q_bits), digital_signer::generate_domain_parameters(p_bits, q_bits)).first;
+	}
+
+	return found->second;
+}
+
+void dsa_parameter_store::add(const digital_signer::domain_parameters& parameters)
+{
+	if (!digital_signer::is_valid(parameters))
+	{
+		throw invalid_parameters();
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_parameters[_get_sizes(parameters)] = parameters;
+}
+
+bool dsa_parameter_store::contains(uint64_t p_bits, uint64_t q_bits) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _parameters.count({ p_bits, q_bits }) != 0;
+}
+
+dsa_parameter_store::sizes dsa_parameter_store::_get_sizes(const digital_signer::domain_parameters& parameters)
+{
+	return { parameters.p.bitLength(), parameters.q.bitLength() };
+}
+
+const char* dsa_parameter_store::invalid_file::what() const throw ()
+{
+	return "Parameter file cannot be accessed or holds a malformed or invalid parameter set!";
+}
+
+const char* dsa_parameter_store::invalid_parameters::what() const throw ()
+{
+	return "Domain parameters fail validation!";
+}
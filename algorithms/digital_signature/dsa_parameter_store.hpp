@@ -0,0 +1,55 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "digital_signer.hpp"
+
+/*
+  Domain parameter sets by (L, N), kept in memory and exchanged through text files with one
+  "p q g" line of hex numbers per set; empty lines and lines starting with # are skipped.
+  Every set is validated before it is stored, whether loaded, added or generated
+*/
+class dsa_parameter_store
+{
+public:
+	struct invalid_file : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct invalid_parameters : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	dsa_parameter_store() = default;
+	~dsa_parameter_store() = default;
+
+	dsa_parameter_store(const dsa_parameter_store&) = delete;
+	dsa_parameter_store& operator = (const dsa_parameter_store&) = delete;
+
+	// the process-wide store digital_signer() takes its parameters from
+	static dsa_parameter_store& get_default();
+
+	// adds every set of the file, replacing stored sets of the same sizes. Throws invalid_file for a file
+	// that cannot be read or holds a malformed or invalid set, in which case nothing is added
+	void load(const std::string& path);
+	void save(const std::string& path) const;
+
+	// the stored set of these sizes, generated and stored on the first request
+	digital_signer::domain_parameters get(uint64_t p_bits, uint64_t q_bits);
+	// throws invalid_parameters unless digital_signer::is_valid accepts the set
+	void add(const digital_signer::domain_parameters& parameters);
+	bool contains(uint64_t p_bits, uint64_t q_bits) const;
+
+private:
+	using sizes = std::pair<uint64_t, uint64_t>;
+
+	static sizes _get_sizes(const digital_signer::domain_parameters& parameters);
+
+	mutable std::mutex _mutex;
+	std::map<sizes, digital_signer::domain_parameters> _parameters;
+};
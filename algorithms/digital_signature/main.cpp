@@ -1,9 +1,27 @@
 #include <iostream>
 #include <string>
 #include <cassert>
+#include <algorithm>
+#include <vector>
 
 #include "digital_signer.hpp"
 #include "testing.hpp"
+#include "bit_utils.hpp"
+#include "benchmark.hpp"
+#include "thread_pool.hpp"
+#include "prime_utils.hpp"
+#include "dsa_parameter_store.hpp"
+#include "fixed_base_power_table.hpp"
+#include "bounded_queue.hpp"
+#include "hmac_drbg.hpp"
+#include "gost_hash.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <fstream>
+
+const std::string DEFAULT_HASH_KEY_FOR_TESTS = "12345678900987654321qwertyuiopas";
 
 TEST_CASE_BEGIN(signer_base_sign_verify)
 {
@@ -13,17 +31,623 @@ TEST_CASE_BEGIN(signer_base_sign_verify)
 	std::cout << "initial message to sign " << message << std::endl;
 
 	std::string signature = signer.sign_message(message);
-	std::cout << "signature " << signature << std::endl;
+	std::cout << "signature " << bit_utils::to_hex(signature) << std::endl;
+	assert(signature.size() == signer.get_signature_size());
 
 	const std::string& public_key = signer.get_public_key();
-	std::cout << "public key " << public_key << std::endl;
+	std::cout << "public key " << bit_utils::to_hex(public_key) << std::endl;
+
+	// verification is stateless: another signer with the same domain parameters accepts the signature
+	digital_signer verifier(signer.get_domain_parameters());
 
 	[[maybe_unused]]
-	bool verified = signer.verify_message(message);
+	bool verified = verifier.verify_message(message, signature, public_key);
 
 	std::cout << "is signature verified? " << verified << std::endl;
 
 	assert(verified);
+	assert(!verifier.verify_message(message + ".", signature, public_key));
+	assert(!verifier.verify_message(message, signature.substr(1), public_key));
+	assert(!verifier.verify_message(message, std::string(signature.size(), '\0'), public_key));
+	assert(!verifier.verify_message(message, signature, verifier.get_public_key()));
+
+	std::string tampered = signature;
+	tampered.back() ^= 1;
+	assert(!verifier.verify_message(message, tampered, public_key));
+
+	std::string bad_key(public_key.size(), '\0');
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		verifier.verify_message(message, signature, bad_key);
+	}
+	catch (const digital_signer::invalid_key&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(dual_modexp_benchmark)
+{
+	const big_unsigned p = stringToBigUnsigned("57896044618658097711785492504343953926634992332820282019728792003956564821041");
+	const big_unsigned g = stringToBigUnsigned("1234567890123456789012345678901234567890");
+	const big_unsigned y = stringToBigUnsigned("52435875175126190479447740508185965837690552500527637822603658699938581184513");
+	const big_unsigned u_1 = stringToBigUnsigned("43308876546767276905765904595650931995942111794451039583252968842033849580414");
+	const big_unsigned u_2 = stringToBigUnsigned("57896044618658097711785492504343953927082934583725450622380973592137631069619");
+	constexpr uint64_t iterations_count = 200;
+
+	for (const auto& [e_1, e_2] : { std::make_tuple(big_unsigned(0), big_unsigned(0)),
+		std::make_tuple(big_unsigned(1), big_unsigned(0)), std::make_tuple(big_unsigned(0), big_unsigned(3)),
+		std::make_tuple(big_unsigned(5), u_2), std::make_tuple(u_1, u_2) })
+	{
+		[[maybe_unused]]
+		big_unsigned separate = (modexp(g, e_1, p) * modexp(y, e_2, p)) % p;
+		assert(dual_modexp(g, e_1, y, e_2, p) == separate);
+	}
+
+	double separate_seconds = benchmark::measure("modexp * modexp", iterations_count, [&]()
+	{
+		(modexp(g, u_1, p) * modexp(y, u_2, p)) % p;
+	});
+
+	double dual_seconds = benchmark::measure("dual_modexp", iterations_count, [&]()
+	{
+		dual_modexp(g, u_1, y, u_2, p);
+	});
+
+	std::cerr << "dual_modexp speedup: " << separate_seconds / dual_seconds << "x" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_verify_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t iterations_count = 100;
+
+	digital_signer signer;
+	const std::string signature = signer.sign_message(message);
+	const std::string public_key = signer.get_public_key();
+
+	benchmark::measure("digital_signer::verify_message", iterations_count, [&]()
+	{
+		[[maybe_unused]]
+		bool verified = signer.verify_message(message, signature, public_key);
+		assert(verified);
+	});
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(generator_table_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t iterations_count = 100;
+
+	const digital_signer::domain_parameters parameters = digital_signer().get_domain_parameters();
+	const montgomery_context context(parameters.p);
+	const uint64_t q_bits = parameters.q.bitLength();
+
+	// budgets from none at all (plain exp) up to the widest window
+	for (uint64_t budget : { uint64_t(0), uint64_t(1) << 16, DEFAULT_POWER_TABLE_BYTES, uint64_t(1) << 24 })
+	{
+		fixed_base_power_table table(context, parameters.g, q_bits, budget);
+		assert(table.get_memory_size() <= budget);
+		std::cerr << "budget " << budget << ": " << table.get_window_bits() << "-bit windows, " << 
+			table.get_memory_size() << " bytes" << std::endl;
+
+		for (const big_unsigned& exponent : { big_unsigned(0), big_unsigned(1), big_unsigned(2), 
+			parameters.q - 1, prime_utils::generate_prime_candidate(q_bits), 
+			prime_utils::generate_prime_candidate(q_bits + 64) })
+		{
+			[[maybe_unused]]
+			bool equal = table.power(exponent) == context.exp(parameters.g, exponent);
+			assert(equal);
+		}
+	}
+
+	const big_unsigned exponent = prime_utils::generate_prime_candidate(q_bits);
+	fixed_base_power_table table(context, parameters.g, q_bits);
+	double exp_seconds = benchmark::measure("montgomery_context::exp of g", iterations_count, [&]()
+	{
+		context.exp(parameters.g, exponent);
+	});
+	double table_seconds = benchmark::measure("fixed_base_power_table::power", iterations_count, [&]()
+	{
+		table.power(exponent);
+	});
+	std::cerr << "fixed-base table speedup: " << exp_seconds / table_seconds << "x" << std::endl;
+
+	for (uint64_t budget : { uint64_t(0), DEFAULT_POWER_TABLE_BYTES })
+	{
+		digital_signer signer(parameters, budget);
+		const std::string signature = signer.sign_message(message);
+		const std::string public_key = signer.get_public_key();
+		const std::string label = " with a " + std::to_string(budget) + " bytes table";
+
+		benchmark::measure("digital_signer::sign_message" + label, iterations_count, [&]()
+		{
+			signer.sign_message(message);
+		});
+		benchmark::measure("digital_signer::verify_message" + label, iterations_count, [&]()
+		{
+			[[maybe_unused]]
+			bool verified = signer.verify_message(message, signature, public_key);
+			assert(verified);
+		});
+	}
+
+	const big_unsigned y = bytes_to_big_unsigned(digital_signer(parameters).get_public_key());
+	const big_unsigned u_2 = prime_utils::generate_prime_candidate(q_bits);
+	benchmark::measure("montgomery_context::dual_exp", iterations_count, [&]()
+	{
+		context.dual_exp(parameters.g, exponent, y, u_2);
+	});
+	benchmark::measure("fixed_base_power_table::power * montgomery_context::exp", iterations_count, [&]()
+	{
+		context.multiply(table.power(exponent), context.to_montgomery(context.exp(y, u_2)));
+	});
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(bounded_queue_test)
+{
+	bounded_queue<uint64_t> queue(5);
+	assert(queue.get_capacity() == 8);
+
+	uint64_t value = 0;
+	assert(!queue.try_pop(value));
+	for (uint64_t i = 0; i < 8; ++i)
+	{
+		[[maybe_unused]]
+		bool pushed = queue.try_push(uint64_t(i));
+		assert(pushed);
+	}
+	assert(!queue.try_push(uint64_t(8)));
+	assert(queue.size() == 8);
+
+	for (uint64_t i = 0; i < 8; ++i)
+	{
+		[[maybe_unused]]
+		bool popped = queue.try_pop(value);
+		assert(popped && value == i);
+	}
+	assert(!queue.try_pop(value));
+
+	// every value pushed by the producers is popped exactly once by the consumers
+	constexpr uint64_t threads_count = 4;
+	constexpr uint64_t values_count = 20000;
+	std::atomic<uint64_t> popped_count{ 0 };
+	std::atomic<uint64_t> popped_sum{ 0 };
+
+	std::vector<std::thread> threads;
+	for (uint64_t t = 0; t < threads_count; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint64_t i = t; i < values_count; i += threads_count)
+			{
+				while (!queue.try_push(uint64_t(i)))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+		threads.emplace_back([&]()
+		{
+			uint64_t popped = 0;
+			while (popped_count.load() < values_count)
+			{
+				if (queue.try_pop(popped))
+				{
+					popped_sum += popped;
+					++popped_count;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	assert(popped_count.load() == values_count);
+	assert(popped_sum.load() == values_count * (values_count - 1) / 2);
+	assert(queue.size() == 0);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_deterministic_nonce_test)
+{
+	const gost_hash hash(DEFAULT_HASH_KEY_FOR_TESTS);
+
+	hmac_drbg drbg(hash, "seed");
+	hmac_drbg same_drbg(hash, "seed");
+	hmac_drbg other_drbg(hash, "seee");
+
+	const std::string bytes = drbg.generate(100);
+	assert(bytes.size() == 100);
+	assert(same_drbg.generate(100) == bytes);
+	assert(other_drbg.generate(100) != bytes);
+	// the state moves on after every call
+	assert(drbg.generate(100) != bytes);
+
+	same_drbg.reseed("more");
+	assert(same_drbg.generate(32) != drbg.generate(32));
+
+	assert(hmac_drbg::hmac(hash, "key", "message").size() == HASH_BLOCK_SIZE);
+	assert(hmac_drbg::hmac(hash, "key", "message") != hmac_drbg::hmac(hash, "kex", "message"));
+	assert(hmac_drbg::hmac(hash, std::string(100, 'k'), "message") == 
+		hmac_drbg::hmac(hash, hash.generate_hash(std::string(100, 'k')), "message"));
+
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+
+	digital_signer signer;
+	const std::string signature = signer.sign_message(message);
+	const std::string other_signature = signer.sign_message(message + ".");
+	[[maybe_unused]]
+	const uint64_t part_size = signer.get_signature_size() / 2;
+
+	// the same message and key give the same k, other messages another one
+	assert(signer.sign_message(message) == signature);
+	assert(signature.substr(0, part_size) != other_signature.substr(0, part_size));
+	assert(signer.verify_message(message, signature, signer.get_public_key()));
+	assert(signer.verify_message(message + ".", other_signature, signer.get_public_key()));
+
+	// k == 1 used to make r == g mod q for every signature
+	const digital_signer::domain_parameters& parameters = signer.get_domain_parameters();
+	assert(bytes_to_big_unsigned(signature.substr(0, part_size)) != parameters.g % parameters.q);
+
+	// another key signs the same message with another k
+	digital_signer other_signer(parameters);
+	assert(other_signer.sign_message(message).substr(0, part_size) != signature.substr(0, part_size));
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_truncated_hash_test)
+{
+	// a 160-bit q under the 256-bit gost_hash: e is the leftmost 160 bits, not the whole hash mod q
+	const digital_signer::domain_parameters parameters = digital_signer::generate_domain_parameters(1024, 160);
+	const big_unsigned& q = parameters.q;
+	digital_signer signer(parameters);
+
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	const std::string hash = gost_hash(DEFAULT_HASH_KEY_FOR_TESTS).generate_hash(message);
+	const big_unsigned e = bytes_to_big_unsigned(hash.substr(0, 20));
+	assert(e != bytes_to_big_unsigned(hash) % q);
+
+	const std::string signature = signer.sign_message(message);
+	assert(signer.verify_message(message, signature, signer.get_public_key()));
+	assert(signer.sign_message(message) == signature);
+
+	// the verification of FIPS 186-4 with that e, apart from the signer
+	const uint64_t part_size = signer.get_signature_size() / 2;
+	const big_unsigned r = bytes_to_big_unsigned(signature.substr(0, part_size));
+	const big_unsigned s = bytes_to_big_unsigned(signature.substr(part_size));
+	const big_unsigned y = bytes_to_big_unsigned(signer.get_public_key());
+	const big_unsigned w = modinv(s, q);
+	const big_unsigned v = modexp(parameters.g, e * w % q, parameters.p) * modexp(y, r * w % q, parameters.p) % 
+		parameters.p % q;
+	assert(v == r);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_precomputation_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t capacity = 32;
+	constexpr uint64_t iterations_count = 32;
+
+	digital_signer signer;
+	const std::string public_key = signer.get_public_key();
+
+	const std::vector<double> online_samples = benchmark::sample(iterations_count, [&]()
+	{
+		signer.sign_message(message);
+	});
+
+	signer.start_precomputation(capacity, capacity / 2);
+	while (signer.get_precomputed_count() < capacity)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::vector<std::string> signatures;
+	const std::vector<double> pool_samples = benchmark::sample(iterations_count, [&]()
+	{
+		signatures.push_back(signer.sign_message(message));
+	});
+
+	// precomputed nonces do not depend on the message, so the same message gets a new signature each time
+	for (const std::string& signature : signatures)
+	{
+		[[maybe_unused]]
+		bool verified = signer.verify_message(message, signature, public_key);
+		assert(verified);
+	}
+	assert(signatures.front() != signatures.back());
+
+	// drained past the pool, signing falls back to per-message nonces
+	for (uint64_t i = 0; i < capacity; ++i)
+	{
+		assert(signer.verify_message(message, signer.sign_message(message), public_key));
+	}
+
+	signer.stop_precomputation();
+	assert(signer.get_precomputed_count() == 0);
+
+	for (const auto& [name, samples] : { std::make_pair("per-message nonce", online_samples), 
+		std::make_pair("precomputed nonce", pool_samples) })
+	{
+		std::cerr << "digital_signer::sign_message with " << name << ": p50 " << 
+			benchmark::percentile(samples, 50) * 1000.0 << " ms, p99 " << 
+			benchmark::percentile(samples, 99) * 1000.0 << " ms" << std::endl;
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_verify_batch_benchmark)
+{
+	constexpr uint64_t max_batch_size = 64;
+	constexpr uint64_t repeats_count = 2;
+
+	digital_signer signer;
+	const std::string public_key = signer.get_public_key();
+	std::vector<std::string> messages;
+	std::vector<std::string> signatures;
+	for (uint64_t i = 0; i < max_batch_size; ++i)
+	{
+		messages.push_back("message number " + std::to_string(i));
+		signatures.push_back(signer.sign_message(messages.back()));
+	}
+
+	for (uint64_t threads_count : { 1, 4 })
+	{
+		thread_pool pool(threads_count);
+
+		std::vector<std::string> batch = { messages[0], "never signed", messages[1] };
+		std::vector<std::string> batch_signatures = { signatures[0], signatures[1], signatures[1] };
+		[[maybe_unused]]
+		std::vector<bool> verified = signer.verify_batch(batch, batch_signatures, public_key, pool);
+		assert(verified.size() == 3 && verified[0] && !verified[1] && verified[2]);
+
+		for (uint64_t batch_size : { 1, 16, 64 })
+		{
+			batch.assign(messages.begin(), messages.begin() + batch_size);
+			batch_signatures.assign(signatures.begin(), signatures.begin() + batch_size);
+
+			double seconds = benchmark::measure("digital_signer::verify_batch " + std::to_string(batch_size) + 
+				" on " + std::to_string(threads_count) + " threads", repeats_count, [&]()
+			{
+				[[maybe_unused]]
+				std::vector<bool> batch_verified = signer.verify_batch(batch, batch_signatures, public_key, pool);
+				assert(std::all_of(batch_verified.begin(), batch_verified.end(), [](bool v) { return v; }));
+			});
+
+			std::cerr << "verifications/sec: " << batch_size * repeats_count / seconds << std::endl;
+		}
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(is_prime_test)
+{
+	for ([[maybe_unused]] uint64_t prime : { 2, 3, 5, 7, 16381, 16411, 65537, 2147483647 })
+	{
+		assert(prime_utils::is_prime(big_unsigned(static_cast<unsigned long>(prime))));
+	}
+
+	// Carmichael numbers and products of primes above the sieve bound
+	for ([[maybe_unused]] uint64_t composite : { 0, 1, 4, 561, 1105, 41041, 269320921 /* 16411^2 */, 269419387 /* 16411 * 16417 */ })
+	{
+		assert(!prime_utils::is_prime(big_unsigned(static_cast<unsigned long>(composite))));
+	}
+
+	// 2^127 - 1 is prime, 2^128 + 1 is not
+	const big_unsigned mersenne = (big_unsigned(1) << 127) - 1;
+	assert(prime_utils::is_prime(mersenne));
+	assert(!prime_utils::is_prime((big_unsigned(1) << 128) + 1));
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(prime_generation_benchmark)
+{
+	for (uint64_t bit_length : { 2, 3, 8, 14, 15, 16, 64 })
+	{
+		for (uint64_t i = 0; i < 20; ++i)
+		{
+			[[maybe_unused]]
+			big_unsigned prime = prime_utils::generate_prime_number(bit_length);
+			assert(prime.bitLength() == bit_length);
+			assert(prime_utils::is_prime(prime));
+		}
+	}
+
+	for (uint64_t bit_length : { 512, 1024, 2048 })
+	{
+		const uint64_t iterations_count = 4096 / bit_length;
+
+		double sieved_seconds = benchmark::measure("prime_utils::generate_prime_number(" + std::to_string(bit_length) + ")", 
+			iterations_count, [&]()
+		{
+			[[maybe_unused]]
+			big_unsigned prime = prime_utils::generate_prime_number(bit_length);
+			assert(prime.bitLength() == bit_length);
+		});
+
+		// a few seconds per 1024-bit prime already, the slower searches are left out
+		if (bit_length != 512)
+		{
+			continue;
+		}
+
+		// the previous search: a fresh random candidate every time, only even numbers skipped
+		double fresh_seconds = benchmark::measure("fresh candidates (" + std::to_string(bit_length) + ")", 
+			iterations_count, [&]()
+		{
+			while (!prime_utils::is_prime(prime_utils::generate_prime_candidate(bit_length)));
+		});
+
+		std::cerr << "sieved search speedup: " << fresh_seconds / sieved_seconds << "x" << std::endl;
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(parallel_prime_generation_benchmark)
+{
+	constexpr uint64_t bit_length = 512;
+	constexpr uint64_t iterations_count = 8;
+
+	const big_unsigned mersenne = (big_unsigned(1) << 127) - 1;
+	const big_unsigned carmichael = 41041;
+
+	benchmark::measure("prime_utils::generate_prime_number(" + std::to_string(bit_length) + ")", iterations_count, [&]()
+	{
+		prime_utils::generate_prime_number(bit_length);
+	});
+
+	for (uint64_t threads_count : { 1, 4 })
+	{
+		thread_pool pool(threads_count);
+
+		assert(prime_utils::is_prime(mersenne, 10, pool));
+		assert(!prime_utils::is_prime(carmichael, 10, pool));
+		assert(!prime_utils::is_prime(mersenne * mersenne, 10, pool));
+
+		// cycles over 2^k - 1 for k in [108, 127], of which only 2^127 - 1 is prime
+		[[maybe_unused]]
+		big_unsigned found = prime_utils::find_prime([](uint64_t i)
+		{
+			return (big_unsigned(1) << static_cast<int>(108 + i % 20)) - 1;
+		}, pool);
+		assert(found == mersenne);
+
+		benchmark::measure("prime_utils::generate_prime_number(" + std::to_string(bit_length) + ") on " + 
+			std::to_string(threads_count) + " threads", iterations_count, [&]()
+		{
+			[[maybe_unused]]
+			big_unsigned prime = prime_utils::generate_prime_number(bit_length, pool);
+			assert(prime.bitLength() == bit_length);
+			assert(prime_utils::is_prime(prime, 10, pool));
+		});
+
+		benchmark::measure("digital_signer(1024, 160) on " + std::to_string(threads_count) + " threads", 2, [&]()
+		{
+			digital_signer signer(pool, 1024, 160);
+			[[maybe_unused]]
+			const digital_signer::domain_parameters& parameters = signer.get_domain_parameters();
+			assert((parameters.p - 1) % parameters.q == 0);
+			assert(prime_utils::is_prime(parameters.p) && prime_utils::is_prime(parameters.q));
+
+			[[maybe_unused]]
+			bool verified = signer.verify_message("message", signer.sign_message("message"), signer.get_public_key());
+			assert(verified);
+		});
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(domain_parameters_store_test)
+{
+	const std::string path = "dsa_parameters_test.txt";
+
+	digital_signer::domain_parameters small_parameters;
+	benchmark::measure("digital_signer::generate_domain_parameters(1024, 160)", 1, [&]()
+	{
+		small_parameters = digital_signer::generate_domain_parameters(1024, 160);
+	});
+	assert(small_parameters.p.bitLength() == 1024 && small_parameters.q.bitLength() == 160);
+	assert(digital_signer::is_valid(small_parameters));
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		digital_signer::generate_domain_parameters(1024, 256);
+	}
+	catch (const digital_signer::invalid_parameter_sizes&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	// g of order other than q, and p - 1 not divisible by q
+	digital_signer::domain_parameters broken = small_parameters;
+	broken.g = broken.p - 1;
+	assert(!digital_signer::is_valid(broken));
+	broken = small_parameters;
+	broken.p += 2;
+	assert(!digital_signer::is_valid(broken));
+
+	dsa_parameter_store store;
+	assert(!store.contains(1024, 160));
+	store.add(small_parameters);
+	assert(store.contains(1024, 160));
+
+	thrown = false;
+	try
+	{
+		store.add(broken);
+	}
+	catch (const dsa_parameter_store::invalid_parameters&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	// the default sizes come from the process-wide store, generated by the first signer at the latest
+	const digital_signer::domain_parameters default_parameters = 
+		dsa_parameter_store::get_default().get(DEFAULT_DSA_P_BITS, DEFAULT_DSA_Q_BITS);
+	assert(default_parameters.p.bitLength() == DEFAULT_DSA_P_BITS && default_parameters.q.bitLength() == DEFAULT_DSA_Q_BITS);
+	store.add(default_parameters);
+	store.save(path);
+
+	dsa_parameter_store loaded_store;
+	benchmark::measure("dsa_parameter_store::load", 1, [&]()
+	{
+		loaded_store.load(path);
+	});
+	assert(loaded_store.contains(1024, 160) && loaded_store.contains(DEFAULT_DSA_P_BITS, DEFAULT_DSA_Q_BITS));
+
+	const digital_signer::domain_parameters loaded = loaded_store.get(1024, 160);
+	assert(loaded.p == small_parameters.p && loaded.q == small_parameters.q && loaded.g == small_parameters.g);
+
+	benchmark::measure("digital_signer from stored parameters", 4, [&]()
+	{
+		digital_signer signer(loaded_store.get(DEFAULT_DSA_P_BITS, DEFAULT_DSA_Q_BITS));
+		[[maybe_unused]]
+		bool verified = signer.verify_message("message", signer.sign_message("message"), signer.get_public_key());
+		assert(verified);
+	});
+
+	// a malformed line, and a well-formed set that does not validate
+	for (const std::string& contents : { std::string("# comment\n12 34\n"), std::string("zz 11 22\n"), 
+		std::string("17 11 5\n") })
+	{
+		{
+			std::ofstream file(path);
+			file << contents;
+		}
+
+		thrown = false;
+		try
+		{
+			dsa_parameter_store broken_store;
+			broken_store.load(path);
+		}
+		catch (const dsa_parameter_store::invalid_file&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	std::remove(path.c_str());
 }
 TEST_CASE_END()
 
@@ -32,6 +656,18 @@ int main()
 	try
 	{
 		signer_base_sign_verify();
+		dual_modexp_benchmark();
+		signer_verify_benchmark();
+		generator_table_benchmark();
+		bounded_queue_test();
+		signer_deterministic_nonce_test();
+		signer_truncated_hash_test();
+		signer_precomputation_benchmark();
+		signer_verify_batch_benchmark();
+		is_prime_test();
+		prime_generation_benchmark();
+		parallel_prime_generation_benchmark();
+		domain_parameters_store_test();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
@@ -0,0 +1,135 @@
+#include "elliptical_curve.hpp"
+
+const elliptical_curve& elliptical_curve::get(const std::string& name)
+{
+	static const elliptical_curve p192(P192_CURVE,
+		stringToBigUnsigned("6277101735386680763835789423207666416083908700390324961279"),
+		stringToBigInteger("-3"),
+		stringToBigInteger("2455155546008943817740293915197451784769108058161191238065"),
+		stringToBigUnsigned("6277101735386680763835789423176059013767194773182842284081"),
+		stringToBigInteger("602046282375688656758213480587526111916698976636884684818"),
+		stringToBigInteger("174050332293622031404857552280219410364023488927386650641"));
+
+	static const elliptical_curve gost_256(GOST_256_CURVE,
+		stringToBigUnsigned("57896044618658097711785492504343953926634992332820282019728792003956564821041"),
+		stringToBigInteger("7"),
+		stringToBigInteger("43308876546767276905765904595650931995942111794451039583252968842033849580414"),
+		stringToBigUnsigned("57896044618658097711785492504343953927082934583725450622380973592137631069619"),
+		stringToBigInteger("2"),
+		stringToBigInteger("4018974056539037503335449422937059775635739389905545080690979365213431566280"));
+
+	static const elliptical_curve gost_512(GOST_512_CURVE,
+		stringToBigUnsigned("3623986102229003635907788753683874306021320925534678605086546150450856166624002482588482022271496854025090823603058735163734263822371964987228582907372403"),
+		stringToBigInteger("7"),
+		stringToBigInteger("1518655069210828534508950034714043154928747527740206436194018823352809982443793732829756914785974674866041605397883677596626326413990136959047435811826396"),
+		stringToBigUnsigned("3623986102229003635907788753683874306021320925534678605086546150450856166623969164898305032863068499961404079437936585455865192212970734808812618120619743"),
+		stringToBigInteger("1928356944067022849399309401243137598997786635459507974357075491307766592685835441065557681003184874819658004903212332884252335830250729527632383493573274"),
+		stringToBigInteger("2288728693371972859970012155529478416353562327329506180314497425931102860301572814141997072271708807066593850650334152381857347798885864807605098724013854"));
+
+	for (const elliptical_curve* curve : { &p192, &gost_256, &gost_512 })
+	{
+		if (curve->get_name() == name)
+		{
+			return *curve;
+		}
+	}
+
+	throw unknown_curve();
+}
+
+std::vector<std::string> elliptical_curve::get_names()
+{
+	return { P192_CURVE, GOST_256_CURVE, GOST_512_CURVE };
+}
+
+elliptical_curve::elliptical_curve(
+	const std::string& name,
+	const big_unsigned& p,
+	const big_integer& a,
+	const big_integer& b,
+	const big_unsigned& q,
+	const big_integer& x,
+	const big_integer& y)
+	: _name(name)
+	, _p(p)
+	, _a(a)
+	, _b(b)
+	, _q(q)
+	, _arithmetic(a, p)
+	, _generator(x, y, *this)
+{}
+
+bool elliptical_curve::contains(const big_integer& x, const big_integer& y) const
+{
+	const big_integer module = _p;
+
+	big_integer difference = (y * y - (x * x * x + _a * x + _b)) % module;
+	return difference == 0;
+}
+
+jacobian_point elliptical_curve::to_jacobian(const elliptical_point& point) const
+{
+	return _arithmetic.from_affine(point.x, point.y);
+}
+
+elliptical_point elliptical_curve::from_jacobian(const jacobian_point& point) const
+{
+	elliptical_point result_point;
+	result_point.curve = this;
+	std::tie(result_point.x, result_point.y) = _arithmetic.to_affine(point);
+
+	return result_point;
+}
+
+std::shared_ptr<const fixed_base_table> elliptical_curve::get_generator_table(uint32_t window_bits) const
+{
+	std::lock_guard<std::mutex> lock(_tables_mutex);
+
+	auto& table = _generator_tables[window_bits];
+	if (!table)
+	{
+		table = std::make_shared<const fixed_base_table>(_generator, _q.bitLength(), window_bits);
+	}
+
+	return table;
+}
+
+const std::string& elliptical_curve::get_name() const
+{
+	return _name;
+}
+
+const big_unsigned& elliptical_curve::get_p() const
+{
+	return _p;
+}
+
+const big_integer& elliptical_curve::get_a() const
+{
+	return _a;
+}
+
+const big_integer& elliptical_curve::get_b() const
+{
+	return _b;
+}
+
+const big_unsigned& elliptical_curve::get_q() const
+{
+	return _q;
+}
+
+const elliptical_point& elliptical_curve::get_generator() const
+{
+	return _generator;
+}
+
+const jacobian_arithmetic& elliptical_curve::get_arithmetic() const
+{
+	return _arithmetic;
+}
+
+const char* elliptical_curve::unknown_curve::what() const throw ()
+{
+	return "No curve with such name is known!";
+}
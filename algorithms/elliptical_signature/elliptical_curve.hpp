@@ -0,0 +1,76 @@
+#pragma once
+#include "big_integer.hpp"
+#include "elliptical_point.hpp"
+#include "jacobian_point.hpp"
+#include "fixed_base_table.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// named curves known to elliptical_curve::get
+const std::string P192_CURVE = "p192";
+// example curves of GOST R 34.10-2012 (appendix A)
+const std::string GOST_256_CURVE = "gost256";
+const std::string GOST_512_CURVE = "gost512";
+
+/*
+  Curve y^2 = x^3 + ax + b over GF(p) with a generator G of prime order q. Everything derived from
+  the parameters lives here once: the montgomery context and jacobian arithmetic of p, and the lazily
+  built fixed-base tables of G. Points keep only their coordinates and a pointer to their curve, so
+  a curve must neither move nor die while its points are in use
+*/
+class elliptical_curve
+{
+public:
+	struct unknown_curve : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	static const elliptical_curve& get(const std::string& name);
+	static std::vector<std::string> get_names();
+
+	elliptical_curve(
+		const std::string& name,
+		const big_unsigned& p,
+		const big_integer& a,
+		const big_integer& b,
+		const big_unsigned& q,
+		const big_integer& x,
+		const big_integer& y);
+	~elliptical_curve() = default;
+
+	elliptical_curve(const elliptical_curve&) = delete;
+	elliptical_curve& operator = (const elliptical_curve&) = delete;
+
+	bool contains(const big_integer& x, const big_integer& y) const;
+
+	jacobian_point to_jacobian(const elliptical_point& point) const;
+	elliptical_point from_jacobian(const jacobian_point& point) const;
+
+	// tables are built on first use, once per width, and shared between callers
+	std::shared_ptr<const fixed_base_table> get_generator_table(uint32_t window_bits = DEFAULT_TABLE_WINDOW_BITS) const;
+
+	const std::string& get_name() const;
+	const big_unsigned& get_p() const;
+	const big_integer& get_a() const;
+	const big_integer& get_b() const;
+	const big_unsigned& get_q() const;
+	const elliptical_point& get_generator() const;
+	const jacobian_arithmetic& get_arithmetic() const;
+
+private:
+	std::string _name;
+	big_unsigned _p;
+	big_integer _a;
+	big_integer _b;
+	big_unsigned _q;
+
+	jacobian_arithmetic _arithmetic;
+	elliptical_point _generator;
+
+	mutable std::mutex _tables_mutex;
+	mutable std::map<uint32_t, std::shared_ptr<const fixed_base_table>> _generator_tables;
+};
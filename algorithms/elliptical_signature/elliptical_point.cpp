@@ -1,110 +1,283 @@
 #include "elliptical_point.hpp"
+#include "jacobian_point.hpp"
+#include "elliptical_curve.hpp"
+#include <algorithm>
 
-elliptical_point::elliptical_point(const elliptical_point& point)
-	: x(point.x)
-	, y(point.y)
-	, a(point.a)
-	, b(point.b)
-	, p(point.p)
-{}
+namespace _point_utils
+{
+	void check_window_bits(uint32_t window_bits)
+	{
+		if (window_bits < 2 || window_bits > MAX_WNAF_WINDOW_BITS)
+		{
+			throw elliptical_point::invalid_window();
+		}
+	}
+
+	// count bits of the scalar starting at bit, read straight from its limbs
+	uint32_t get_bits(const big_unsigned& scalar, big_unsigned::Index bit, uint32_t count)
+	{
+		const big_unsigned::Index block = bit / big_unsigned::N;
+		const uint32_t shift = bit % big_unsigned::N;
+
+		unsigned long bits = scalar.getBlock(block) >> shift;
+		if (shift + count > big_unsigned::N)
+		{
+			bits |= scalar.getBlock(block + 1) << (big_unsigned::N - shift);
+		}
+
+		return static_cast<uint32_t>(bits & ((1ul << count) - 1));
+	}
+
+	// appends base, 3 * base, ..., (2^(w-1) - 1) * base, left for the caller to normalize
+	void append_odd_multiples(
+		const jacobian_arithmetic& arithmetic, 
+		const jacobian_point& base, 
+		uint32_t window_bits, 
+		std::vector<jacobian_point>& table)
+	{
+		const uint64_t multiples_count = uint64_t(1) << (window_bits - 2);
+		const jacobian_point twice = arithmetic.double_point(base);
+
+		table.push_back(base);
+		for (uint64_t i = 1; i < multiples_count; ++i)
+		{
+			table.push_back(arithmetic.add(table.back(), twice));
+		}
+	}
+
+	// adds digit * base to result, odd_multiples[i] holding (2i + 1) * base
+	void add_digit(
+		const jacobian_arithmetic& arithmetic, 
+		jacobian_point& result, 
+		int32_t digit, 
+		const jacobian_point* odd_multiples)
+	{
+		if (digit > 0)
+		{
+			result = arithmetic.add(result, odd_multiples[(digit - 1) / 2]);
+		}
+		else if (digit < 0)
+		{
+			result = arithmetic.add(result, arithmetic.negate(odd_multiples[(-digit - 1) / 2]));
+		}
+	}
+}
+
+elliptical_point::elliptical_point(const elliptical_point& point) = default;
+
+elliptical_point::elliptical_point(elliptical_point&& point) noexcept = default;
 
 elliptical_point::elliptical_point() = default;
 
-elliptical_point::elliptical_point(
-	const big_integer& _x, 
-	const big_integer& _y, 
-	const big_integer& _a, 
-	const big_integer& _b, 
-	const big_unsigned& _p)
+elliptical_point::elliptical_point(const big_integer& _x, const big_integer& _y, const elliptical_curve& _curve)
 	: x(_x)
 	, y(_y)
-	, a(_a)
-	, b(_b)
-	, p(_p)
+	, curve(&_curve)
 {}
 
+elliptical_point& elliptical_point::operator=(const elliptical_point& point) = default;
+
+elliptical_point& elliptical_point::operator=(elliptical_point&& point) noexcept = default;
+
 std::string elliptical_point::to_string() const
 {
 	return 
 		bigIntegerToString(x) + " " +
 		bigIntegerToString(y) + " " +
-		bigIntegerToString(a) + " " +
-		bigIntegerToString(b) + " " +
-		bigUnsignedToString(p);
+		bigIntegerToString(curve->get_a()) + " " +
+		bigIntegerToString(curve->get_b()) + " " +
+		bigUnsignedToString(curve->get_p());
 }
 
 elliptical_point elliptical_point::double_point(const elliptical_point& other_point)
 {
 	elliptical_point result_point;
-	result_point.a = other_point.a;
-	result_point.b = other_point.b;
-	result_point.p = other_point.p;
+	result_point.curve = other_point.curve;
 
-	big_integer dy = big_integer(3) * other_point.x * other_point.x + other_point.a;
+	const big_integer module = other_point.curve->get_p();
+
+	big_integer dy = big_integer(3) * other_point.x * other_point.x + other_point.curve->get_a();
 	big_integer dx = big_integer(2) * other_point.y;
 
 	if (dx < 0)
-		dx += other_point.p;
+		dx += module;
 	if (dy < 0)
-		dy += other_point.p;
+		dy += module;
 
-	big_integer m = (dy * modinv(dx, other_point.p)) % other_point.p;
-	result_point.x = (m * m - other_point.x - other_point.x) % other_point.p;
-	result_point.y = (m * (other_point.x - result_point.x) - other_point.y) % other_point.p;
+	big_integer m = (dy * modinv(dx, other_point.curve->get_p())) % module;
+	result_point.x = (m * m - other_point.x - other_point.x) % module;
+	result_point.y = (m * (other_point.x - result_point.x) - other_point.y) % module;
 	if (result_point.x < 0)
-		result_point.x += other_point.p;
+		result_point.x += module;
 	if (result_point.y < 0)
-		result_point.y += other_point.p;
+		result_point.y += module;
 
 	return result_point;
 }
 
-elliptical_point elliptical_point::multiply(big_integer x, elliptical_point point)
+std::vector<int32_t> elliptical_point::wnaf_recode(const big_unsigned& scalar, uint32_t window_bits)
 {
+	_point_utils::check_window_bits(window_bits);
+
+	// one extra digit for the final carry
+	const big_unsigned::Index digits_count = scalar.bitLength() + 1;
+	std::vector<int32_t> digits(digits_count, 0);
+
+	uint32_t carry = 0;
+	big_unsigned::Index bit = 0;
+	while (bit < digits_count)
+	{
+		// the bit plus the carry is even, the digit stays zero
+		if (static_cast<uint32_t>(scalar.getBit(bit)) == carry)
+		{
+			++bit;
+			continue;
+		}
+
+		const uint32_t width = std::min<big_unsigned::Index>(window_bits, digits_count - bit);
+		int32_t word = static_cast<int32_t>(_point_utils::get_bits(scalar, bit, width) + carry);
+
+		// words of 2^(w-1) and above become negative digits and carry one into the next window
+		carry = (word >> (window_bits - 1)) & 1;
+		word -= static_cast<int32_t>(carry << window_bits);
+
+		digits[bit] = word;
+		bit += width;
+	}
+
+	return digits;
+}
+
+elliptical_point elliptical_point::multiply(const big_integer& x, const elliptical_point& point, uint32_t window_bits)
+{
+	const jacobian_arithmetic& arithmetic = point.curve->get_arithmetic();
+	const std::vector<int32_t> digits = wnaf_recode(x.getMagnitude(), window_bits);
+
+	jacobian_point base = point.curve->to_jacobian(point);
+	if (x.getSign() == big_integer::negative)
+	{
+		base = arithmetic.negate(base);
+	}
+
+	std::vector<jacobian_point> odd_multiples;
+	_point_utils::append_odd_multiples(arithmetic, base, window_bits, odd_multiples);
+	arithmetic.normalize(odd_multiples);
+
+	// left-to-right over the digits, one doubling per digit and one addition per nonzero digit
+	jacobian_point result;
+	for (size_t i = digits.size(); i > 0; --i)
+	{
+		result = arithmetic.double_point(result);
+		_point_utils::add_digit(arithmetic, result, digits[i - 1], odd_multiples.data());
+	}
+
+	return point.curve->from_jacobian(result);
+}
+
+elliptical_point elliptical_point::multiply_joint(
+	const big_integer& x1, 
+	const elliptical_point& point1, 
+	const big_integer& x2, 
+	const elliptical_point& point2,
+	uint32_t window_bits)
+{
+	const jacobian_arithmetic& arithmetic = point1.curve->get_arithmetic();
+	std::vector<int32_t> digits1 = wnaf_recode(x1.getMagnitude(), window_bits);
+	std::vector<int32_t> digits2 = wnaf_recode(x2.getMagnitude(), window_bits);
+
+	const size_t digits_count = std::max(digits1.size(), digits2.size());
+	digits1.resize(digits_count, 0);
+	digits2.resize(digits_count, 0);
+
+	// signs are moved onto the points, so the digits come from the magnitudes only
+	jacobian_point base1 = point1.curve->to_jacobian(point1);
+	jacobian_point base2 = point2.curve->to_jacobian(point2);
+	if (x1.getSign() == big_integer::negative)
+	{
+		base1 = arithmetic.negate(base1);
+	}
+	if (x2.getSign() == big_integer::negative)
+	{
+		base2 = arithmetic.negate(base2);
+	}
+
+	// both tables in one vector, so they share a single inversion
+	std::vector<jacobian_point> odd_multiples;
+	_point_utils::append_odd_multiples(arithmetic, base1, window_bits, odd_multiples);
+	const size_t multiples_count = odd_multiples.size();
+	_point_utils::append_odd_multiples(arithmetic, base2, window_bits, odd_multiples);
+	arithmetic.normalize(odd_multiples);
+
+	jacobian_point result;
+	for (size_t i = digits_count; i > 0; --i)
+	{
+		result = arithmetic.double_point(result);
+		_point_utils::add_digit(arithmetic, result, digits1[i - 1], odd_multiples.data());
+		_point_utils::add_digit(arithmetic, result, digits2[i - 1], odd_multiples.data() + multiples_count);
+	}
+
+	return point1.curve->from_jacobian(result);
+}
+
+elliptical_point elliptical_point::multiply_affine(const big_integer& x, const elliptical_point& point)
+{
+	// only the scalar and the doubled addend are mutated, the result starts from the point itself
+	big_integer scalar = x;
+	elliptical_point addend = point;
 	elliptical_point temp = point;
-	--x;
-	while (x != 0)
+	--scalar;
+	while (scalar != 0)
 	{
-		if ((x % 2) != 0)
+		if ((scalar % 2) != 0)
 		{
-			if ((temp.x == point.x) || (temp.y == point.y))
+			if ((temp.x == addend.x) || (temp.y == addend.y))
 				temp = double_point(temp);
 			else
-				temp = temp + point;
+				temp += addend;
 
-			--x;
+			--scalar;
 		}
-		x /= 2;
-		point = double_point(point);
+		scalar /= 2;
+		addend = double_point(addend);
 	}
 	return temp;
 }
 
-elliptical_point elliptical_point::operator+(const elliptical_point& other_point)
+elliptical_point elliptical_point::operator+(const elliptical_point& other_point) const
 {
-	elliptical_point result_point;
-	result_point.a = a;
-	result_point.b = b;
-	result_point.p = p;
+	elliptical_point result_point(*this);
+	result_point += other_point;
+	return result_point;
+}
+
+elliptical_point& elliptical_point::operator+=(const elliptical_point& other_point)
+{
+	const big_integer module = curve->get_p();
 
 	big_integer dy = other_point.y - y;
 	big_integer dx = other_point.x - x;
 
 	if (dx < 0)
-		dx += p;
+		dx += module;
 	if (dy < 0)
-		dy += p;
+		dy += module;
 
-	big_integer m = (dy * modinv(dx, p)) % p;
+	big_integer m = (dy * modinv(dx, curve->get_p())) % module;
 	if (m < 0)
-		m += p;
+		m += module;
 
-	result_point.x = (m * m - x - other_point.x) % p;
-	result_point.y = (m * (x - result_point.x) - y) % p;
+	big_integer result_x = (m * m - x - other_point.x) % module;
+	y = (m * (x - result_x) - y) % module;
+	x = std::move(result_x);
 
-	if (result_point.x < 0)
-		result_point.x += p;
-	if (result_point.y < 0)
-		result_point.y += p;
-	return result_point;
+	if (x < 0)
+		x += module;
+	if (y < 0)
+		y += module;
+	return *this;
+}
+
+const char* elliptical_point::invalid_window::what() const throw ()
+{
+	return "wNAF window width must be in [2, MAX_WNAF_WINDOW_BITS]!";
 }
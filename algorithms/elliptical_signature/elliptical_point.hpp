@@ -1,31 +1,60 @@
 #pragma once
 #include "big_integer.hpp"
 #include <string>
+#include <vector>
+
+constexpr uint32_t DEFAULT_WNAF_WINDOW_BITS = 4;
+constexpr uint32_t MAX_WNAF_WINDOW_BITS = 8;
+
+class elliptical_curve;
 
 struct elliptical_point
 {
 public:
-	static elliptical_point multiply(big_integer x, elliptical_point point);
+	struct invalid_window : public std::exception
+	{
+		const char* what() const throw ();
+	};
 
-	elliptical_point(const elliptical_point& point);
-	elliptical_point(
+	// width-w NAF digits of the scalar, least significant first: every nonzero digit is odd,
+	// below 2^(w-1) in magnitude and followed by at least w - 1 zeros
+	static std::vector<int32_t> wnaf_recode(const big_unsigned& scalar, uint32_t window_bits);
+
+	// wNAF scalar multiplication in jacobian coordinates over a table of 2^(w-2) odd multiples,
+	// converted back to affine once at the end
+	static elliptical_point multiply(
 		const big_integer& x, 
-		const big_integer& y, 
-		const big_integer& a,
-		const big_integer& b, 
-		const big_unsigned& p);
+		const elliptical_point& point, 
+		uint32_t window_bits = DEFAULT_WNAF_WINDOW_BITS);
+	// x1 * point1 + x2 * point2 with interleaved wNAF sharing one doubling chain (Straus-Shamir),
+	// points must be on the same curve
+	static elliptical_point multiply_joint(
+		const big_integer& x1, 
+		const elliptical_point& point1, 
+		const big_integer& x2, 
+		const elliptical_point& point2,
+		uint32_t window_bits = DEFAULT_WNAF_WINDOW_BITS);
+	// reference affine double-and-add, pays a modular inversion for each addition and doubling
+	static elliptical_point multiply_affine(const big_integer& x, const elliptical_point& point);
+
+	elliptical_point(const elliptical_point& point);
+	elliptical_point(elliptical_point&& point) noexcept;
+	elliptical_point(const big_integer& x, const big_integer& y, const elliptical_curve& curve);
 	elliptical_point();
 
-	elliptical_point operator + (const elliptical_point& other_point);
+	elliptical_point& operator = (const elliptical_point& point);
+	elliptical_point& operator = (elliptical_point&& point) noexcept;
+
+	elliptical_point operator + (const elliptical_point& other_point) const;
+	elliptical_point& operator += (const elliptical_point& other_point);
 
 	std::string to_string() const;
 
 	big_integer x;
 	big_integer y;
-	big_integer a;
-	big_integer b;
-	big_unsigned p;
+	// not owned, curves outlive their points (named curves live for the whole program)
+	const elliptical_curve* curve = nullptr;
 
 private:
 	static elliptical_point double_point(const elliptical_point& other_point);
-};
\ No newline at end of file
+};
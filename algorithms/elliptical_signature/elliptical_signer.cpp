@@ -8,109 +8,124 @@
 #include <iostream>
 
 #include "gost_hash.hpp"
-#include "prime_utils.hpp"
+#include "hmac_drbg.hpp"
 #include "elliptical_point.hpp"
 
-constexpr uint64_t KEY_ALIGN = 64;
-
 const std::string DEFAULT_HASH_KEY = "12345678900987654321qwertyuiopas";
 
-const big_unsigned CURVE_P = stringToBigUnsigned("6277101735386680763835789423207666416083908700390324961279");
-const big_integer CURVE_A = stringToBigInteger("-3");
-const big_integer CURVE_B = stringToBigInteger("2455155546008943817740293915197451784769108058161191238065");
-const big_integer CURVE_X = stringToBigInteger("602046282375688656758213480587526111916698976636884684818");
-const big_integer CURVE_Y = stringToBigInteger("174050332293622031404857552280219410364023488927386650641");
-const big_unsigned CURVE_Q = stringToBigUnsigned("6277101735386680763835789423176059013767194773182842284081");
-
-const elliptical_point G_POINT(CURVE_X, CURVE_Y, CURVE_A, CURVE_B, CURVE_P);
-
-namespace _signer_utils
+bool elliptical_signer::verify_message(
+	const std::string& message, 
+	const std::string& signature, 
+	const std::string& public_key) const
 {
-	big_integer str_to_bigint(std::string bytes)
-	{
-		big_unsigned result = 0;
-		bytes[0] &= 0b01111111;
-		for (uint64_t i = 0; i < bytes.size(); ++i)
-		{
-			for (uint64_t j = 0; j < CHAR_BIT; ++j)
-			{
-				// optimization
-				if (((bytes[i] >> j) & 1) != 0)
-				{
-					const big_unsigned two = 2;
-					result += pow(two, 256 - 1 - i * CHAR_BIT - j);
-				}
-			}
-		}
-
-		return result;
-	}
-
-	std::string key_to_string(big_integer key_exp, big_integer module)
-	{
-		std::stringstream stream;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << module;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << key_exp;
-
-		std::string result(stream.str());
-
-		return result;
-	}
+	return _verify_message(message, signature, _decode_public_key(public_key));
 }
 
-bool elliptical_signer::verify_message(const std::string& message) const
+bool elliptical_signer::_verify_message(
+	const std::string& message, 
+	const std::string& signature, 
+	const elliptical_point& key_point) const
 {
-	gost_hash hash_generator(DEFAULT_HASH_KEY);
-	std::string generated_hash = hash_generator.generate_hash(message);
-	big_integer hash_value = _signer_utils::str_to_bigint(generated_hash);
-
-	auto signature_it = _signatures.find(generated_hash);
-	if (signature_it == _signatures.end())
+	const uint64_t part_size = get_signature_size() / 2;
+	if (signature.size() != 2 * part_size)
 	{
 		return false;
 	}
 
-	auto& [r, s] = signature_it->second;
+	const big_integer r = bytes_to_big_unsigned(signature.substr(0, part_size));
+	const big_integer s = bytes_to_big_unsigned(signature.substr(part_size));
 
-	if (r < 1 || r > (CURVE_Q - 1) || s < 1 || s > (CURVE_Q - 1)) 
+	const big_unsigned& q = _curve->get_q();
+	if (r < 1 || r > (q - 1) || s < 1 || s > (q - 1)) 
 	{
 		return false;
 	}
 
-	big_integer e = hash_value % CURVE_Q;
+	gost_hash hash_generator(DEFAULT_HASH_KEY);
+	std::string generated_hash = hash_generator.generate_hash(message);
+	big_integer hash_value = bytes_to_big_unsigned(generated_hash);
+
+	big_integer e = hash_value % q;
 	if (e == 0)
 	{
 		e = 1;
 	}
 
-	big_integer v = modinv(e, CURVE_Q);
-	big_integer z1 = (s * v) % CURVE_Q;
-	big_integer z2 = big_integer(CURVE_Q) + ((-(r * v)) % CURVE_Q);
+	big_integer v = modinv(e, q);
+	big_integer z1 = (s * v) % q;
+	big_integer z2 = big_integer(q) + ((-(r * v)) % q);
 
-	elliptical_point a = elliptical_point::multiply(z1, G_POINT);
-	elliptical_point b = elliptical_point::multiply(z2, _public_key);
-	elliptical_point c = a + b;
-	big_integer theoretical_r = c.x % CURVE_Q;
+	elliptical_point c = elliptical_point::multiply_joint(z1, _curve->get_generator(), z2, key_point);
+	big_integer theoretical_r = c.x % q;
 
 	bool verified = theoretical_r == r;
 	return verified;
 }
 
-elliptical_signer::elliptical_signer()
+std::vector<bool> elliptical_signer::verify_batch(
+	const std::vector<std::string>& messages, 
+	const std::vector<std::string>& signatures, 
+	const std::string& public_key, 
+	thread_pool& pool) const
 {
-	uint64_t n_bits_count = bigIntegerToString(CURVE_Q).size();
+	if (messages.size() != signatures.size())
+	{
+		throw invalid_batch();
+	}
+
+	// decoded and checked once up front, so a malformed key throws here and not inside the workers
+	const elliptical_point key_point = _decode_public_key(public_key);
+
+	// one byte per result, neighbouring std::vector<bool> bits cannot be written from different threads
+	std::vector<uint8_t> verified(messages.size(), 0);
+	pool.parallel_for(messages.size(), [&](uint64_t i)
+	{
+		verified[i] = _verify_message(messages[i], signatures[i], key_point);
+	});
+
+	return std::vector<bool>(verified.begin(), verified.end());
+}
+
+elliptical_signer::elliptical_signer(const std::string& curve_name, uint32_t generator_window_bits)
+	: _curve(&elliptical_curve::get(curve_name))
+	, _generator_table(_curve->get_generator_table(generator_window_bits))
+{
+	// uniform in [1, q - 1], generate_below never returns zero
+	hmac_drbg drbg(gost_hash(DEFAULT_HASH_KEY), hmac_drbg::get_entropy(DRBG_SEED_SIZE));
+	_private_key = drbg.generate_below(_curve->get_q());
+	_public_key = _generator_table->multiply(_private_key);
+}
+
+elliptical_signer::elliptical_signer(
+	const std::string& curve_name, 
+	const std::string& private_key, 
+	uint32_t generator_window_bits)
+	: _curve(&elliptical_curve::get(curve_name))
+	, _generator_table(_curve->get_generator_table(generator_window_bits))
+{
+	const big_unsigned& q = _curve->get_q();
+	if (private_key.size() != big_unsigned_bytes_count(q))
+	{
+		throw invalid_private_key();
+	}
+
+	_private_key = bytes_to_big_unsigned(private_key);
+	if (_private_key.isZero() || _private_key >= q)
+	{
+		throw invalid_private_key();
+	}
 
-	_private_key = prime_utils::generate_prime_candidate(n_bits_count);
-	_public_key = elliptical_point::multiply(_private_key, G_POINT);
+	_public_key = _generator_table->multiply(_private_key);
 }
 
-std::string elliptical_signer::sign_message(const std::string& message)
+std::string elliptical_signer::sign_message(const std::string& message) const
 {
 	gost_hash hash_generator(DEFAULT_HASH_KEY);
 	std::string generated_hash = hash_generator.generate_hash(message);
-	big_integer hash_value = _signer_utils::str_to_bigint(generated_hash);
+	big_integer hash_value = bytes_to_big_unsigned(generated_hash);
 
-	big_integer e = hash_value % CURVE_Q;
+	const big_unsigned& q = _curve->get_q();
+	big_integer e = hash_value % q;
 	if (e == 0)
 	{
 		e = 1;
@@ -119,39 +134,108 @@ std::string elliptical_signer::sign_message(const std::string& message)
 	big_integer r;
 	big_integer s;
 
-	uint64_t n_bits_count = bigIntegerToString(CURVE_Q).size();
-
-	while (true)
+	nonce precomputed;
+	if (_nonce_pool && _nonce_pool->try_take(precomputed))
 	{
-		big_integer k = prime_utils::generate_prime_candidate(n_bits_count);
-		elliptical_point c = elliptical_point::multiply(k, G_POINT);
+		r = precomputed.r;
+		s = (r * _private_key + precomputed.k * e) % q;
+	}
 
-		r = c.x % CURVE_Q;
-		if (r == 0)
+	// no precomputed nonce, or one giving s == 0: k of RFC 6979, uniform below q, each retry a new draw
+	if (s == 0)
+	{
+		hmac_drbg drbg(hash_generator, hmac_drbg::int_to_octets(_private_key, q) + 
+			hmac_drbg::int_to_octets(hmac_drbg::bits_to_int(generated_hash, q) % q, q));
+		while (s == 0)
 		{
-			continue;
+			big_integer k = drbg.generate_below(q);
+			r = _generator_table->multiply(k).x % q;
+			if (r == 0)
+			{
+				continue;
+			}
+
+			s = (r * _private_key + k * e) % q;
 		}
+	}
 
-		s = (r * _private_key + k * e) % CURVE_Q;
-		if (s == 0)
+	const uint64_t part_size = get_signature_size() / 2;
+	return big_unsigned_to_bytes(r.getMagnitude(), part_size) + big_unsigned_to_bytes(s.getMagnitude(), part_size);
+}
+
+std::string elliptical_signer::get_public_key() const
+{
+	const uint64_t part_size = big_unsigned_bytes_count(_curve->get_p());
+	return big_unsigned_to_bytes(_public_key.x.getMagnitude(), part_size) + 
+		big_unsigned_to_bytes(_public_key.y.getMagnitude(), part_size);
+}
+
+uint64_t elliptical_signer::get_signature_size() const
+{
+	return 2 * big_unsigned_bytes_count(_curve->get_q());
+}
+
+void elliptical_signer::start_precomputation(uint64_t capacity, uint64_t refill_watermark)
+{
+	stop_precomputation();
+
+	const big_unsigned& q = _curve->get_q();
+	hmac_drbg drbg(gost_hash(DEFAULT_HASH_KEY), 
+		hmac_drbg::int_to_octets(_private_key, q) + hmac_drbg::get_entropy(DRBG_SEED_SIZE));
+	_nonce_pool = std::make_unique<precomputation_pool<nonce>>(capacity, refill_watermark, 
+		[drbg, generator_table = _generator_table, q]() mutable
+	{
+		while (true)
 		{
-			continue;
+			big_integer k = drbg.generate_below(q);
+			big_integer r = generator_table->multiply(k).x % q;
+			if (r != 0)
+			{
+				return nonce{ std::move(k), std::move(r) };
+			}
 		}
+	});
+}
+
+void elliptical_signer::stop_precomputation()
+{
+	_nonce_pool.reset();
+}
 
-		break;
+uint64_t elliptical_signer::get_precomputed_count() const
+{
+	return _nonce_pool ? _nonce_pool->size() : 0;
+}
+
+elliptical_point elliptical_signer::_decode_public_key(const std::string& public_key) const
+{
+	const uint64_t part_size = big_unsigned_bytes_count(_curve->get_p());
+	if (public_key.size() != 2 * part_size)
+	{
+		throw invalid_key();
 	}
 
-	_signatures.insert({ generated_hash, {r, s} });
+	const big_unsigned x = bytes_to_big_unsigned(public_key.substr(0, part_size));
+	const big_unsigned y = bytes_to_big_unsigned(public_key.substr(part_size));
+	if (x >= _curve->get_p() || y >= _curve->get_p() || !_curve->contains(x, y))
+	{
+		throw invalid_key();
+	}
 
-	return _signer_utils::key_to_string(r, s);
+	return elliptical_point(x, y, *_curve);
 }
 
-std::string elliptical_signer::get_public_key() const
+const char* elliptical_signer::invalid_key::what() const throw ()
 {
-	return _public_key.to_string();
+	return "Public key has invalid size or is not a point of the curve!";
 }
 
-const char* elliptical_signer::invalid_key::what() const throw ()
+const char* elliptical_signer::invalid_private_key::what() const throw ()
+{
+	return "Private key has invalid size or is not in [1, q - 1]!";
+}
+
+const char* elliptical_signer::invalid_batch::what() const throw ()
 {
-	return "No key for this message exists in current storage!";
+	return "Every message of a batch needs exactly one signature!";
 }
@@ -2,11 +2,22 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
+#include <memory>
 
 #include "big_integer.hpp"
+#include "thread_pool.hpp"
 #include "elliptical_point.hpp"
+#include "elliptical_curve.hpp"
+#include "precomputation_pool.hpp"
 
+/*
+  GOST R 34.10 style signer. Signing needs only the private key; verification is a const function of
+  the message, the signature and a public key, so any instance on the same curve, on any thread, can
+  verify what another one signed. Signatures are r || s and public keys x || y, every part big-endian
+  and fixed-size (the byte length of q and of p respectively). Signing is dominated by kG, which does
+  not depend on the message; start_precomputation() moves it off the signing path. Without a
+  precomputed nonce k is derived from the private key and the message hash as in RFC 6979
+*/
 class elliptical_signer
 {
 public:
@@ -15,17 +26,69 @@ public:
 		const char* what() const throw ();
 	};
 
-	elliptical_signer();
+	struct invalid_private_key : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct invalid_batch : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// curve_name is one of elliptical_curve::get_names(), generator_window_bits picks the size/speed
+	// tradeoff of the precomputed generator table, shared between signers on the same curve
+	elliptical_signer(
+		const std::string& curve_name = P192_CURVE, 
+		uint32_t generator_window_bits = DEFAULT_TABLE_WINDOW_BITS);
+	// an existing key pair: private_key is d in [1, q - 1], big-endian in the byte length of q.
+	// Throws invalid_private_key
+	elliptical_signer(
+		const std::string& curve_name, 
+		const std::string& private_key, 
+		uint32_t generator_window_bits = DEFAULT_TABLE_WINDOW_BITS);
 	~elliptical_signer() = default;
 
-	std::string sign_message(const std::string& message);
-	bool verify_message(const std::string& message) const;
+	std::string sign_message(const std::string& message) const;
+	// false for any malformed signature, throws invalid_key for a malformed public key
+	bool verify_message(const std::string& message, const std::string& signature, const std::string& public_key) const;
+	// verifies signatures[i] of messages[i] on the pool, hashing included, results keep the order of messages.
+	// Randomized linear-combination batching does not apply: r keeps only x(kG) mod q, so the
+	// points a combined check would sum cannot be recovered from the signatures
+	std::vector<bool> verify_batch(
+		const std::vector<std::string>& messages, 
+		const std::vector<std::string>& signatures, 
+		const std::string& public_key, 
+		thread_pool& pool) const;
 
 	std::string get_public_key() const;
+	uint64_t get_signature_size() const;
+
+	// (k, r) pairs of nonces drawn from an HMAC_DRBG seeded with the private key and fresh entropy,
+	// generated on a background thread; sign_message takes one when there is any, which leaves it the
+	// hashing and s = r d + k e mod q. Restarts a running pool; neither call may overlap signing
+	void start_precomputation(
+		uint64_t capacity = DEFAULT_PRECOMPUTATION_CAPACITY, 
+		uint64_t refill_watermark = DEFAULT_PRECOMPUTATION_CAPACITY / 2);
+	void stop_precomputation();
+	uint64_t get_precomputed_count() const;
 
 private:
+	struct nonce
+	{
+		big_integer k;
+		big_integer r;
+	};
+
+	elliptical_point _decode_public_key(const std::string& public_key) const;
+	// verify_message with the public key already decoded
+	bool _verify_message(const std::string& message, const std::string& signature, const elliptical_point& key_point) const;
+
+	const elliptical_curve* _curve;
+	std::shared_ptr<const fixed_base_table> _generator_table;
+
 	big_unsigned _private_key;
 	elliptical_point _public_key;
 
-    std::unordered_map<std::string, std::tuple<big_integer, big_integer>> _signatures;
+	std::unique_ptr<precomputation_pool<nonce>> _nonce_pool;
 };
@@ -0,0 +1,99 @@
+#include "fixed_base_table.hpp"
+#include "elliptical_curve.hpp"
+
+fixed_base_table::fixed_base_table(const elliptical_point& base, uint64_t scalar_bits, uint32_t window_bits)
+	: _base(base)
+	, _window_bits(_check_window_bits(window_bits))
+	, _windows_count((scalar_bits + window_bits - 1) / window_bits)
+{
+	const uint64_t digits_count = (uint64_t(1) << _window_bits) - 1;
+	_table.reserve(_windows_count * digits_count);
+
+	const jacobian_arithmetic& arithmetic = base.curve->get_arithmetic();
+
+	jacobian_point window_base = base.curve->to_jacobian(base);
+	for (uint64_t j = 0; j < _windows_count; ++j)
+	{
+		jacobian_point multiple = window_base;
+		for (uint64_t d = 1; d <= digits_count; ++d)
+		{
+			_table.push_back(multiple);
+			multiple = arithmetic.add(multiple, window_base);
+		}
+
+		// multiple is 2^w * window_base now, the base of the next window
+		window_base = std::move(multiple);
+	}
+
+	arithmetic.normalize(_table);
+}
+
+elliptical_point fixed_base_table::multiply(const big_integer& x) const
+{
+	const big_unsigned& scalar = x.getMagnitude();
+	if (scalar.bitLength() > _windows_count * _window_bits)
+	{
+		return elliptical_point::multiply(x, _base);
+	}
+
+	jacobian_point result = _multiply(scalar);
+	if (x.getSign() == big_integer::negative)
+	{
+		result = _base.curve->get_arithmetic().negate(result);
+	}
+
+	return _base.curve->from_jacobian(result);
+}
+
+uint32_t fixed_base_table::get_window_bits() const
+{
+	return _window_bits;
+}
+
+uint64_t fixed_base_table::get_points_count() const
+{
+	return _table.size();
+}
+
+uint32_t fixed_base_table::_check_window_bits(uint32_t window_bits)
+{
+	if (window_bits == 0 || window_bits > MAX_TABLE_WINDOW_BITS)
+	{
+		throw invalid_window();
+	}
+
+	return window_bits;
+}
+
+jacobian_point fixed_base_table::_multiply(const big_unsigned& scalar) const
+{
+	const jacobian_arithmetic& arithmetic = _base.curve->get_arithmetic();
+	const uint64_t digits_count = (uint64_t(1) << _window_bits) - 1;
+	const big_unsigned::Index bits_count = scalar.bitLength();
+
+	jacobian_point result;
+	for (uint64_t j = 0; j < _windows_count; ++j)
+	{
+		uint64_t digit = 0;
+		for (uint32_t i = 0; i < _window_bits; ++i)
+		{
+			const big_unsigned::Index bit = j * _window_bits + i;
+			if (bit < bits_count && scalar.getBit(bit))
+			{
+				digit |= uint64_t(1) << i;
+			}
+		}
+
+		if (digit != 0)
+		{
+			result = arithmetic.add(result, _table[j * digits_count + digit - 1]);
+		}
+	}
+
+	return result;
+}
+
+const char* fixed_base_table::invalid_window::what() const throw ()
+{
+	return "Window width of a fixed-base table must be in [1, MAX_TABLE_WINDOW_BITS]!";
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "big_integer.hpp"
+#include "elliptical_point.hpp"
+#include "jacobian_point.hpp"
+#include <vector>
+
+constexpr uint32_t DEFAULT_TABLE_WINDOW_BITS = 4;
+constexpr uint32_t MAX_TABLE_WINDOW_BITS = 12;
+
+/*
+  Fixed-base windowed table: for every window j of the scalar it keeps d * 2^(wj) * base for all
+  digits d in [1, 2^w), normalized to z == 1. A multiplication then takes one mixed addition per
+  nonzero window and no doublings at all. Wider windows trade (2^w - 1) * bits / w points of memory
+  for bits / w additions
+*/
+class fixed_base_table
+{
+public:
+	struct invalid_window : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	fixed_base_table(const elliptical_point& base, uint64_t scalar_bits, uint32_t window_bits = DEFAULT_TABLE_WINDOW_BITS);
+	~fixed_base_table() = default;
+
+	// scalars wider than scalar_bits fall back to the generic elliptical_point::multiply
+	elliptical_point multiply(const big_integer& x) const;
+
+	uint32_t get_window_bits() const;
+	uint64_t get_points_count() const;
+
+private:
+	// validated before the windows count divides by it
+	static uint32_t _check_window_bits(uint32_t window_bits);
+
+	jacobian_point _multiply(const big_unsigned& scalar) const;
+
+	elliptical_point _base;
+	uint32_t _window_bits;
+	uint64_t _windows_count;
+
+	// _table[j * (2^w - 1) + d - 1] == d * 2^(wj) * base
+	std::vector<jacobian_point> _table;
+};
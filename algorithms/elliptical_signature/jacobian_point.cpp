@@ -0,0 +1,251 @@
+#include "jacobian_point.hpp"
+
+jacobian_point::jacobian_point()
+	: x(1)
+	, y(1)
+	, z(0)
+{}
+
+jacobian_point::jacobian_point(const big_unsigned& _x, const big_unsigned& _y, const big_unsigned& _z)
+	: x(_x)
+	, y(_y)
+	, z(_z)
+{}
+
+bool jacobian_point::is_infinity() const
+{
+	return z.isZero();
+}
+
+jacobian_arithmetic::jacobian_arithmetic(const big_integer& a, const big_unsigned& p)
+	: _context(p)
+{
+	big_integer reduced_a = a % big_integer(p);
+	if (reduced_a < 0)
+	{
+		reduced_a += p;
+	}
+
+	_a_is_minus_3 = reduced_a.getMagnitude() + 3 == p;
+	_a = _context.to_montgomery(reduced_a.getMagnitude());
+}
+
+jacobian_point jacobian_arithmetic::from_affine(const big_integer& x, const big_integer& y) const
+{
+	const big_integer module = get_module();
+
+	big_integer reduced_x = x % module;
+	big_integer reduced_y = y % module;
+	if (reduced_x < 0)
+	{
+		reduced_x += module;
+	}
+	if (reduced_y < 0)
+	{
+		reduced_y += module;
+	}
+
+	return jacobian_point(
+		_context.to_montgomery(reduced_x.getMagnitude()), 
+		_context.to_montgomery(reduced_y.getMagnitude()), 
+		get_one());
+}
+
+std::tuple<big_integer, big_integer> jacobian_arithmetic::to_affine(const jacobian_point& point) const
+{
+	// the point at infinity has no affine form, (0, 0) is used for it as it is never on a curve with b != 0
+	if (point.is_infinity())
+	{
+		return { 0, 0 };
+	}
+
+	big_unsigned z_inv = _context.inverse(point.z);
+	big_unsigned z_inv_2 = _mul(z_inv, z_inv);
+	big_unsigned z_inv_3 = _mul(z_inv_2, z_inv);
+
+	return { _context.from_montgomery(_mul(point.x, z_inv_2)), _context.from_montgomery(_mul(point.y, z_inv_3)) };
+}
+
+jacobian_point jacobian_arithmetic::double_point(const jacobian_point& point) const
+{
+	if (point.is_infinity() || point.y.isZero())
+	{
+		return jacobian_point();
+	}
+
+	big_unsigned y_2 = _mul(point.y, point.y);
+	big_unsigned s = _mul(_add(_add(point.x, point.x), _add(point.x, point.x)), y_2);
+	big_unsigned z_2 = _mul(point.z, point.z);
+
+	big_unsigned m;
+	if (_a_is_minus_3)
+	{
+		big_unsigned t = _mul(_sub(point.x, z_2), _add(point.x, z_2));
+		m = _add(_add(t, t), t);
+	}
+	else
+	{
+		big_unsigned x_2 = _mul(point.x, point.x);
+		m = _add(_add(_add(x_2, x_2), x_2), _mul(_a, _mul(z_2, z_2)));
+	}
+
+	jacobian_point result;
+	result.x = _sub(_mul(m, m), _add(s, s));
+
+	big_unsigned y_4_8 = _mul(y_2, y_2);
+	y_4_8 = _add(y_4_8, y_4_8);
+	y_4_8 = _add(y_4_8, y_4_8);
+	y_4_8 = _add(y_4_8, y_4_8);
+	result.y = _sub(_mul(m, _sub(s, result.x)), y_4_8);
+
+	big_unsigned yz = _mul(point.y, point.z);
+	result.z = _add(yz, yz);
+
+	return result;
+}
+
+jacobian_point jacobian_arithmetic::add(const jacobian_point& first, const jacobian_point& second) const
+{
+	if (first.is_infinity())
+	{
+		return second;
+	}
+	if (second.is_infinity())
+	{
+		return first;
+	}
+
+	// precomputed table points usually have z == 1, which saves four multiplications
+	const bool first_is_affine = first.z == get_one();
+	const bool second_is_affine = second.z == get_one();
+
+	big_unsigned z1_2 = first_is_affine ? get_one() : _mul(first.z, first.z);
+	big_unsigned z2_2 = second_is_affine ? get_one() : _mul(second.z, second.z);
+
+	big_unsigned u1 = second_is_affine ? first.x : _mul(first.x, z2_2);
+	big_unsigned u2 = first_is_affine ? second.x : _mul(second.x, z1_2);
+	big_unsigned s1 = second_is_affine ? first.y : _mul(first.y, _mul(second.z, z2_2));
+	big_unsigned s2 = first_is_affine ? second.y : _mul(second.y, _mul(first.z, z1_2));
+
+	big_unsigned h = _sub(u2, u1);
+	big_unsigned r = _sub(s2, s1);
+
+	if (h.isZero())
+	{
+		if (r.isZero())
+		{
+			return double_point(first);
+		}
+
+		return jacobian_point();
+	}
+
+	big_unsigned h_2 = _mul(h, h);
+	big_unsigned h_3 = _mul(h_2, h);
+	big_unsigned v = _mul(u1, h_2);
+
+	jacobian_point result;
+	result.x = _sub(_sub(_mul(r, r), h_3), _add(v, v));
+	result.y = _sub(_mul(r, _sub(v, result.x)), _mul(s1, h_3));
+
+	if (first_is_affine && second_is_affine)
+	{
+		result.z = std::move(h);
+	}
+	else if (first_is_affine)
+	{
+		result.z = _mul(second.z, h);
+	}
+	else if (second_is_affine)
+	{
+		result.z = _mul(first.z, h);
+	}
+	else
+	{
+		result.z = _mul(_mul(first.z, second.z), h);
+	}
+
+	return result;
+}
+
+jacobian_point jacobian_arithmetic::negate(const jacobian_point& point) const
+{
+	if (point.is_infinity() || point.y.isZero())
+	{
+		return point;
+	}
+
+	return jacobian_point(point.x, get_module() - point.y, point.z);
+}
+
+void jacobian_arithmetic::normalize(std::vector<jacobian_point>& points) const
+{
+	// prefix products of all z, inverted once and then unwound from the back
+	std::vector<big_unsigned> prefix_products;
+	prefix_products.reserve(points.size());
+
+	big_unsigned product = get_one();
+	for (const auto& point : points)
+	{
+		if (!point.is_infinity())
+		{
+			product = _mul(product, point.z);
+		}
+		prefix_products.push_back(product);
+	}
+
+	big_unsigned product_inv = _context.inverse(product);
+
+	for (size_t i = points.size(); i > 0; --i)
+	{
+		jacobian_point& point = points[i - 1];
+		if (point.is_infinity())
+		{
+			continue;
+		}
+
+		big_unsigned z_inv = i > 1 ? _mul(product_inv, prefix_products[i - 2]) : product_inv;
+		product_inv = _mul(product_inv, point.z);
+
+		big_unsigned z_inv_2 = _mul(z_inv, z_inv);
+		point.x = _mul(point.x, z_inv_2);
+		point.y = _mul(point.y, _mul(z_inv_2, z_inv));
+		point.z = get_one();
+	}
+}
+
+const big_unsigned& jacobian_arithmetic::get_module() const
+{
+	return _context.get_module();
+}
+
+const big_unsigned& jacobian_arithmetic::get_one() const
+{
+	return _context.get_one();
+}
+
+big_unsigned jacobian_arithmetic::_add(const big_unsigned& first, const big_unsigned& second) const
+{
+	big_unsigned result = first + second;
+	if (result >= get_module())
+	{
+		result -= get_module();
+	}
+
+	return result;
+}
+
+big_unsigned jacobian_arithmetic::_sub(const big_unsigned& first, const big_unsigned& second) const
+{
+	if (first >= second)
+	{
+		return first - second;
+	}
+
+	return first + get_module() - second;
+}
+
+big_unsigned jacobian_arithmetic::_mul(const big_unsigned& first, const big_unsigned& second) const
+{
+	return _context.multiply(first, second);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "big_integer.hpp"
+#include "montgomery_context.hpp"
+#include <tuple>
+#include <vector>
+
+/*
+  Point in Jacobian projective coordinates: (x : y : z) stands for the affine point (x / z^2, y / z^3),
+  z == 0 is the point at infinity. All coordinates are kept reduced modulo p and in montgomery form.
+*/
+struct jacobian_point
+{
+	jacobian_point();
+	jacobian_point(const big_unsigned& x, const big_unsigned& y, const big_unsigned& z);
+
+	bool is_infinity() const;
+
+	big_unsigned x;
+	big_unsigned y;
+	big_unsigned z;
+};
+
+/*
+  Group law of y^2 = x^3 + ax + b over GF(p) in Jacobian coordinates. Neither addition nor doubling
+  needs a modular inversion, only to_affine does, so a scalar multiplication pays for one inversion in total.
+  Field multiplications go through the montgomery context of p
+*/
+class jacobian_arithmetic
+{
+public:
+	jacobian_arithmetic(const big_integer& a, const big_unsigned& p);
+	~jacobian_arithmetic() = default;
+
+	jacobian_point from_affine(const big_integer& x, const big_integer& y) const;
+	std::tuple<big_integer, big_integer> to_affine(const jacobian_point& point) const;
+
+	jacobian_point double_point(const jacobian_point& point) const;
+	jacobian_point add(const jacobian_point& first, const jacobian_point& second) const;
+	jacobian_point negate(const jacobian_point& point) const;
+
+	// brings every point to z == 1 sharing a single modular inversion (Montgomery's trick)
+	void normalize(std::vector<jacobian_point>& points) const;
+
+	const big_unsigned& get_module() const;
+	// montgomery form of 1, z of every normalized point
+	const big_unsigned& get_one() const;
+
+private:
+	big_unsigned _add(const big_unsigned& first, const big_unsigned& second) const;
+	big_unsigned _sub(const big_unsigned& first, const big_unsigned& second) const;
+	big_unsigned _mul(const big_unsigned& first, const big_unsigned& second) const;
+
+	montgomery_context _context;
+	big_unsigned _a;
+
+	// a == -3 lets doubling compute 3x^2 + az^4 as 3(x - z^2)(x + z^2)
+	bool _a_is_minus_3 = false;
+};
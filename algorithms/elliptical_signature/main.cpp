@@ -1,9 +1,51 @@
 #include <iostream>
 #include <string>
 #include <cassert>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <chrono>
+#include <vector>
+#include <thread>
 
 #include "elliptical_signer.hpp"
+#include "elliptical_point.hpp"
+#include "elliptical_curve.hpp"
+#include "fixed_base_table.hpp"
+#include "montgomery_context.hpp"
+#include "prime_utils.hpp"
 #include "testing.hpp"
+#include "bit_utils.hpp"
+#include "benchmark.hpp"
+#include "thread_pool.hpp"
+#include "gost_hash.hpp"
+
+const std::string DEFAULT_HASH_KEY_FOR_TESTS = "12345678900987654321qwertyuiopas";
+
+// every bigint limb array goes through the global operator new, so counting calls here
+// counts the copies and allocations made by the point arithmetic
+static uint64_t allocations_count = 0;
+
+void* operator new(size_t size)
+{
+	++allocations_count;
+	if (void* memory = std::malloc(size))
+	{
+		return memory;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
 
 TEST_CASE_BEGIN(signer_base_sign_verify)
 {
@@ -13,17 +55,634 @@ TEST_CASE_BEGIN(signer_base_sign_verify)
 	std::cout << "initial message to sign " << message << std::endl;
 
 	std::string signature = signer.sign_message(message);
-	std::cout << "signature " << signature << std::endl;
+	std::cout << "signature " << bit_utils::to_hex(signature) << std::endl;
+	assert(signature.size() == signer.get_signature_size());
 
 	const std::string& public_key = signer.get_public_key();
-	std::cout << "public key " << public_key << std::endl;
+	std::cout << "public key " << bit_utils::to_hex(public_key) << std::endl;
+
+	// verification is stateless: another signer on the same curve accepts the signature
+	elliptical_signer verifier;
 
 	[[maybe_unused]]
-	bool verified = signer.verify_message(message);
+	bool verified = verifier.verify_message(message, signature, public_key);
 
 	std::cout << "is signature verified? " << verified << std::endl;
 
 	assert(verified);
+	assert(!verifier.verify_message(message + ".", signature, public_key));
+	assert(!verifier.verify_message(message, signature.substr(1), public_key));
+	assert(!verifier.verify_message(message, std::string(signature.size(), '\0'), public_key));
+	assert(!verifier.verify_message(message, signature, verifier.get_public_key()));
+
+	std::string tampered = signature;
+	tampered.back() ^= 1;
+	assert(!verifier.verify_message(message, tampered, public_key));
+
+	std::string bad_key = public_key;
+	bad_key.back() ^= 1;
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		verifier.verify_message(message, signature, bad_key);
+	}
+	catch (const elliptical_signer::invalid_key&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_fallback_nonce_test)
+{
+	constexpr uint64_t signatures_count = 32;
+
+	for (const std::string& name : elliptical_curve::get_names())
+	{
+		const elliptical_curve& curve = elliptical_curve::get(name);
+		const big_unsigned& q = curve.get_q();
+		const uint64_t q_bytes = big_unsigned_bytes_count(q);
+
+		// a known d, so every k can be taken back out of s = r d + k e mod q
+		const big_unsigned d = bytes_to_big_unsigned(std::string(q_bytes, '\x5a')) % (q - 1) + 1;
+		elliptical_signer signer(name, big_unsigned_to_bytes(d, q_bytes));
+		assert(signer.verify_message("message", signer.sign_message("message"), signer.get_public_key()));
+
+		std::vector<big_unsigned> nonces;
+		uint64_t upper_half_count = 0, even_count = 0;
+		for (uint64_t i = 0; i < signatures_count; ++i)
+		{
+			const std::string message = "message " + std::to_string(i);
+			const std::string signature = signer.sign_message(message);
+			const big_unsigned r = bytes_to_big_unsigned(signature.substr(0, q_bytes));
+			const big_unsigned s = bytes_to_big_unsigned(signature.substr(q_bytes));
+
+			big_unsigned e = bytes_to_big_unsigned(gost_hash(DEFAULT_HASH_KEY_FOR_TESTS).generate_hash(message)) % q;
+			if (e.isZero())
+			{
+				e = 1;
+			}
+			const big_unsigned k = (s + q - r * d % q) % q * modinv(e, q) % q;
+			assert(curve.get_generator_table()->multiply(k).x % q == r);
+
+			// a nonce sized by the decimal digits of q, as before, would be a fraction of these bits
+			assert(k.bitLength() + 32 > q.bitLength());
+			upper_half_count += k > q / 2 ? 1 : 0;
+			even_count += k.getBlock(0) % 2 == 0 ? 1 : 0;
+			assert(std::find(nonces.begin(), nonces.end(), k) == nonces.end());
+			nonces.push_back(k);
+
+			// RFC 6979: the same key and message give the same k
+			assert(signer.sign_message(message) == signature);
+		}
+		assert(upper_half_count > 0 && upper_half_count < signatures_count);
+		assert(even_count > 0 && even_count < signatures_count);
+
+		for (const big_unsigned& invalid : { big_unsigned(0), q })
+		{
+			[[maybe_unused]]
+			bool thrown = false;
+			try
+			{
+				elliptical_signer(name, big_unsigned_to_bytes(invalid, q_bytes));
+			}
+			catch (const elliptical_signer::invalid_private_key&)
+			{
+				thrown = true;
+			}
+			assert(thrown);
+		}
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(point_multiply_allocations_benchmark)
+{
+	const elliptical_curve& curve = elliptical_curve::get(P192_CURVE);
+	const elliptical_point& g = curve.get_generator();
+	const big_integer k = stringToBigInteger("5218393591745392806924813802743197104362412376539834569321");
+	constexpr uint64_t iterations_count = 20;
+
+	uint64_t allocations_before = allocations_count;
+	elliptical_point result = elliptical_point::multiply(k, g);
+	uint64_t allocations_per_multiply = allocations_count - allocations_before;
+
+	std::cout << "k * G = " << result.to_string() << std::endl;
+	std::cerr << "allocations per 192-bit scalar multiplication: " << allocations_per_multiply << std::endl;
+
+	assert(bigIntegerToString(result.x) == "642991980590434439166713714014691795333036497793643272356");
+
+	benchmark::measure("elliptical_point::multiply", iterations_count, [&]()
+	{
+		result = elliptical_point::multiply(k, g);
+	});
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(point_multiply_jacobian_benchmark)
+{
+	const elliptical_curve& curve = elliptical_curve::get(P192_CURVE);
+	const elliptical_point& g = curve.get_generator();
+	const big_integer k = stringToBigInteger("5218393591745392806924813802743197104362412376539834569321");
+	constexpr uint64_t iterations_count = 20;
+
+	for (const char* scalar : { "1", "2", "3", "255", "65537", "5218393591745392806924813802743197104362412376539834569321" })
+	{
+		big_integer x = stringToBigInteger(scalar);
+		elliptical_point jacobian_result = elliptical_point::multiply(x, g);
+		elliptical_point affine_result = elliptical_point::multiply_affine(x, g);
+
+		assert(jacobian_result.x == affine_result.x && jacobian_result.y == affine_result.y);
+	}
+
+	double affine_seconds = benchmark::measure("elliptical_point::multiply_affine", iterations_count, [&]()
+	{
+		elliptical_point::multiply_affine(k, g);
+	});
+
+	double jacobian_seconds = benchmark::measure("elliptical_point::multiply (jacobian)", iterations_count, [&]()
+	{
+		elliptical_point::multiply(k, g);
+	});
+
+	std::cerr << "jacobian speedup: " << affine_seconds / jacobian_seconds << "x" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(fixed_base_table_multiply_benchmark)
+{
+	const elliptical_curve& curve = elliptical_curve::get(P192_CURVE);
+	const big_unsigned& q = curve.get_q();
+	const elliptical_point& g = curve.get_generator();
+	const big_integer k = stringToBigInteger("5218393591745392806924813802743197104362412376539834569321");
+	constexpr uint64_t iterations_count = 50;
+
+	const char* scalars[] = {
+		"0", "1", "2", "15", "16", "255", "65537", "-65537",
+		"5218393591745392806924813802743197104362412376539834569321",
+		"6277101735386680763835789423176059013767194773182842284080",
+		// wider than the table, falls back to the generic multiplication
+		"62771017353866807638357894231760590137671947731828422840810" };
+
+	double generic_seconds = benchmark::measure("elliptical_point::multiply (G)", iterations_count, [&]()
+	{
+		elliptical_point::multiply(k, g);
+	});
+
+	for (uint32_t window_bits : { 1, 4, 6, 8 })
+	{
+		const auto build_start = std::chrono::steady_clock::now();
+		fixed_base_table table(g, q.bitLength(), window_bits);
+		const std::chrono::duration<double> build_elapsed = std::chrono::steady_clock::now() - build_start;
+
+		for (const char* scalar : scalars)
+		{
+			big_integer x = stringToBigInteger(scalar);
+			elliptical_point table_result = table.multiply(x);
+			elliptical_point generic_result = elliptical_point::multiply(x, g);
+
+			assert(table_result.x == generic_result.x && table_result.y == generic_result.y);
+		}
+
+		std::cerr << "fixed-base table w=" << window_bits << ": " << table.get_points_count() << " points, built in "
+			<< build_elapsed.count() * 1000.0 << " ms" << std::endl;
+
+		double table_seconds = benchmark::measure("fixed_base_table::multiply w=" + std::to_string(window_bits), iterations_count, [&]()
+		{
+			table.multiply(k);
+		});
+
+		std::cerr << "fixed-base speedup: " << generic_seconds / table_seconds << "x" << std::endl;
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		fixed_base_table table(g, q.bitLength(), 0);
+	}
+	catch (const fixed_base_table::invalid_window&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_throughput_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t iterations_count = 20;
+
+	for (uint32_t window_bits : { 1, 4, 8 })
+	{
+		elliptical_signer signer(P192_CURVE, window_bits);
+
+		std::string signature;
+		benchmark::measure("elliptical_signer::sign_message w=" + std::to_string(window_bits), iterations_count, [&]()
+		{
+			signature = signer.sign_message(message);
+		});
+
+		[[maybe_unused]]
+		bool verified = signer.verify_message(message, signature, signer.get_public_key());
+		assert(verified);
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_precomputation_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t capacity = 64;
+	constexpr uint64_t iterations_count = 64;
+
+	for (const std::string& curve_name : { P192_CURVE, GOST_512_CURVE })
+	{
+		elliptical_signer signer(curve_name);
+		const std::string public_key = signer.get_public_key();
+
+		const std::vector<double> online_samples = benchmark::sample(iterations_count, [&]()
+		{
+			signer.sign_message(message);
+		});
+
+		signer.start_precomputation(capacity, capacity / 2);
+		while (signer.get_precomputed_count() < capacity)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		std::vector<std::string> signatures;
+		const std::vector<double> pool_samples = benchmark::sample(iterations_count, [&]()
+		{
+			signatures.push_back(signer.sign_message(message));
+		});
+
+		for (const std::string& signature : signatures)
+		{
+			[[maybe_unused]]
+			bool verified = signer.verify_message(message, signature, public_key);
+			assert(verified);
+		}
+		assert(signatures.front() != signatures.back());
+
+		// drained past the pool, signing computes kG itself again
+		for (uint64_t i = 0; i < capacity; ++i)
+		{
+			assert(signer.verify_message(message, signer.sign_message(message), public_key));
+		}
+
+		signer.stop_precomputation();
+		assert(signer.get_precomputed_count() == 0);
+
+		for (const auto& [name, samples] : { std::make_pair("without", online_samples), 
+			std::make_pair("with", pool_samples) })
+		{
+			std::cerr << "elliptical_signer::sign_message on " << curve_name << " " << name << " precomputed nonces: p50 " << 
+				benchmark::percentile(samples, 50) * 1000.0 << " ms, p99 " << 
+				benchmark::percentile(samples, 99) * 1000.0 << " ms" << std::endl;
+		}
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(point_multiply_joint_benchmark)
+{
+	const elliptical_curve& curve = elliptical_curve::get(P192_CURVE);
+	const big_unsigned& p = curve.get_p();
+	const elliptical_point& g = curve.get_generator();
+	const big_integer k1 = stringToBigInteger("5218393591745392806924813802743197104362412376539834569321");
+	const big_integer k2 = stringToBigInteger("3791460381028579239473058132041038460193746102937461923401");
+	const elliptical_point q = elliptical_point::multiply(k2, g);
+	constexpr uint64_t iterations_count = 20;
+
+	for (const auto& [x1, x2] : { std::make_tuple("0", "1"), std::make_tuple("1", "0"), std::make_tuple("1", "1"),
+		std::make_tuple("7", "-7"), std::make_tuple("-65537", "255"),
+		std::make_tuple("5218393591745392806924813802743197104362412376539834569321", "12") })
+	{
+		big_integer s1 = stringToBigInteger(x1);
+		big_integer s2 = stringToBigInteger(x2);
+		elliptical_point joint_result = elliptical_point::multiply_joint(s1, g, s2, q);
+		elliptical_point separate_result = elliptical_point::multiply(s1 + s2 * k2, g);
+
+		assert(joint_result.x == separate_result.x && joint_result.y == separate_result.y);
+	}
+
+	double separate_seconds = benchmark::measure("multiply + multiply", iterations_count, [&]()
+	{
+		elliptical_point::multiply(k1, g) + elliptical_point::multiply(k2, q);
+	});
+
+	fixed_base_table table(g, p.bitLength());
+	double table_seconds = benchmark::measure("fixed_base_table::multiply + multiply", iterations_count, [&]()
+	{
+		table.multiply(k1) + elliptical_point::multiply(k2, q);
+	});
+
+	double joint_seconds = benchmark::measure("elliptical_point::multiply_joint", iterations_count, [&]()
+	{
+		elliptical_point::multiply_joint(k1, g, k2, q);
+	});
+
+	std::cerr << "joint speedup: " << separate_seconds / joint_seconds << "x, over fixed-base table: "
+		<< table_seconds / joint_seconds << "x" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_verify_benchmark)
+{
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+	constexpr uint64_t iterations_count = 50;
+
+	elliptical_signer signer;
+	const std::string signature = signer.sign_message(message);
+	const std::string public_key = signer.get_public_key();
+
+	benchmark::measure("elliptical_signer::verify_message", iterations_count, [&]()
+	{
+		[[maybe_unused]]
+		bool verified = signer.verify_message(message, signature, public_key);
+		assert(verified);
+	});
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(wnaf_recode_test)
+{
+	for (const char* scalar : { "0", "1", "2", "7", "255", "65537", "18446744073709551615", "18446744073709551616",
+		"5218393591745392806924813802743197104362412376539834569321" })
+	{
+		const big_unsigned x = stringToBigUnsigned(scalar);
+		for (uint32_t window_bits = 2; window_bits <= MAX_WNAF_WINDOW_BITS; ++window_bits)
+		{
+			std::vector<int32_t> digits = elliptical_point::wnaf_recode(x, window_bits);
+
+			big_integer value = 0;
+			uint64_t zeros_since_digit = window_bits;
+			for (size_t i = digits.size(); i > 0; --i)
+			{
+				value *= 2;
+				value += digits[i - 1];
+
+				if (digits[i - 1] != 0)
+				{
+					assert(digits[i - 1] % 2 != 0);
+					assert(std::abs(digits[i - 1]) < (1 << (window_bits - 1)));
+					assert(zeros_since_digit >= window_bits - 1);
+					zeros_since_digit = 0;
+				}
+				else
+				{
+					++zeros_since_digit;
+				}
+			}
+
+			assert(value == big_integer(x));
+		}
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		elliptical_point::wnaf_recode(1, 1);
+	}
+	catch (const elliptical_point::invalid_window&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(point_multiply_wnaf_benchmark)
+{
+	const elliptical_curve& curve = elliptical_curve::get(P192_CURVE);
+	const big_unsigned& p = curve.get_p();
+	const elliptical_point& g = curve.get_generator();
+	const big_integer k = stringToBigInteger("5218393591745392806924813802743197104362412376539834569321");
+	constexpr uint64_t iterations_count = 20;
+
+	for (uint32_t window_bits = 2; window_bits <= 7; ++window_bits)
+	{
+		for (const char* scalar : { "1", "2", "3", "-3", "31", "255", "65537", "5218393591745392806924813802743197104362412376539834569321" })
+		{
+			big_integer x = stringToBigInteger(scalar);
+			elliptical_point wnaf_result = elliptical_point::multiply(x, g, window_bits);
+			elliptical_point affine_result = elliptical_point::multiply_affine(x < 0 ? -x : x, g);
+			if (x < 0)
+			{
+				affine_result.y = big_integer(p) - affine_result.y;
+			}
+
+			assert(wnaf_result.x == affine_result.x && wnaf_result.y == affine_result.y);
+		}
+
+		benchmark::measure("elliptical_point::multiply w=" + std::to_string(window_bits), iterations_count, [&]()
+		{
+			elliptical_point::multiply(k, g, window_bits);
+		});
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(montgomery_context_test)
+{
+	const big_unsigned module = stringToBigUnsigned("3623986102229003635907788753683874306021320925534678605086546150450856166624002482588482022271496854025090823603058735163734263822371964987228582907372403");
+	const big_unsigned first = stringToBigUnsigned("1518655069210828534508950034714043154928747527740206436194018823352809982443793732829756914785974674866041605397883677596626326413990136959047435811826396");
+	const big_unsigned second = stringToBigUnsigned("57896044618658097711785492504343953927082934583725450622380973592137631069619");
+
+	for (const big_unsigned& m : { module, big_unsigned(3), big_unsigned(18446744073709551557ul),
+		stringToBigUnsigned("6277101735386680763835789423207666416083908700390324961279") })
+	{
+		montgomery_context context(m);
+		for (const big_unsigned& x : { big_unsigned(0), big_unsigned(1), first, second })
+		{
+			for (const big_unsigned& y : { big_unsigned(1), big_unsigned(2), first, second })
+			{
+				big_unsigned product = context.multiply(context.to_montgomery(x), context.to_montgomery(y));
+				assert(context.from_montgomery(product) == (x * y) % m);
+			}
+
+			assert(context.exp(x, second) == modexp(x, second, m));
+
+			if (!(x % m).isZero())
+			{
+				big_unsigned x_inv = context.inverse(context.to_montgomery(x));
+				assert(context.from_montgomery(x_inv) == modinv(x, m));
+			}
+		}
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		montgomery_context context(256);
+	}
+	catch (const montgomery_context::even_module&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(big_unsigned_bytes_test)
+{
+	const unsigned char bytes[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b };
+
+	const big_unsigned big_endian(bytes, sizeof(bytes), big_unsigned::bigEndian);
+	const big_unsigned little_endian(bytes, sizeof(bytes), big_unsigned::littleEndian);
+	assert(big_endian == stringToBigUnsigned("1218426182456967898401291"));
+	assert(little_endian == stringToBigUnsigned("3416467015609337987117220096"));
+	assert(big_unsigned(bytes, 0, big_unsigned::bigEndian).isZero());
+
+	unsigned char exported[sizeof(bytes) + 2];
+	big_endian.toBytes(exported, sizeof(exported), big_unsigned::bigEndian);
+	assert(exported[0] == 0 && exported[1] == 0 && std::equal(bytes, bytes + sizeof(bytes), exported + 2));
+
+	little_endian.toBytes(exported, sizeof(bytes), big_unsigned::littleEndian);
+	assert(std::equal(bytes, bytes + sizeof(bytes), exported));
+
+	// truncated to the low bytes
+	big_endian.toBytes(exported, 2, big_unsigned::bigEndian);
+	assert(exported[0] == 0x0a && exported[1] == 0x0b);
+
+	const std::string hash(32, '\xff');
+	assert(bytes_to_big_unsigned(hash) == (big_unsigned(1) << 256) - 1);
+	assert(big_unsigned_to_bytes(bytes_to_big_unsigned(hash), 32) == hash);
+
+	// a negative result throws before an aliased output is written
+	big_unsigned smaller = big_endian, larger = big_endian + 1;
+	for (big_unsigned* output : { &smaller, &larger })
+	{
+		[[maybe_unused]]
+		bool thrown = false;
+		try
+		{
+			output->subtract(smaller, larger);
+		}
+		catch (const char*)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	assert(smaller == big_endian && larger == big_endian + 1);
+
+	for (uint64_t bit_length = 1; bit_length <= 130; ++bit_length)
+	{
+		[[maybe_unused]]
+		big_unsigned candidate = prime_utils::generate_prime_candidate(bit_length);
+		assert(candidate.bitLength() == bit_length && candidate.getBit(0));
+	}
+
+	benchmark::measure("bytes_to_big_unsigned (32 bytes)", 100000, [&]()
+	{
+		bytes_to_big_unsigned(hash);
+	});
+
+	benchmark::measure("prime_utils::generate_prime_candidate(2048)", 1000, [&]()
+	{
+		prime_utils::generate_prime_candidate(2048);
+	});
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(named_curves_test)
+{
+	for (const std::string& name : elliptical_curve::get_names())
+	{
+		const elliptical_curve& curve = elliptical_curve::get(name);
+		const elliptical_point& g = curve.get_generator();
+
+		assert(&elliptical_curve::get(name) == &curve);
+		assert(curve.contains(g.x, g.y));
+		assert(!curve.contains(g.x, g.y + 1));
+
+		// q * G is the point at infinity, (q - 1) * G == -G
+		elliptical_point infinity = elliptical_point::multiply(curve.get_q(), g);
+		assert(infinity.x == 0 && infinity.y == 0);
+
+		elliptical_point minus_g = elliptical_point::multiply(curve.get_q() - 1, g);
+		assert(minus_g.x == g.x && minus_g.y == big_integer(curve.get_p()) - g.y);
+
+		elliptical_point table_minus_g = curve.get_generator_table()->multiply(curve.get_q() - 1);
+		assert(table_minus_g.x == minus_g.x && table_minus_g.y == minus_g.y);
+
+		const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+		elliptical_signer signer(name);
+		const std::string signature = signer.sign_message(message);
+
+		[[maybe_unused]]
+		bool verified = signer.verify_message(message, signature, signer.get_public_key());
+		assert(verified);
+
+		benchmark::measure("elliptical_point::multiply on " + name, 20, [&]()
+		{
+			elliptical_point::multiply(curve.get_q() - 1, g);
+		});
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		elliptical_curve::get("unknown");
+	}
+	catch (const elliptical_curve::unknown_curve&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(signer_verify_batch_benchmark)
+{
+	constexpr uint64_t max_batch_size = 64;
+	constexpr uint64_t repeats_count = 4;
+
+	elliptical_signer signer;
+	const std::string public_key = signer.get_public_key();
+	std::vector<std::string> messages;
+	std::vector<std::string> signatures;
+	for (uint64_t i = 0; i < max_batch_size; ++i)
+	{
+		messages.push_back("message number " + std::to_string(i));
+		signatures.push_back(signer.sign_message(messages.back()));
+	}
+
+	for (uint64_t threads_count : { 1, 4 })
+	{
+		thread_pool pool(threads_count);
+
+		std::vector<std::string> batch = { messages[0], "never signed", messages[1] };
+		std::vector<std::string> batch_signatures = { signatures[0], signatures[1], signatures[1] };
+		[[maybe_unused]]
+		std::vector<bool> verified = signer.verify_batch(batch, batch_signatures, public_key, pool);
+		assert(verified.size() == 3 && verified[0] && !verified[1] && verified[2]);
+
+		for (uint64_t batch_size : { 1, 16, 64 })
+		{
+			batch.assign(messages.begin(), messages.begin() + batch_size);
+			batch_signatures.assign(signatures.begin(), signatures.begin() + batch_size);
+
+			double seconds = benchmark::measure("elliptical_signer::verify_batch " + std::to_string(batch_size) + 
+				" on " + std::to_string(threads_count) + " threads", repeats_count, [&]()
+			{
+				[[maybe_unused]]
+				std::vector<bool> batch_verified = signer.verify_batch(batch, batch_signatures, public_key, pool);
+				assert(std::all_of(batch_verified.begin(), batch_verified.end(), [](bool v) { return v; }));
+			});
+
+			std::cerr << "verifications/sec: " << batch_size * repeats_count / seconds << std::endl;
+		}
+	}
 }
 TEST_CASE_END()
 
@@ -32,6 +691,20 @@ int main()
 	try
 	{
 		signer_base_sign_verify();
+		montgomery_context_test();
+		big_unsigned_bytes_test();
+		named_curves_test();
+		signer_fallback_nonce_test();
+		point_multiply_allocations_benchmark();
+		point_multiply_jacobian_benchmark();
+		wnaf_recode_test();
+		point_multiply_wnaf_benchmark();
+		fixed_base_table_multiply_benchmark();
+		signer_throughput_benchmark();
+		signer_precomputation_benchmark();
+		point_multiply_joint_benchmark();
+		signer_verify_benchmark();
+		signer_verify_batch_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
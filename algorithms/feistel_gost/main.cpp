@@ -3,9 +3,32 @@
 #include <iostream>
 #include <cassert>
 
+#include <vector>
+#include <random>
+
 #include "gost_encrypter.hpp"
+#include "gost_mac.hpp"
 #include "gost_wrapper.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "bit_utils.hpp"
+#include "cpu_features.hpp"
+#include "thread_pool.hpp"
+
+namespace
+{
+	std::string random_bytes(uint64_t size, uint32_t seed)
+	{
+		std::mt19937 generator(seed);
+		std::string bytes(size, '\0');
+		for (auto& byte : bytes)
+		{
+			byte = static_cast<char>(generator() & 0xff);
+		}
+
+		return bytes;
+	}
+}
 
 TEST_CASE_BEGIN(cipher_base_encrypt_decrypt)
 {
@@ -113,15 +136,345 @@ TEST_CASE_BEGIN(gost_wrapper_ede2_encrypt_decrypt)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(cipher_known_answers)
+{
+	// ciphertexts of the one-block-at-a-time implementation this class started with
+	const std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+	const std::string expected = bit_utils::from_hex(
+		"23eedba1ce4a2fac2fb1d57abc6b6badc39f7460b8193d2b1ae22450"
+		"d8e9ccb453985957ddfc9d1a215bee9eab8b22810275879ca266f834");
+
+	for (auto kernel : gost_encrypter::get_kernels())
+	{
+		gost_encrypter encrypter("secretKDAeAAet_ksedset_kssJhin_k", kernel);
+		assert(encrypter.get_kernel() == kernel);
+		assert(encrypter.encrypt(message) == expected);
+		assert(encrypter.encrypt(std::string(BLOCK_SIZE, '\0')) == bit_utils::from_hex("fa6ca77232ca1e47"));
+		assert(encrypter.decrypt(expected) == message);
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_kernels_ecb_ctr)
+{
+	gost_encrypter scalar("secretKDAeAAet_ksedset_kssJhin_k", cpu_features::isa::scalar);
+
+	for (uint64_t size : { 0, 5, 8, 63, 64, 1000, 8 * 1024 + 3 })
+	{
+		const std::string message = random_bytes(size, static_cast<uint32_t>(size));
+		const std::string encrypted = scalar.encrypt(message);
+		const std::string iv = bit_utils::from_hex("FFFFFFFFFFFFFFFE");
+		const std::string ciphertext = scalar.crypt_ctr(message, iv);
+		assert(ciphertext.size() == message.size());
+
+		// counter blocks iv, iv + 1, ... through ECB, wrapping around 2^64
+		const std::string counters = bit_utils::from_hex("FFFFFFFFFFFFFFFEFFFFFFFFFFFFFFFF0000000000000000");
+		const std::string keystream = scalar.encrypt(counters);
+		for (uint64_t i = 0; i < std::min<uint64_t>(size, 3 * BLOCK_SIZE); ++i)
+		{
+			assert(static_cast<char>(ciphertext[i] ^ keystream[i]) == message[i]);
+		}
+
+		// every kernel gives the scalar output, full lane groups and the scalar tail alike
+		for (auto kernel : gost_encrypter::get_kernels())
+		{
+			gost_encrypter encrypter("secretKDAeAAet_ksedset_kssJhin_k", kernel);
+			assert(encrypter.encrypt(message) == encrypted);
+			assert(encrypter.decrypt(encrypted) == message);
+			assert(encrypter.crypt_ctr(message, iv) == ciphertext);
+			assert(encrypter.crypt_ctr(ciphertext, iv) == message);
+		}
+	}
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		scalar.crypt_ctr("message", "short");
+	}
+	catch (const gost_encrypter::invalid_iv&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_param_sets)
+{
+	// key bytes 00..1f, one block 0123456789abcdef; checked against OpenSSL's ccgost engine with every
+	// 32-bit word of key, block and ciphertext byte-reversed
+	std::string key;
+	for (uint32_t i = 0; i < KEY_LENGTH; ++i)
+	{
+		key.push_back(static_cast<char>(i));
+	}
+	const std::string block = bit_utils::from_hex("0123456789abcdef");
+	const std::vector<std::pair<gost_param_set, std::string>> vectors =
+	{
+		{ gost_param_set::legacy, "095297dd409b90d8" },
+		{ gost_param_set::tc26_z, "eea4204d2249292c" },
+		{ gost_param_set::cryptopro_a, "8b1700cc89b38c2b" },
+		{ gost_param_set::cryptopro_b, "2d18452dbfe46d34" },
+		{ gost_param_set::cryptopro_c, "5aeb6cc11bf1aeff" },
+		{ gost_param_set::cryptopro_d, "75c9d76fc0764810" },
+		{ gost_param_set::r3411_94_test, "47e1e7ae82a52f34" },
+		{ gost_param_set::r3411_94_cryptopro, "3b13c011fb620242" },
+	};
+	assert(vectors.size() == GOST_PARAM_SETS_COUNT);
+
+	const std::string message = random_bytes(1000, 7);
+	const std::string iv = bit_utils::from_hex("0000000000000001");
+	for (const auto& vector : vectors)
+	{
+		gost_encrypter scalar(key, vector.first, cpu_features::isa::scalar);
+		assert(scalar.get_param_set() == vector.first);
+
+		std::string output(BLOCK_SIZE, '\0');
+		scalar.encrypt_blocks(reinterpret_cast<const uint8_t*>(block.data()), reinterpret_cast<uint8_t*>(&output[0]), 1);
+		assert(bit_utils::to_hex(output) == vector.second);
+
+		const std::string encrypted = scalar.encrypt(message);
+		const std::string ciphertext = scalar.crypt_ctr(message, iv);
+		for (auto kernel : gost_encrypter::get_kernels())
+		{
+			gost_encrypter encrypter(key, vector.first, kernel);
+			assert(encrypter.encrypt(message) == encrypted);
+			assert(encrypter.decrypt(encrypted) == message);
+			assert(encrypter.crypt_ctr(message, iv) == ciphertext);
+		}
+	}
+
+	// the sets do differ, and the default is the legacy one
+	assert(gost_encrypter(key).encrypt(message) == gost_encrypter(key, gost_param_set::legacy).encrypt(message));
+	assert(gost_encrypter(key).encrypt(message) != gost_encrypter(key, gost_param_set::tc26_z).encrypt(message));
+
+	// the Magma example of RFC 8891 under param-Z, with the halves of the block swapped both ways
+	const gost_encrypter magma(bit_utils::from_hex("ffeeddccbbaa99887766554433221100f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"),
+		gost_param_set::tc26_z);
+	const std::string swapped = magma.encrypt(bit_utils::from_hex("76543210fedcba98")).substr(0, BLOCK_SIZE);
+	assert(bit_utils::to_hex(swapped.substr(4) + swapped.substr(0, 4)) == "4ee901e5c2d8ca3d");
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_gamma_cfb_mac)
+{
+	// key bytes 00..1f; the cryptopro_a outputs agree with OpenSSL's gost89-cnt, gost89 (CFB) and
+	// gost-mac under the word byte order noted in gost_param_set.hpp
+	std::string key;
+	for (uint32_t i = 0; i < KEY_LENGTH; ++i)
+	{
+		key.push_back(static_cast<char>(i));
+	}
+	const std::string iv = bit_utils::from_hex("0001020304050607");
+	const std::string message = "0123456789abcdefXYZ";
+	const std::string lorem = "Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+
+	const gost_encrypter cryptopro(key, gost_param_set::cryptopro_a);
+	assert(bit_utils::to_hex(cryptopro.crypt_gamma(message, iv)) == "d26997d34214c902accf7edf51f243685df1f0");
+	assert(bit_utils::to_hex(cryptopro.encrypt_cfb(message, iv)) == "2f636bc69163c49d9a5dbf5d556a37e505e7de");
+	const gost_mac cryptopro_mac(key, gost_param_set::cryptopro_a);
+	assert(bit_utils::to_hex(cryptopro_mac.generate_mac(message)) == "bca8b7fb");
+	assert(bit_utils::to_hex(cryptopro_mac.generate_mac("01234567")) == "d95bf4f9");
+	assert(bit_utils::to_hex(cryptopro_mac.generate_mac(lorem)) == "4d149e6d");
+	assert(bit_utils::to_hex(cryptopro_mac.generate_mac(lorem + "!")) == "b2af716e");
+	assert(bit_utils::to_hex(cryptopro_mac.generate_mac("")) == "00000000");
+
+	const gost_encrypter legacy(key);
+	assert(bit_utils::to_hex(legacy.crypt_gamma(message, iv)) == "70ef4c99b86e43ab39110a29a45d5fe601e3c5");
+	assert(bit_utils::to_hex(legacy.encrypt_cfb(message, iv)) == "bbcab5023bbb31a04a848d97b4de27d51cc33b");
+	assert(bit_utils::to_hex(gost_mac(key).generate_mac(message)) == "5c27f39c");
+	assert(bit_utils::to_hex(gost_mac(key).generate_mac("01234567")) == "e80dd80e");
+
+	// the counter stepped one block at a time, n2 + C1 taking its carry back in
+	const std::string long_message = random_bytes(1000 * BLOCK_SIZE + 5, 11);
+	uint8_t counter[BLOCK_SIZE];
+	legacy.encrypt_blocks(reinterpret_cast<const uint8_t*>(iv.data()), counter, 1);
+	uint32_t n1 = bit_utils::string_to_int32(std::string(reinterpret_cast<const char*>(counter), 4));
+	uint32_t n2 = bit_utils::string_to_int32(std::string(reinterpret_cast<const char*>(counter) + 4, 4));
+	std::string stepped = long_message;
+	for (uint64_t i = 0; i < stepped.size(); i += BLOCK_SIZE)
+	{
+		n1 += GOST_GAMMA_C2;
+		n2 += GOST_GAMMA_C1;
+		n2 += n2 < GOST_GAMMA_C1 ? 1 : 0;
+		std::string gamma = bit_utils::int32_to_string(n1) + bit_utils::int32_to_string(n2);
+		legacy.encrypt_blocks(bit_utils::stob(gamma), bit_utils::stob(gamma), 1);
+		for (uint64_t j = i; j < std::min<uint64_t>(stepped.size(), i + BLOCK_SIZE); ++j)
+		{
+			stepped[j] ^= gamma[j - i];
+		}
+	}
+	assert(legacy.crypt_gamma(long_message, iv) == stepped);
+
+	// the pool and every kernel give the same output, each mode decrypts what it encrypted
+	thread_pool pool(4);
+	for (uint64_t size : { 0, 1, 8, 9, 1000, 64 * 1024 + 3 })
+	{
+		const std::string plain = random_bytes(size, static_cast<uint32_t>(size) + 3);
+		const std::string gamma_text = legacy.crypt_gamma(plain, iv);
+		const std::string cfb_text = legacy.encrypt_cfb(plain, iv);
+		assert(gamma_text.size() == size && cfb_text.size() == size);
+		for (auto kernel : gost_encrypter::get_kernels())
+		{
+			gost_encrypter encrypter(key, kernel);
+			assert(encrypter.crypt_gamma(plain, iv) == gamma_text);
+			assert(encrypter.crypt_gamma(plain, iv, pool) == gamma_text);
+			assert(encrypter.crypt_gamma(gamma_text, iv, pool) == plain);
+			assert(encrypter.encrypt_cfb(plain, iv) == cfb_text);
+			assert(encrypter.decrypt_cfb(cfb_text, iv) == plain);
+		}
+	}
+
+	// a MAC fed in pieces of any size is the one-shot MAC, finalize leaves the stream open
+	gost_mac streaming(key, gost_param_set::cryptopro_a);
+	uint64_t offset = 0;
+	for (uint64_t piece : { 0, 3, 1, 8, 13, 5 })
+	{
+		streaming.update(lorem.substr(offset, piece));
+		offset += piece;
+		assert(streaming.finalize() == cryptopro_mac.generate_mac(lorem.substr(0, offset)));
+	}
+	streaming.update(lorem.substr(offset));
+	assert(streaming.finalize() == cryptopro_mac.generate_mac(lorem));
+	streaming.reset();
+	streaming.update(message);
+	assert(streaming.finalize() == cryptopro_mac.generate_mac(message));
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		legacy.crypt_gamma("message", "short");
+	}
+	catch (const gost_encrypter::invalid_iv&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(modes_throughput_benchmark)
+{
+	constexpr uint64_t megabyte = 1 << 20;
+	const std::string message = random_bytes(megabyte, 2);
+	const std::string iv(BLOCK_SIZE, '\0');
+
+	thread_pool pool;
+	const gost_encrypter encrypter("secretKDAeAAet_ksedset_kssJhin_k");
+	const std::string name = "gost " + std::string(cpu_features::get_isa_name(encrypter.get_kernel()));
+	const std::string cfb_text = encrypter.encrypt_cfb(message, iv);
+
+	const double gamma_seconds = benchmark::measure(name + " crypt_gamma 1 MiB", 8, [&]()
+	{
+		encrypter.crypt_gamma(message, iv);
+	});
+	const double pool_seconds = benchmark::measure(name + " crypt_gamma 1 MiB, pool", 8, [&]()
+	{
+		encrypter.crypt_gamma(message, iv, pool);
+	});
+	const double cfb_encrypt_seconds = benchmark::measure(name + " encrypt_cfb 1 MiB", 8, [&]()
+	{
+		encrypter.encrypt_cfb(message, iv);
+	});
+	const double cfb_decrypt_seconds = benchmark::measure(name + " decrypt_cfb 1 MiB", 8, [&]()
+	{
+		encrypter.decrypt_cfb(cfb_text, iv);
+	});
+	const gost_mac mac("secretKDAeAAet_ksedset_kssJhin_k");
+	const double mac_seconds = benchmark::measure("gost mac 1 MiB", 8, [&]()
+	{
+		mac.generate_mac(message);
+	});
+	std::cerr << name << ": gamma " << 8 / gamma_seconds << " MB/s, gamma on " << pool.get_threads_count()
+		<< " threads " << 8 / pool_seconds << " MB/s, CFB encrypt " << 8 / cfb_encrypt_seconds
+		<< " MB/s, CFB decrypt " << 8 / cfb_decrypt_seconds << " MB/s, MAC " << 8 / mac_seconds << " MB/s" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(kernel_throughput_benchmark)
+{
+	constexpr uint64_t megabyte = 1 << 20;
+	const std::string message = random_bytes(megabyte, 1);
+	const std::string iv(BLOCK_SIZE, '\0');
+
+	std::string output(message.size(), '\0');
+	for (auto kernel : gost_encrypter::get_kernels())
+	{
+		gost_encrypter encrypter("secretKDAeAAet_ksedset_kssJhin_k", kernel);
+		const std::string name = "gost " + std::string(cpu_features::get_isa_name(kernel));
+
+		const double blocks_seconds = benchmark::measure(name + " encrypt_blocks 1 MiB", 8, [&]()
+		{
+			encrypter.encrypt_blocks(reinterpret_cast<const uint8_t*>(message.data()),
+				reinterpret_cast<uint8_t*>(&output[0]), message.size() / BLOCK_SIZE);
+		});
+		const double ecb_seconds = benchmark::measure(name + " encrypt 1 MiB", 8, [&]()
+		{
+			encrypter.encrypt(message);
+		});
+		const double ctr_seconds = benchmark::measure(name + " crypt_ctr 1 MiB", 8, [&]()
+		{
+			encrypter.crypt_ctr(message, iv);
+		});
+		std::cerr << name << ": blocks " << 8 / blocks_seconds << " MB/s, ECB " << 8 / ecb_seconds
+			<< " MB/s, CTR " << 8 / ctr_seconds << " MB/s" << std::endl;
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cpu_isa_dispatch)
+{
+	// every tier name parses back to its tier, anything else leaves the level alone
+	for (uint32_t i = 0; i < cpu_features::ISA_COUNT; ++i)
+	{
+		const auto tier = static_cast<cpu_features::isa>(i);
+		[[maybe_unused]]
+		cpu_features::isa parsed = cpu_features::isa::scalar;
+		[[maybe_unused]]
+		const bool known = cpu_features::parse_isa(cpu_features::get_isa_name(tier), parsed);
+		assert(known);
+		assert(parsed == tier);
+	}
+	[[maybe_unused]]
+	cpu_features::isa level = cpu_features::isa::avx2;
+	[[maybe_unused]]
+	const bool unknown = cpu_features::parse_isa("avx1024", level);
+	assert(!unknown);
+	assert(level == cpu_features::isa::avx2);
+
+	// scalar is always there, a request falls back to the best tier below it with a kernel
+	assert(cpu_features::is_supported(cpu_features::isa::scalar));
+	assert(cpu_features::is_supported(cpu_features::get_isa()));
+	assert(gost_encrypter::get_kernels().front() == cpu_features::isa::scalar);
+	if (cpu_features::has_sse41())
+	{
+		// no gather before avx2, so sse4.1 runs the scalar rounds
+		assert(gost_encrypter("secretKDAeAAet_ksedset_kssJhin_k", cpu_features::isa::sse41).get_kernel() == 
+			cpu_features::isa::scalar);
+	}
+
+	std::cerr << "cpu isa: " << cpu_features::get_isa_name(cpu_features::get_isa()) << std::endl;
+}
+TEST_CASE_END()
+
 int main()
 {
 	try
 	{
 		cipher_base_encrypt_decrypt();
 		cipher_long_message_encrypt_decrypt();
+		cipher_known_answers();
+		cipher_kernels_ecb_ctr();
+		cipher_param_sets();
+		cipher_gamma_cfb_mac();
 		gost_wrapper_ede3_encrypt_decrypt();
 		gost_wrapper_ede2_encrypt_decrypt();
 		gost_wrapper_eee3_encrypt_decrypt();
+		cpu_isa_dispatch();
+		kernel_throughput_benchmark();
+		modes_throughput_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
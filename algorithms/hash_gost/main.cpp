@@ -3,8 +3,14 @@
 #include <iostream>
 #include <cassert>
 
+#include <vector>
+#include <algorithm>
+
 #include "gost_hash.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "bit_utils.hpp"
+#include "cpu_features.hpp"
 
 TEST_CASE_BEGIN(hash_base_message)
 {
@@ -36,12 +42,176 @@ TEST_CASE_BEGIN(hash_long_message)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(hash_partial_block)
+{
+	gost_hash hash_generator("secretKDAeAAet_ksedset_kssJhin_k");
+
+	// a trailing partial block counts as much as a full one
+	for (const std::string& message : { std::string("seed"), std::string(40, 'a') })
+	{
+		std::string changed = message;
+		changed.back() ^= 1;
+
+		std::cout << "partial block message " << message << std::endl;
+		assert(hash_generator.generate_hash(message) != hash_generator.generate_hash(changed));
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(hash_known_answers)
+{
+	// digests of the bitset implementation the step functions replaced
+	const std::string long_message = 
+		"secretKDAeAAet_ksedset_kssJhin_ksecretKDAeAAet_ksedset_kssJhin_ksecretKDAeAAet_ksedset_kssJhin_kdsdsdsds";
+	const std::vector<std::pair<std::string, std::string>> vectors =
+	{
+		{ "", "7f999a22752dcf2cd856b7b8f37b4683fc1b1986615d0b2a17e729ba4dabb8ec" },
+		{ "seed", "22306dc3550beab28fb5863ededdb8d4d0f1efd0a499e61fe547981c72b4fe9f" },
+		{ "secretKDAeAAet_ksedset_kssJhin_k", "5ba157b623d22d3d87b40df25d34c6aa8c685a2e7b67fb2324ead50b9f297578" },
+		{ long_message, "ac1431d1eac4e4c157fc0a4f7f69422bb8a911369add3db69027e7a2d8f6b674" },
+		{ std::string(40, 'a'), "bff1add4eafcbdfde972aa542e9a41a3765ecb0d7ae3e898baea8c7cb92b38df" },
+		// carries run through the whole control sum
+		{ std::string(1000, '\xff'), "d1097010b36851f1d0148f54f102b7a86755c0897fcfcf18ed967cc1cf4ce3fb" },
+	};
+
+	for (auto kernel : gost_hash::get_kernels())
+	{
+		gost_hash hash_generator("secretKDAeAAet_ksedset_kssJhin_k", kernel);
+		assert(hash_generator.get_kernel() == kernel);
+		for ([[maybe_unused]] const auto& vector : vectors)
+		{
+			assert(bit_utils::to_hex(hash_generator.generate_hash(vector.first)) == vector.second);
+		}
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(hash_param_sets)
+{
+	const std::string message(100, 'm');
+	const std::string legacy = gost_hash("secretKDAeAAet_ksedset_kssJhin_k").generate_hash(message);
+
+	// each set gives its own digest, the same on every kernel
+	std::vector<std::string> digests;
+	for (uint32_t i = 0; i < GOST_PARAM_SETS_COUNT; ++i)
+	{
+		const auto set = static_cast<gost_param_set>(i);
+		const std::string expected = gost_hash("secretKDAeAAet_ksedset_kssJhin_k", set, cpu_features::isa::scalar)
+			.generate_hash(message);
+		for (auto kernel : gost_hash::get_kernels(set))
+		{
+			gost_hash hash_generator("secretKDAeAAet_ksedset_kssJhin_k", set, kernel);
+			assert(hash_generator.get_param_set() == set);
+			assert(hash_generator.generate_hash(message) == expected);
+		}
+		assert(std::find(digests.begin(), digests.end(), expected) == digests.end());
+		digests.push_back(expected);
+	}
+	assert(digests.front() == legacy);
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(hash_r3411_known_answers)
+{
+	// the examples of GOST R 34.11-94 and the usual ones of both its sets, checked against OpenSSL's ccgost
+	const std::vector<std::string> messages =
+	{
+		"",
+		"abc",
+		"message digest",
+		"This is message, length=32 bytes",
+		"Suppose the original message has length = 50 bytes",
+		std::string(1000, 'a'),
+	};
+	const std::vector<std::pair<gost_param_set, std::vector<std::string>>> vectors =
+	{
+		{
+			gost_param_set::r3411_94_test,
+			{
+				"ce85b99cc46752fffee35cab9a7b0278abb4c2d2055cff685af4912c49490f8d",
+				"f3134348c44fb1b2a277729e2285ebb5cb5e0f29c975bc753b70497c06a4d51d",
+				"ad4434ecb18f2c99b60cbe59ec3d2469582b65273f48de72db2fde16a4889a4d",
+				"b1c466d37519b82e8319819ff32595e047a28cb6f83eff1c6916a815a637fffa",
+				"471aba57a60a770d3a76130635c1fbea4ef14de51f78b4ae57dd893b62f55208",
+				"cc25bb524258320913a4ec4692327bdfc9876fa53777be4754f0b1c9b40ecb26",
+			},
+		},
+		{
+			gost_param_set::r3411_94_cryptopro,
+			{
+				"981e5f3ca30c841487830f84fb433e13ac1101569b9c13584ac483234cd656c0",
+				"b285056dbf18d7392d7677369524dd14747459ed8143997e163b2986f92fd42c",
+				"bc6041dd2aa401ebfa6e9886734174febdb4729aa972d60f549ac39b29721ba0",
+				"2cefc2f7b7bdc514e18ea57fa74ff357e7fa17d652c75f69cb1be7893ede48eb",
+				"c3730c5cbccacf915ac292676f21e8bd4ef75331d9405e5f1a61dc3130a65011",
+				"cfd707497028e7afefdf80f823a0e0171bcdf5ee402be94e448acb8fb4ae58f3",
+			},
+		},
+		// the cipher S-boxes work in the hash too, these taken from OpenSSL's hash with them
+		{
+			gost_param_set::cryptopro_a,
+			{
+				"fae294734435abdc15398ab8bb63bc9c9b83b32b5a7004ea35ca3e8f0a5d9617",
+				"707490139b5c2531def609b3ea0c37f50dd32d88656eee3b9d9349bb64801eb7",
+				"973e2cd5a20ff2c37dd7e3047471fe8ab5be667cc1f0d65a6ca44b60320f24c5",
+				"7d599ed86524ac809aaed12cd112d2f8b790f49fe965683b3d6dd667bc281fa9",
+				"9dc366ef3af644a52d66761df73beb69bd250f6ec3b38673413beaddaaa5f3cc",
+				"f6cbb5d43285793728d94dcf05821609609edbcdd6c0c393a433c855a71db827",
+			},
+		},
+	};
+
+	for (const auto& [set, digests] : vectors)
+	{
+		const gost_hash hash_generator(set);
+		assert(hash_generator.get_param_set() == set);
+		for (uint64_t i = 0; i < messages.size(); ++i)
+		{
+			assert(bit_utils::to_hex(hash_generator.generate_hash(messages[i])) == digests[i]);
+		}
+	}
+
+	// the starting block is still the caller's to pick
+	assert(gost_hash(std::string(HASH_BLOCK_SIZE, '\0'), gost_param_set::r3411_94_test).generate_hash("abc") == 
+		gost_hash(gost_param_set::r3411_94_test).generate_hash("abc"));
+	assert(gost_hash("secretKDAeAAet_ksedset_kssJhin_k", gost_param_set::r3411_94_test).generate_hash("abc") != 
+		gost_hash(gost_param_set::r3411_94_test).generate_hash("abc"));
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(hash_kernels_benchmark)
+{
+	const std::string message(64 * 1024, 'x');
+
+	gost_hash scalar("secretKDAeAAet_ksedset_kssJhin_k", cpu_features::isa::scalar);
+	const std::string expected = scalar.generate_hash(message);
+
+	for (auto kernel : gost_hash::get_kernels())
+	{
+		gost_hash hash_generator("secretKDAeAAet_ksedset_kssJhin_k", kernel);
+		assert(hash_generator.generate_hash(message) == expected);
+
+		const std::string name = "gost_hash " + std::string(cpu_features::get_isa_name(kernel));
+		const double seconds = benchmark::measure(name + " 64 KiB", 8, [&]()
+		{
+			hash_generator.generate_hash(message);
+		});
+		std::cerr << name << ": " << 8 * 64 / 1024.0 / seconds << " MB/s" << std::endl;
+	}
+}
+TEST_CASE_END()
+
 int main()
 {
 	try
 	{
 		hash_base_message();
 		hash_long_message();
+		hash_partial_block();
+		hash_known_answers();
+		hash_param_sets();
+		hash_r3411_known_answers();
+		hash_kernels_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
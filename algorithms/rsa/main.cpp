@@ -1,8 +1,20 @@
 #include <iostream>
 #include <string>
 #include <cassert>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "rsa_encrypter.hpp"
+#include "benchmark.hpp"
+#include "bit_utils.hpp"
+#include "thread_pool.hpp"
+#include "prime_utils.hpp"
+#include "montgomery_context.hpp"
+#include "cpu_features.hpp"
+
+// every iteration of the stress test generates a key, kept small so the test stays quick
+constexpr uint64_t STRESS_KEY_BITS = 512;
 
 static uint32_t tests_passed = 0;
 
@@ -21,15 +33,17 @@ TEST_CASE_BEGIN(cipher_base_encrypt_decrypt)
 	std::string message = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
 
 	rsa_encrypter encrypter;
+	assert(encrypter.get_key_bits() == DEFAULT_RSA_KEY_BITS);
 	std::cout << "initial name " << message << std::endl;
 
 	const std::string& public_key = encrypter.get_public_key();
 	std::cout << "public key " << public_key << std::endl;
 
 	std::string encrypted = rsa_encrypter::encrypt(message, public_key);
-	std::cout << "encrypted name " << encrypted << std::endl;
+	std::cout << "encrypted name " << bit_utils::to_hex(encrypted) << std::endl;
 
 	assert(message != encrypted);
+	assert(encrypted.size() == encrypter.get_ciphertext_block_size());
 
 	std::string decrypted = encrypter.decrypt(encrypted);
 	std::cout << "decrypted name " << decrypted << std::endl;
@@ -38,6 +52,92 @@ TEST_CASE_BEGIN(cipher_base_encrypt_decrypt)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(cipher_block_boundaries)
+{
+	for (uint64_t key_bits : { MIN_RSA_KEY_BITS, MIN_RSA_KEY_BITS + 1, STRESS_KEY_BITS - 1, STRESS_KEY_BITS })
+	{
+		rsa_encrypter encrypter(key_bits);
+		assert(encrypter.get_key_bits() == key_bits);
+
+		// block size and its neighbours, zero bytes at both ends and a trailing padding marker
+		const uint64_t block_size = (key_bits + 7) / 8 - 1;
+		for (uint64_t size : { uint64_t(0), uint64_t(1), block_size - 1, block_size, block_size + 1, 3 * block_size })
+		{
+			std::string message(size, '\0');
+			for (uint64_t i = 1; i + 1 < size; ++i)
+			{
+				message[i] = static_cast<char>(i * 37);
+			}
+			if (size > 2)
+			{
+				message[size - 2] = static_cast<char>(0x80);
+			}
+
+			[[maybe_unused]]
+			std::string decrypted = encrypter.decrypt(encrypter.encrypt(message));
+			assert(decrypted == message);
+		}
+	}
+
+	rsa_encrypter encrypter(STRESS_KEY_BITS);
+	const std::string& public_key = encrypter.get_public_key();
+
+	[[maybe_unused]]
+	bool thrown = false;
+	try
+	{
+		rsa_encrypter::encrypt("message", public_key.substr(0, public_key.size() - 1) + '\x02');
+	}
+	catch (const rsa_encrypter::invalid_key&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	// a block above the module, a valid block that decrypts without the padding marker (1^d == 1),
+	// and sizes that are not whole blocks
+	const uint64_t block_size = encrypter.get_ciphertext_block_size();
+	std::string one(block_size, '\0');
+	one.back() = 1;
+	for (const std::string& ciphertext : { std::string(block_size, '\xff'), one, std::string(), 
+		one + one.substr(1), std::string("\x01") })
+	{
+		thrown = false;
+		try
+		{
+			encrypter.decrypt(ciphertext);
+		}
+		catch (const rsa_encrypter::invalid_message&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	thrown = false;
+	try
+	{
+		rsa_encrypter::from_legacy_text("XYZ ", block_size);
+	}
+	catch (const rsa_encrypter::invalid_message&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+
+	thrown = false;
+	try
+	{
+		rsa_encrypter too_small(MIN_RSA_KEY_BITS - 1);
+	}
+	catch (const rsa_encrypter::invalid_key_size&)
+	{
+		thrown = true;
+	}
+	assert(thrown);
+}
+TEST_CASE_END()
+
 TEST_CASE_BEGIN(cipher_base_stress)
 {
 	const char alphanum[] =
@@ -55,7 +155,7 @@ TEST_CASE_BEGIN(cipher_base_stress)
 			message[j] = alphanum[rand() % (sizeof(alphanum) - 1)];
 		}
 
-		rsa_encrypter encrypter;
+		rsa_encrypter encrypter(STRESS_KEY_BITS);
 		const std::string& public_key = encrypter.get_public_key();
 		std::string encrypted = rsa_encrypter::encrypt(message, public_key);
 		assert(message != encrypted);
@@ -65,12 +165,228 @@ TEST_CASE_BEGIN(cipher_base_stress)
 }
 TEST_CASE_END()
 
+TEST_CASE_BEGIN(cipher_legacy_text_benchmark)
+{
+	rsa_encrypter encrypter;
+	const uint64_t block_size = encrypter.get_ciphertext_block_size();
+
+	const std::string message(4 * block_size, 'a');
+	const std::string encrypted = encrypter.encrypt(message);
+	const std::string text = rsa_encrypter::to_legacy_text(encrypted, block_size);
+	std::cerr << "binary ciphertext " << encrypted.size() << " bytes, legacy text " << text.size() << " bytes" << std::endl;
+
+	assert(rsa_encrypter::from_legacy_text(text, block_size) == encrypted);
+	assert(encrypter.decrypt(rsa_encrypter::from_legacy_text(text, block_size)) == message);
+
+	// zero-copy path, straight from a buffer that is not a std::string
+	std::vector<uint8_t> buffer(encrypted.begin(), encrypted.end());
+	assert(encrypter.decrypt(buffer.data(), buffer.size()) == message);
+
+	constexpr uint64_t iterations_count = 16;
+	double binary_seconds = benchmark::measure("binary ciphertext encrypt + decrypt", iterations_count, [&]()
+	{
+		encrypter.decrypt(encrypter.encrypt(message));
+	});
+
+	double text_seconds = benchmark::measure("legacy text encrypt + decrypt", iterations_count, [&]()
+	{
+		std::string encrypted_text = rsa_encrypter::to_legacy_text(encrypter.encrypt(message), block_size);
+		encrypter.decrypt(rsa_encrypter::from_legacy_text(encrypted_text, block_size));
+	});
+
+	std::cerr << "binary ciphertext speedup: " << text_seconds / binary_seconds << "x" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(private_key_blinding_benchmark)
+{
+	rsa_encrypter encrypter(STRESS_KEY_BITS);
+	const rsa_private_key& key = encrypter.get_private_key();
+	const montgomery_context context(key.get_module());
+
+	std::vector<big_unsigned> blocks;
+	std::vector<big_unsigned> encrypted_blocks;
+	for (uint64_t i = 0; i < 64; ++i)
+	{
+		blocks.push_back(prime_utils::generate_prime_candidate(STRESS_KEY_BITS - 1 - i % 8) - 1);
+		encrypted_blocks.push_back(context.exp(blocks.back(), key.get_public_exponent()));
+	}
+	blocks.push_back(0);
+	encrypted_blocks.push_back(0);
+	blocks.push_back(1);
+	encrypted_blocks.push_back(1);
+
+	// every call moves the blinding pair on, the results must not depend on it
+	for (size_t i = 0; i < blocks.size(); ++i)
+	{
+		assert(key.decrypt_block(encrypted_blocks[i]) == blocks[i]);
+		assert(key.decrypt_block_unblinded(encrypted_blocks[i]) == blocks[i]);
+	}
+
+	// and the pair is renewed under its mutex while several threads decrypt with the same key
+	thread_pool pool(4);
+	std::vector<uint8_t> decrypted(blocks.size(), 0);
+	pool.parallel_for(blocks.size(), [&](uint64_t i)
+	{
+		decrypted[i] = key.decrypt_block(encrypted_blocks[i]) == blocks[i];
+	});
+	assert(std::all_of(decrypted.begin(), decrypted.end(), [](uint8_t d) { return d != 0; }));
+
+	rsa_encrypter benchmark_encrypter;
+	const rsa_private_key& benchmark_key = benchmark_encrypter.get_private_key();
+	const big_unsigned block = prime_utils::generate_prime_candidate(DEFAULT_RSA_KEY_BITS - 1);
+	constexpr uint64_t iterations_count = 32;
+
+	double blinded_seconds = benchmark::measure("rsa_private_key::decrypt_block 2048", iterations_count, [&]()
+	{
+		benchmark_key.decrypt_block(block);
+	});
+
+	double unblinded_seconds = benchmark::measure("rsa_private_key::decrypt_block_unblinded 2048", iterations_count, [&]()
+	{
+		benchmark_key.decrypt_block_unblinded(block);
+	});
+
+	std::cerr << "blinding overhead: " << (blinded_seconds / unblinded_seconds - 1) * 100 << "%" << std::endl;
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_decrypt_batch_benchmark)
+{
+	rsa_encrypter encrypter;
+
+	constexpr uint64_t batch_size = 16;
+	constexpr uint64_t batches_count = 8;
+
+	std::vector<std::string> messages;
+	std::vector<std::string> batch;
+	for (uint64_t i = 0; i < batch_size; ++i)
+	{
+		messages.push_back("message number " + std::to_string(i));
+		batch.push_back(encrypter.encrypt(messages.back()));
+	}
+
+	for (uint64_t threads_count : { 1, 2, 4 })
+	{
+		thread_pool pool(threads_count);
+
+		assert(encrypter.decrypt_batch({}, pool).empty());
+
+		[[maybe_unused]]
+		std::vector<std::string> decrypted = encrypter.decrypt_batch({ batch[2], batch[0], batch[1] }, pool);
+		assert(decrypted.size() == 3 && decrypted[0] == messages[2] && decrypted[1] == messages[0] && decrypted[2] == messages[1]);
+
+		[[maybe_unused]]
+		bool thrown = false;
+		try
+		{
+			encrypter.decrypt_batch({ batch[0], batch[1].substr(1), batch[2] }, pool);
+		}
+		catch (const rsa_encrypter::invalid_message&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+
+		const std::vector<double> latencies = benchmark::sample(batches_count, [&]()
+		{
+			[[maybe_unused]]
+			std::vector<std::string> batch_decrypted = encrypter.decrypt_batch(batch, pool);
+			assert(batch_decrypted == messages);
+		});
+
+		double seconds = 0;
+		for (double latency : latencies)
+		{
+			seconds += latency;
+		}
+
+		std::cerr << "rsa_encrypter::decrypt_batch " << batch_size << " on " << threads_count << " threads: "
+			<< batch_size * batches_count / seconds << " decryptions/sec, batch latency p50 "
+			<< benchmark::percentile(latencies, 50) * 1000.0 << " ms, p99 " 
+			<< benchmark::percentile(latencies, 99) * 1000.0 << " ms" << std::endl;
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(cipher_key_sizes_benchmark)
+{
+	for (uint64_t key_bits : { RSA_2048_KEY_BITS, RSA_3072_KEY_BITS, RSA_4096_KEY_BITS })
+	{
+		const std::string bits = std::to_string(key_bits);
+
+		std::unique_ptr<rsa_encrypter> encrypter;
+		benchmark::measure("rsa_encrypter(" + bits + ")", 1, [&]()
+		{
+			encrypter = std::make_unique<rsa_encrypter>(key_bits);
+		});
+
+		// one block of message
+		const std::string message(key_bits / 8 - 2, 'a');
+		const std::string encrypted = encrypter->encrypt(message);
+
+		benchmark::measure("rsa_encrypter::encrypt " + bits, 4096 / key_bits * 16, [&]()
+		{
+			encrypter->encrypt(message);
+		});
+
+		benchmark::measure("rsa_encrypter::decrypt " + bits, 4096 / key_bits * 4, [&]()
+		{
+			[[maybe_unused]]
+			std::string decrypted = encrypter->decrypt(encrypted);
+			assert(decrypted == message);
+		});
+	}
+}
+TEST_CASE_END()
+
+TEST_CASE_BEGIN(montgomery_kernels_benchmark)
+{
+	for (uint64_t bits : { 64, 512, 1024, 2048, 4096 })
+	{
+		const big_unsigned module = prime_utils::generate_prime_candidate(bits);
+		const big_unsigned first = prime_utils::generate_prime_candidate(bits - 1);
+		const big_unsigned second = prime_utils::generate_prime_candidate(bits / 2);
+		const big_unsigned expected = first * second % module;
+
+		const montgomery_context scalar(module, cpu_features::isa::scalar);
+		const big_unsigned first_montgomery = scalar.to_montgomery(first);
+		const big_unsigned second_montgomery = scalar.to_montgomery(second);
+		const big_unsigned product = scalar.multiply(first_montgomery, second_montgomery);
+
+		// every kernel gives the scalar limbs, short operands and the module minus one included
+		for (auto kernel : montgomery_context::get_kernels())
+		{
+			const montgomery_context context(module, kernel);
+			assert(context.get_kernel() == kernel);
+			assert(context.multiply(first_montgomery, second_montgomery) == product);
+			assert(context.from_montgomery(product) == expected);
+			assert(context.multiply(module - 1, module - 1) == scalar.multiply(module - 1, module - 1));
+			assert(context.multiply(0, second_montgomery) == 0);
+
+			const std::string name = "montgomery_context::multiply " + std::to_string(bits) + " " + 
+				cpu_features::get_isa_name(kernel);
+			benchmark::measure(name, 20000, [&]()
+			{
+				context.multiply(first_montgomery, second_montgomery);
+			});
+		}
+	}
+}
+TEST_CASE_END()
+
 int main()
 {
 	try
 	{
 		cipher_base_encrypt_decrypt();
+		cipher_block_boundaries();
 		cipher_base_stress();
+		cipher_legacy_text_benchmark();
+		private_key_blinding_benchmark();
+		cipher_decrypt_batch_benchmark();
+		cipher_key_sizes_benchmark();
+		montgomery_kernels_benchmark();
 
 		std::cerr << tests_passed << " tests passed!" << std::endl;
 	}
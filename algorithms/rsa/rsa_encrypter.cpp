@@ -1,113 +1,97 @@
 #include "rsa_encrypter.hpp"
-#include <random>
 #include <ios>
 #include <iosfwd>
-#include <iomanip>
 #include <sstream>
+#include <tuple>
+#include <algorithm>
 
 #include "prime_utils.hpp"
+#include "montgomery_context.hpp"
 
-constexpr uint64_t MAX_PRIME_VALUE = std::numeric_limits<uint8_t>::max();
-constexpr uint64_t MIN_PRIME_VALUE = std::numeric_limits<uint8_t>::max() / 2;
-constexpr uint64_t KEY_ALIGN = 8;
+constexpr uint64_t PUBLIC_EXPONENT_SIZE = 4;
+constexpr uint8_t PADDING_MARKER = 0x80;
 
 namespace _rsa_utils
 {
-	// TODO: rewrite RSA algorithm on big int like digital signature 
-	uint64_t generate_prime_number(uint64_t min_val, uint64_t max_val, uint64_t ignore_prime = 0)
+	// a prime of bit_length bits with the top two set, so that two of them multiply to exactly twice
+	// as many bits, and p - 1 coprime to e
+	big_unsigned generate_prime_number(uint64_t bit_length, const big_unsigned& ignore_prime = 0)
 	{
-		const big_unsigned ignore_big_prime(static_cast<unsigned long>(ignore_prime));
-		const big_unsigned min_val_big(static_cast<unsigned long>(min_val));
-		const big_unsigned max_val_big(static_cast<unsigned long>(max_val));
+		const big_unsigned public_exponent(static_cast<unsigned long>(RSA_PUBLIC_EXPONENT));
 
 		while (true)
 		{
-			big_unsigned generated_value = prime_utils::generate_prime_number(min_val_big, max_val_big);
+			big_unsigned generated_value = prime_utils::generate_prime_number(bit_length, 2);
 
-			if (generated_value != ignore_big_prime && prime_utils::is_prime(generated_value))
+			// e is prime, so p - 1 is coprime to it unless e divides it
+			if (generated_value != ignore_prime && (generated_value - 1) % public_exponent != 0)
 			{
-				return generated_value.toUnsignedLong();
+				return generated_value;
 			}
 		}
 	}
 
-	uint64_t gcd(uint64_t a, uint64_t b)
+	std::tuple<big_unsigned, big_unsigned> string_to_key(const std::string& key)
 	{
-		while (a > 0 && b > 0)
+		if (key.size() <= PUBLIC_EXPONENT_SIZE)
 		{
-			if (a > b)
-			{
-				a %= b;
-			}
-			else
-			{
-				b %= a;
-			}
+			throw rsa_encrypter::invalid_key();
 		}
 
-		return a + b;
-	}
+		const big_unsigned module = bytes_to_big_unsigned(key.substr(0, key.size() - PUBLIC_EXPONENT_SIZE));
+		const big_unsigned key_exp = bytes_to_big_unsigned(key.substr(key.size() - PUBLIC_EXPONENT_SIZE));
 
-	uint64_t generate_coprime_number(uint64_t min_val, uint64_t coprime)
-	{
-		while (true)
+		// montgomery form needs an odd module, and a block needs at least one byte below it
+		if (module.bitLength() < MIN_RSA_KEY_BITS || !module.getBit(0) || key_exp < 3 || !key_exp.getBit(0))
 		{
-			uint64_t generated_value = generate_prime_number(min_val, coprime - 1);
-
-			if (gcd(coprime, generated_value) == 1)
-			{
-				return generated_value;
-			}
+			throw rsa_encrypter::invalid_key();
 		}
+
+		return { key_exp, module };
 	}
 
-	std::string key_to_string(int64_t key_exp, int64_t module)
+	// message bytes per block, one less than the module takes so that every block stays below it
+	uint64_t get_block_size(const big_unsigned& module)
 	{
-		std::stringstream stream;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << module;
-		stream << std::setfill('0') << std::setw(KEY_ALIGN) << std::right << std::hex << key_exp;
-
-		std::string result(stream.str());
+		return big_unsigned_bytes_count(module) - 1;
+	}
 
-		return result;
+	const unsigned char* to_bytes(const char* data)
+	{
+		return reinterpret_cast<const unsigned char*>(data);
 	}
 
-	std::tuple<int64_t, int64_t> string_to_key(const std::string& key)
+	unsigned char* to_bytes(char* data)
 	{
-		uint64_t module = std::stoi(key.substr(0, KEY_ALIGN), nullptr, 16);
-		uint64_t key_exp = std::stoi(key.substr(KEY_ALIGN, KEY_ALIGN), nullptr, 16);
+		return reinterpret_cast<unsigned char*>(data);
+	}
 
-		return {key_exp, module};
+	std::string block_to_hex(const big_unsigned& block)
+	{
+		return std::string(BigUnsignedInABase(block, 16));
 	}
 
-	uint64_t exp_by_module(uint64_t symbol, uint64_t key_exp, uint64_t module)
+	big_unsigned hex_to_block(const std::string& hex)
 	{
-		uint64_t result = symbol;
-		for (uint64_t i = 0; i < key_exp - 1; ++i)
+		try
 		{
-			result = (result * symbol) % module;
+			return big_unsigned(BigUnsignedInABase(hex, 16));
 		}
-		
-		return result;
-	}
-
-	uint64_t extended_gcd(uint64_t a, uint64_t b, int64_t& x, int64_t& y) {
-		if (a == 0) {
-			x = 0; y = 1;
-			return b;
+		catch (const char*)
+		{
+			throw rsa_encrypter::invalid_message();
 		}
-
-		int64_t prev_x, prev_y;
-		uint64_t d = extended_gcd(b % a, a, prev_x, prev_y);
-		x = prev_y - (b / a) * prev_x;
-		y = prev_x;
-		return d;
 	}
 }
 
-rsa_encrypter::rsa_encrypter()
+rsa_encrypter::rsa_encrypter(uint64_t key_bits)
 {
-	_generate_keys();
+	if (key_bits < MIN_RSA_KEY_BITS)
+	{
+		throw invalid_key_size();
+	}
+
+	_generate_keys(key_bits);
 }
 
 std::string rsa_encrypter::encrypt(const std::string& message) const
@@ -118,34 +102,126 @@ std::string rsa_encrypter::encrypt(const std::string& message) const
 std::string rsa_encrypter::encrypt(const std::string& message, const std::string& key)
 {
 	auto [key_exp, module] = _rsa_utils::string_to_key(key);
-	std::stringstream encryption_stream;
+	const montgomery_context context(module);
+	const uint64_t block_size = _rsa_utils::get_block_size(module);
+	const uint64_t encrypted_block_size = block_size + 1;
+
+	// the marker always fits, a message filling its last block gets a block of padding only
+	const uint64_t full_blocks_count = message.size() / block_size;
+	std::string last_block = message.substr(full_blocks_count * block_size);
+	last_block += static_cast<char>(PADDING_MARKER);
+	last_block.resize(block_size, '\0');
+
+	// full blocks are read in place, only the padded tail is copied
+	std::string encrypted_message((full_blocks_count + 1) * encrypted_block_size, '\0');
+	for (uint64_t i = 0; i <= full_blocks_count; ++i)
+	{
+		const char* data = i < full_blocks_count ? message.data() + i * block_size : last_block.data();
+		const big_unsigned block(_rsa_utils::to_bytes(data), block_size, big_unsigned::bigEndian);
+
+		context.exp(block, key_exp).toBytes(
+			_rsa_utils::to_bytes(&encrypted_message[i * encrypted_block_size]), encrypted_block_size, big_unsigned::bigEndian);
+	}
 
-	for (const char symbol : message)
+	return encrypted_message;
+}
+
+std::string rsa_encrypter::to_legacy_text(const std::string& ciphertext, uint64_t block_size)
+{
+	if (block_size == 0 || ciphertext.size() % block_size != 0)
 	{
-		uint64_t encrypted = _rsa_utils::exp_by_module(symbol, key_exp, module);
-		encryption_stream << std::hex << encrypted << " ";
+		throw invalid_message();
+	}
+
+	std::stringstream encryption_stream;
+	for (uint64_t offset = 0; offset < ciphertext.size(); offset += block_size)
+	{
+		const big_unsigned block(_rsa_utils::to_bytes(ciphertext.data() + offset), block_size, big_unsigned::bigEndian);
+		encryption_stream << _rsa_utils::block_to_hex(block) << " ";
 	}
 
 	std::string encrypted_message(encryption_stream.str());
 	return encrypted_message;
 }
 
+std::string rsa_encrypter::from_legacy_text(const std::string& text, uint64_t block_size)
+{
+	std::stringstream encryption_stream(text);
+	std::string ciphertext;
+
+	std::string encoded_block_string;
+	while (encryption_stream >> encoded_block_string)
+	{
+		const big_unsigned block = _rsa_utils::hex_to_block(encoded_block_string);
+		if (big_unsigned_bytes_count(block) > block_size)
+		{
+			throw invalid_message();
+		}
+
+		ciphertext += big_unsigned_to_bytes(block, block_size);
+	}
+
+	return ciphertext;
+}
+
 std::string rsa_encrypter::decrypt(const std::string& message) const
 {
-	auto [d, module] = _rsa_utils::string_to_key(_private_key);
+	return decrypt(_rsa_utils::to_bytes(message.data()), message.size());
+}
+
+std::string rsa_encrypter::decrypt(const uint8_t* ciphertext, size_t size) const
+{
+	return _decrypt(*_private_key, ciphertext, size);
+}
+
+std::vector<std::string> rsa_encrypter::decrypt_batch(const std::vector<std::string>& messages, thread_pool& pool) const
+{
+	const std::vector<const rsa_private_key*> keys = _get_worker_keys(std::min<uint64_t>(messages.size(), pool.get_threads_count()));
 
-	std::stringstream encryption_stream(message);
-	std::string decrypted_message;
+	std::vector<std::string> decrypted(messages.size());
+	pool.parallel_for_chunks(messages.size(), [&](uint64_t chunk, uint64_t begin, uint64_t end)
+	{
+		for (uint64_t i = begin; i < end; ++i)
+		{
+			decrypted[i] = _decrypt(*keys[chunk], _rsa_utils::to_bytes(messages[i].data()), messages[i].size());
+		}
+	});
 
-	std::string encoded_symbol_string;
+	return decrypted;
+}
 
-	while (encryption_stream >> encoded_symbol_string)
+std::string rsa_encrypter::_decrypt(const rsa_private_key& key, const uint8_t* ciphertext, size_t size)
+{
+	const big_unsigned& module = key.get_module();
+	const uint64_t block_size = _rsa_utils::get_block_size(module);
+	const uint64_t encrypted_block_size = block_size + 1;
+	if (size == 0 || size % encrypted_block_size != 0)
 	{
-		uint64_t decrypted_symbol = std::stoi(encoded_symbol_string, nullptr, 16);
-		decrypted_symbol = _rsa_utils::exp_by_module(decrypted_symbol, d, module);
-		decrypted_message += static_cast<char>(decrypted_symbol);
+		throw invalid_message();
 	}
-	
+
+	const uint64_t blocks_count = size / encrypted_block_size;
+	std::string decrypted_message(blocks_count * block_size, '\0');
+	for (uint64_t i = 0; i < blocks_count; ++i)
+	{
+		const big_unsigned encrypted_block(ciphertext + i * encrypted_block_size, encrypted_block_size, big_unsigned::bigEndian);
+		if (encrypted_block >= module)
+		{
+			throw invalid_message();
+		}
+
+		key.decrypt_block(encrypted_block).toBytes(
+			_rsa_utils::to_bytes(&decrypted_message[i * block_size]), block_size, big_unsigned::bigEndian);
+	}
+
+	// strips the zeros and the marker appended by encrypt
+	const size_t marker = decrypted_message.find_last_not_of('\0');
+	if (marker == std::string::npos || static_cast<uint8_t>(decrypted_message[marker]) != PADDING_MARKER)
+	{
+		throw invalid_message();
+	}
+	decrypted_message.resize(marker);
+
 	return decrypted_message;
 }
 
@@ -154,23 +230,62 @@ const std::string& rsa_encrypter::get_public_key() const
 	return _public_key;
 }
 
-void rsa_encrypter::_generate_keys()
+uint64_t rsa_encrypter::get_key_bits() const
 {
-	uint64_t _p = _rsa_utils::generate_prime_number(MIN_PRIME_VALUE, MAX_PRIME_VALUE);
-	uint64_t _q = _rsa_utils::generate_prime_number(MIN_PRIME_VALUE, MAX_PRIME_VALUE, _p);
+	return _private_key->get_module().bitLength();
+}
 
-	uint64_t module = _p * _q;
-	uint64_t theta = (_p - 1) * (_q - 1);
+uint64_t rsa_encrypter::get_ciphertext_block_size() const
+{
+	return big_unsigned_bytes_count(_private_key->get_module());
+}
+
+const rsa_private_key& rsa_encrypter::get_private_key() const
+{
+	return *_private_key;
+}
 
-	uint64_t key_exp = _rsa_utils::generate_coprime_number(MIN_PRIME_VALUE, theta);
+void rsa_encrypter::_generate_keys(uint64_t key_bits)
+{
+	const big_unsigned p = _rsa_utils::generate_prime_number(key_bits - key_bits / 2);
+	const big_unsigned q = _rsa_utils::generate_prime_number(key_bits / 2, p);
+	const big_unsigned key_exp(static_cast<unsigned long>(RSA_PUBLIC_EXPONENT));
 
-	int64_t d = 0, y_k = 0;
-	_rsa_utils::extended_gcd(key_exp, theta, d, y_k);
+	_private_key = std::make_unique<rsa_private_key>(p, q, key_exp);
+
+	const big_unsigned& module = _private_key->get_module();
+	_public_key = big_unsigned_to_bytes(module, big_unsigned_bytes_count(module)) +
+		big_unsigned_to_bytes(key_exp, PUBLIC_EXPONENT_SIZE);
+}
+
+std::vector<const rsa_private_key*> rsa_encrypter::_get_worker_keys(uint64_t count) const
+{
+	std::lock_guard<std::mutex> lock(_worker_keys_mutex);
+	while (_worker_keys.size() < count)
+	{
+		_worker_keys.push_back(std::make_unique<rsa_private_key>(*_private_key));
+	}
 
-	if (d < 0) {
-		d += theta;
+	std::vector<const rsa_private_key*> keys;
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		keys.push_back(_worker_keys[i].get());
 	}
 
-	_public_key = _rsa_utils::key_to_string(key_exp, module);
-	_private_key = _rsa_utils::key_to_string(d, module);
+	return keys;
+}
+
+const char* rsa_encrypter::invalid_key_size::what() const throw ()
+{
+	return "RSA key should be no less than MIN_RSA_KEY_BITS bits!";
+}
+
+const char* rsa_encrypter::invalid_key::what() const throw ()
+{
+	return "Public key has invalid size, even module or invalid exponent!";
+}
+
+const char* rsa_encrypter::invalid_message::what() const throw ()
+{
+	return "Ciphertext was not produced with this key!";
 }
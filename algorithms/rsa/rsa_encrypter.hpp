@@ -2,23 +2,82 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 
+#include "big_integer.hpp"
+#include "thread_pool.hpp"
+#include "rsa_private_key.hpp"
+
+constexpr uint64_t RSA_2048_KEY_BITS = 2048;
+constexpr uint64_t RSA_3072_KEY_BITS = 3072;
+constexpr uint64_t RSA_4096_KEY_BITS = 4096;
+constexpr uint64_t DEFAULT_RSA_KEY_BITS = RSA_2048_KEY_BITS;
+// the smallest module still leaves a byte of message per block, meant for tests only
+constexpr uint64_t MIN_RSA_KEY_BITS = 64;
+
+constexpr uint64_t RSA_PUBLIC_EXPONENT = 65537;
+
+/*
+  RSA on the bigint layer with e = 65537 and CRT decryption. Messages are padded with 0x80 and zeros
+  to whole blocks one byte shorter than the module, every block is encrypted as a single integer.
+  Ciphertexts are those integers back to back, each big-endian and exactly the byte length of the
+  module. Public keys are n || e, big-endian, n taking the byte length of the module and e four bytes
+*/
 class rsa_encrypter
 {
 public:
+	struct invalid_key_size : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct invalid_key : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct invalid_message : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
 	static std::string encrypt(const std::string& message, const std::string& key);
 
-	rsa_encrypter();
+	// the space-separated hex text ciphertexts used to be written as, one token per block;
+	// block_size is the byte length of the module, see get_ciphertext_block_size()
+	static std::string to_legacy_text(const std::string& ciphertext, uint64_t block_size);
+	static std::string from_legacy_text(const std::string& text, uint64_t block_size);
+
+	// key_bits is the exact bit length of the module, at least MIN_RSA_KEY_BITS
+	explicit rsa_encrypter(uint64_t key_bits = DEFAULT_RSA_KEY_BITS);
 	~rsa_encrypter() = default;
 
+	// throws invalid_message for a ciphertext that was not produced with this key
 	std::string decrypt(const std::string& message) const;
+	// reads the blocks straight from the buffer, without copying them out first
+	std::string decrypt(const uint8_t* ciphertext, size_t size) const;
+	// decrypts messages[i] on the pool, results keep the order of messages. Every worker decrypts with
+	// its own copy of the private key, made on first use and kept for later batches
+	std::vector<std::string> decrypt_batch(const std::vector<std::string>& messages, thread_pool& pool) const;
 	std::string encrypt(const std::string& message) const;
 
 	const std::string& get_public_key() const;
+	uint64_t get_key_bits() const;
+	uint64_t get_ciphertext_block_size() const;
+
+	const rsa_private_key& get_private_key() const;
 
 private:
-	void _generate_keys();
+	static std::string _decrypt(const rsa_private_key& key, const uint8_t* ciphertext, size_t size);
 
-	std::string _private_key;
+	void _generate_keys(uint64_t key_bits);
+	// the first count private key copies, creating the missing ones
+	std::vector<const rsa_private_key*> _get_worker_keys(uint64_t count) const;
+
+	std::unique_ptr<rsa_private_key> _private_key;
 	std::string _public_key;
+
+	mutable std::mutex _worker_keys_mutex;
+	mutable std::vector<std::unique_ptr<rsa_private_key>> _worker_keys;
 };
@@ -0,0 +1,91 @@
+#include "rsa_private_key.hpp"
+
+#include "prime_utils.hpp"
+
+rsa_private_key::rsa_private_key(const big_unsigned& p, const big_unsigned& q, const big_unsigned& public_exponent)
+	: _p(p)
+	, _q(q)
+	, _module(p * q)
+	, _public_exponent(public_exponent)
+	, _p_context(p)
+	, _q_context(q)
+	, _module_context(_module)
+{
+	const big_unsigned private_exponent = modinv(public_exponent, (p - 1) * (q - 1));
+	_dp = private_exponent % (p - 1);
+	_dq = private_exponent % (q - 1);
+	_q_inv = _p_context.to_montgomery(modinv(q, p));
+
+	_generate_blinding();
+}
+
+rsa_private_key::rsa_private_key(const rsa_private_key& other)
+	: _p(other._p)
+	, _q(other._q)
+	, _module(other._module)
+	, _public_exponent(other._public_exponent)
+	, _dp(other._dp)
+	, _dq(other._dq)
+	, _p_context(other._p_context)
+	, _q_context(other._q_context)
+	, _module_context(other._module_context)
+	, _q_inv(other._q_inv)
+{
+	_generate_blinding();
+}
+
+big_unsigned rsa_private_key::decrypt_block(const big_unsigned& block) const
+{
+	big_unsigned blinding;
+	big_unsigned unblinding;
+	{
+		std::lock_guard<std::mutex> lock(_blinding_mutex);
+		blinding = _blinding;
+		unblinding = _unblinding;
+
+		// (r^2)^e and (r^2)^-1, so no pair is used twice
+		_blinding = _module_context.square(_blinding);
+		_unblinding = _module_context.square(_unblinding);
+	}
+
+	// a plain value times a montgomery one comes out plain
+	const big_unsigned blinded = _module_context.multiply(block, blinding);
+	return _module_context.multiply(decrypt_block_unblinded(blinded), unblinding);
+}
+
+big_unsigned rsa_private_key::decrypt_block_unblinded(const big_unsigned& block) const
+{
+	// two half-size exponentiations instead of one modulo n, joined by Garner's formula
+	const big_unsigned m_p = _p_context.exp(block % _p, _dp);
+	const big_unsigned m_q = _q_context.exp(block % _q, _dq);
+
+	const big_unsigned m_q_mod_p = m_q < _p ? m_q : m_q % _p;
+	const big_unsigned difference = m_p >= m_q_mod_p ? m_p - m_q_mod_p : m_p + _p - m_q_mod_p;
+	const big_unsigned h = _p_context.multiply(difference, _q_inv);
+
+	return m_q + h * _q;
+}
+
+void rsa_private_key::_generate_blinding()
+{
+	// the only inverse modulo n a key ever computes; a random r below n shares no factor with it
+	// unless it hit a multiple of p or q
+	big_unsigned r;
+	do
+	{
+		r = prime_utils::generate_prime_candidate(_module.bitLength() - 1);
+	} while (r % _p == 0 || r % _q == 0);
+
+	_blinding = _module_context.to_montgomery(_module_context.exp(r, _public_exponent));
+	_unblinding = _module_context.to_montgomery(modinv(r, _module));
+}
+
+const big_unsigned& rsa_private_key::get_module() const
+{
+	return _module;
+}
+
+const big_unsigned& rsa_private_key::get_public_exponent() const
+{
+	return _public_exponent;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mutex>
+
+#include "big_integer.hpp"
+#include "montgomery_context.hpp"
+
+/*
+  RSA private key with everything a decryption needs precomputed once: the CRT exponents, q^-1 mod p
+  and montgomery contexts for p, q and n. Decryptions are blinded: the block is multiplied by r^e
+  before the exponentiation and the result by r^-1 after it, so the timing of the private exponent
+  never depends on the ciphertext alone. The pair is renewed by squaring both halves after every use,
+  two multiplications mod n instead of a fresh inverse; the mutex only guards taking and renewing it
+*/
+class rsa_private_key
+{
+public:
+	// p and q distinct primes, public_exponent coprime to both p - 1 and q - 1
+	rsa_private_key(const big_unsigned& p, const big_unsigned& q, const big_unsigned& public_exponent);
+	~rsa_private_key() = default;
+
+	// copies the precomputation but draws its own blinding pair, so copies never blind alike and each
+	// thread can decrypt with one of them without touching the others' mutex
+	rsa_private_key(const rsa_private_key& other);
+	rsa_private_key& operator = (const rsa_private_key&) = delete;
+
+	// block^d mod n for a block below the module
+	big_unsigned decrypt_block(const big_unsigned& block) const;
+	// the same without blinding, e.g. to measure what blinding costs
+	big_unsigned decrypt_block_unblinded(const big_unsigned& block) const;
+
+	const big_unsigned& get_module() const;
+	const big_unsigned& get_public_exponent() const;
+
+private:
+	void _generate_blinding();
+
+	big_unsigned _p;
+	big_unsigned _q;
+	big_unsigned _module;
+	big_unsigned _public_exponent;
+
+	// d mod (p - 1), d mod (q - 1)
+	big_unsigned _dp;
+	big_unsigned _dq;
+
+	montgomery_context _p_context;
+	montgomery_context _q_context;
+	montgomery_context _module_context;
+
+	// q^-1 mod p in montgomery form modulo p
+	big_unsigned _q_inv;
+
+	// r^e and r^-1 in montgomery form modulo n
+	mutable std::mutex _blinding_mutex;
+	mutable big_unsigned _blinding;
+	mutable big_unsigned _unblinding;
+};
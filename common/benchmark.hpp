@@ -0,0 +1,60 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace benchmark
+{
+	// Runs func iterations_count times, prints the throughput and returns the elapsed seconds
+	template <typename Func>
+	double measure(const std::string& name, uint64_t iterations_count, Func&& func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < iterations_count; ++i)
+		{
+			func();
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		const double seconds = elapsed.count();
+		std::cerr << name << ": " << iterations_count << " ops in " << seconds * 1000.0 << " ms, "
+			<< iterations_count / seconds << " ops/sec" << std::endl;
+
+		return seconds;
+	}
+
+	// Runs func iterations_count times and returns the seconds each run took
+	template <typename Func>
+	std::vector<double> sample(uint64_t iterations_count, Func&& func)
+	{
+		std::vector<double> samples;
+		samples.reserve(iterations_count);
+		for (uint64_t i = 0; i < iterations_count; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			func();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			samples.push_back(elapsed.count());
+		}
+
+		return samples;
+	}
+
+	// Nearest-rank percentile, rank in [0, 100]; 0 for no samples
+	inline double percentile(std::vector<double> samples, double rank)
+	{
+		if (samples.empty())
+		{
+			return 0;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		const size_t position = static_cast<size_t>(std::ceil(rank / 100.0 * static_cast<double>(samples.size())));
+
+		return samples[std::min(std::max<size_t>(position, 1), samples.size()) - 1];
+	}
+}
\ No newline at end of file
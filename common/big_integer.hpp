@@ -1,6 +1,27 @@
 #pragma once
 
 #include "BigIntegerLibrary.hh"
+#include <string>
 
 using big_unsigned = BigUnsigned;
 using big_integer = BigInteger;
+
+// big-endian bytes of value, left-padded with zeros to size; higher bytes that do not fit are dropped
+inline std::string big_unsigned_to_bytes(const big_unsigned& value, size_t size)
+{
+	std::string bytes(size, '\0');
+	value.toBytes(reinterpret_cast<unsigned char*>(&bytes[0]), size, big_unsigned::bigEndian);
+
+	return bytes;
+}
+
+// reads big-endian bytes
+inline big_unsigned bytes_to_big_unsigned(const std::string& bytes)
+{
+	return big_unsigned(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size(), big_unsigned::bigEndian);
+}
+
+inline size_t big_unsigned_bytes_count(const big_unsigned& value)
+{
+	return (value.bitLength() + CHAR_BIT - 1) / CHAR_BIT;
+}
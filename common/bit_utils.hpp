@@ -1,6 +1,7 @@
 #pragma once
 
 #include <bitset>
+#include <string>
 
 
 namespace bit_utils
@@ -56,6 +57,45 @@ namespace bit_utils
 		return result;
 	}
 
+	// lowercase hex of raw bytes, for printing binary keys and signatures
+	inline std::string to_hex(const std::string& bytes)
+	{
+		const char digits[] = "0123456789abcdef";
+
+		std::string result;
+		result.reserve(bytes.size() * 2);
+		for (char byte : bytes)
+		{
+			result += digits[static_cast<uint8_t>(byte) >> 4];
+			result += digits[static_cast<uint8_t>(byte) & 0x0f];
+		}
+
+		return result;
+	}
+
+	// raw bytes of a hex string of either case, for known-answer test vectors; an odd trailing digit is ignored
+	inline std::string from_hex(const std::string& hex)
+	{
+		auto digit = [](char c) -> uint8_t
+		{
+			if (c >= '0' && c <= '9')
+			{
+				return static_cast<uint8_t>(c - '0');
+			}
+
+			return static_cast<uint8_t>((c | 0x20) - 'a' + 10);
+		};
+
+		std::string result;
+		result.reserve(hex.size() / 2);
+		for (size_t i = 0; i + 1 < hex.size(); i += 2)
+		{
+			result += static_cast<char>((digit(hex[i]) << 4) | digit(hex[i + 1]));
+		}
+
+		return result;
+	}
+
 	inline uint8_t* stob(const std::string& str)
 	{
 		return reinterpret_cast<uint8_t*>(const_cast<char*>(str.data()));
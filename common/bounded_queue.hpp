@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/*
+  Fixed-capacity queue for any number of producers and consumers without locks (Vyukov's ring
+  buffer). Every cell carries a sequence number telling whether it waits for a push or a pop of the
+  current lap, so a thread claims a position with one compare-exchange and then owns the cell.
+  The capacity is rounded up to a power of two
+*/
+template <typename T>
+class bounded_queue
+{
+public:
+	explicit bounded_queue(uint64_t capacity)
+		: _mask(_round_capacity(capacity) - 1)
+		, _cells(new _cell[_mask + 1])
+	{
+		for (uint64_t i = 0; i <= _mask; ++i)
+		{
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	~bounded_queue() = default;
+
+	bounded_queue(const bounded_queue&) = delete;
+	bounded_queue& operator = (const bounded_queue&) = delete;
+
+	// false when the queue is full, value is left untouched then
+	bool try_push(T&& value)
+	{
+		uint64_t position = _push_position.load(std::memory_order_relaxed);
+		while (true)
+		{
+			_cell& cell = _cells[position & _mask];
+			const uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const int64_t lag = static_cast<int64_t>(sequence - position);
+			if (lag == 0)
+			{
+				if (_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.value = std::move(value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (lag < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = _push_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// false when the queue is empty
+	bool try_pop(T& value)
+	{
+		uint64_t position = _pop_position.load(std::memory_order_relaxed);
+		while (true)
+		{
+			_cell& cell = _cells[position & _mask];
+			const uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const int64_t lag = static_cast<int64_t>(sequence - (position + 1));
+			if (lag == 0)
+			{
+				if (_pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.value);
+					cell.sequence.store(position + _mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (lag < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = _pop_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// a snapshot, exact only while no other thread pushes or pops
+	uint64_t size() const
+	{
+		const uint64_t pop_position = _pop_position.load(std::memory_order_acquire);
+		const uint64_t push_position = _push_position.load(std::memory_order_acquire);
+		return push_position > pop_position ? push_position - pop_position : 0;
+	}
+
+	uint64_t get_capacity() const
+	{
+		return _mask + 1;
+	}
+
+private:
+	struct _cell
+	{
+		std::atomic<uint64_t> sequence;
+		T value;
+	};
+
+	static uint64_t _round_capacity(uint64_t capacity)
+	{
+		uint64_t rounded = 1;
+		while (rounded < capacity)
+		{
+			rounded <<= 1;
+		}
+
+		return rounded;
+	}
+
+	const uint64_t _mask;
+	std::unique_ptr<_cell[]> _cells;
+
+	// on separate cache lines, producers and consumers do not invalidate each other's position
+	alignas(64) std::atomic<uint64_t> _push_position{ 0 };
+	alignas(64) std::atomic<uint64_t> _pop_position{ 0 };
+};
@@ -0,0 +1,207 @@
+#include "cpu_features.hpp"
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(CRYPTO_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace _cpu_utils
+{
+	struct features
+	{
+		bool sse41 = false;
+		bool avx2 = false;
+		bool avx512 = false;
+	};
+
+	const char* const ISA_NAMES[cpu_features::ISA_COUNT] = { "scalar", "sse4.1", "avx2", "avx512" };
+
+#if defined(CRYPTO_X86)
+	// eax, ebx, ecx, edx of cpuid leaf with subleaf
+	void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+	{
+#if defined(_MSC_VER)
+		int values[4];
+		__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i = 0; i < 4; ++i)
+		{
+			registers[i] = static_cast<uint32_t>(values[i]);
+		}
+#else
+		__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	uint64_t xgetbv()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		uint32_t low = 0, high = 0;
+		__asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+	}
+
+	features detect()
+	{
+		features detected;
+
+		uint32_t registers[4] = {};
+		cpuid(0, 0, registers);
+		const uint32_t max_leaf = registers[0];
+		if (max_leaf < 1)
+		{
+			return detected;
+		}
+
+		cpuid(1, 0, registers);
+		const bool ssse3 = (registers[2] >> 9) & 1;
+		const bool sse41 = (registers[2] >> 19) & 1;
+		const bool osxsave = (registers[2] >> 27) & 1;
+		const bool avx = (registers[2] >> 28) & 1;
+		const uint64_t saved_state = osxsave ? xgetbv() : 0;
+		// xmm and ymm state enabled by the operating system, then the opmask and the two zmm halves
+		const bool ymm_saved = (saved_state & 0x6) == 0x6;
+		const bool zmm_saved = ymm_saved && (saved_state & 0xe0) == 0xe0;
+
+		detected.sse41 = ssse3 && sse41;
+
+		// avx2 and avx-512 are reported in leaf 7 only
+		if (max_leaf < 7)
+		{
+			return detected;
+		}
+
+		cpuid(7, 0, registers);
+		const bool avx2 = (registers[1] >> 5) & 1;
+		const bool bmi2 = (registers[1] >> 8) & 1;
+		const bool avx512f = (registers[1] >> 16) & 1;
+		const bool avx512bw = (registers[1] >> 30) & 1;
+
+		detected.avx2 = detected.sse41 && avx && ymm_saved && avx2 && bmi2;
+		detected.avx512 = detected.avx2 && zmm_saved && avx512f && avx512bw;
+
+		return detected;
+	}
+#else
+	features detect()
+	{
+		return features();
+	}
+#endif
+
+	// empty when the variable is not set
+	std::string get_environment(const char* name)
+	{
+#if defined(_MSC_VER)
+		// getenv is deprecated there
+		char* value = nullptr;
+		size_t size = 0;
+		if (_dupenv_s(&value, &size, name) != 0 || value == nullptr)
+		{
+			return std::string();
+		}
+
+		std::string result(value);
+		std::free(value);
+		return result;
+#else
+		const char* value = std::getenv(name);
+		return value != nullptr ? std::string(value) : std::string();
+#endif
+	}
+
+	// function-local static, so the first use from several threads detects exactly once
+	const features& get()
+	{
+		static const features detected = detect();
+		return detected;
+	}
+}
+
+namespace cpu_features
+{
+	const char* get_isa_name(isa level)
+	{
+		return _cpu_utils::ISA_NAMES[static_cast<uint32_t>(level)];
+	}
+
+	bool parse_isa(const std::string& name, isa& level)
+	{
+		for (uint32_t i = 0; i < ISA_COUNT; ++i)
+		{
+			if (name == _cpu_utils::ISA_NAMES[i])
+			{
+				level = static_cast<isa>(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool has_sse41()
+	{
+		return _cpu_utils::get().sse41;
+	}
+
+	bool has_avx2()
+	{
+		return _cpu_utils::get().avx2;
+	}
+
+	bool has_avx512()
+	{
+		return _cpu_utils::get().avx512;
+	}
+
+	bool is_supported(isa level)
+	{
+		switch (level)
+		{
+		case isa::scalar:
+			return true;
+		case isa::sse41:
+			return has_sse41();
+		case isa::avx2:
+			return has_avx2();
+		case isa::avx512:
+			return has_avx512();
+		}
+
+		return false;
+	}
+
+	isa get_isa()
+	{
+		// function-local static, read once like the features themselves
+		static const isa level = []()
+		{
+			isa best = isa::scalar;
+			for (uint32_t i = ISA_COUNT; i > 0; --i)
+			{
+				if (is_supported(static_cast<isa>(i - 1)))
+				{
+					best = static_cast<isa>(i - 1);
+					break;
+				}
+			}
+
+			isa requested = best;
+			if (parse_isa(_cpu_utils::get_environment("CRYPTO_ISA"), requested) && requested < best)
+			{
+				return requested;
+			}
+
+			return best;
+		}();
+
+		return level;
+	}
+}
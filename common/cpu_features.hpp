@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// x86 builds can carry kernels for vector extensions next to the portable ones
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CRYPTO_X86 1
+#endif
+
+/*
+  Instruction set extensions of the running CPU, read once with cpuid. An extension counts as
+  present only when the operating system also saves its registers on context switches (xgetbv)
+*/
+namespace cpu_features
+{
+	// kernel tiers, each one implying the ones below it
+	enum class isa
+	{
+		scalar = 0,
+		// SSE4.1 with SSSE3
+		sse41,
+		// AVX2 with BMI2
+		avx2,
+		// AVX-512 F and BW
+		avx512,
+	};
+
+	constexpr uint32_t ISA_COUNT = 4;
+
+	// names the CRYPTO_ISA environment variable takes: scalar, sse4.1, avx2, avx512
+	const char* get_isa_name(isa level);
+	// false and level untouched for an unknown name
+	bool parse_isa(const std::string& name, isa& level);
+
+	bool has_sse41();
+	bool has_avx2();
+	bool has_avx512();
+	bool is_supported(isa level);
+
+	// the highest tier this CPU supports, lowered to CRYPTO_ISA when that names a lower one;
+	// kernels dispatch on it unless a caller asks for a tier explicitly
+	isa get_isa();
+}
@@ -0,0 +1,84 @@
+#include "fixed_base_power_table.hpp"
+
+fixed_base_power_table::fixed_base_power_table(
+	const montgomery_context& context,
+	const big_unsigned& base,
+	uint64_t exponent_bits,
+	uint64_t memory_budget)
+	: _context(context)
+	, _base(base)
+	, _exponent_bits(exponent_bits)
+	, _window_bits(_pick_window_bits(context.get_module(), exponent_bits, memory_budget))
+	, _windows_count(_window_bits == 0 ? 0 : (exponent_bits + _window_bits - 1) / _window_bits)
+{
+	const uint64_t digits_count = (uint64_t(1) << _window_bits) - 1;
+	_table.reserve(_windows_count * digits_count);
+
+	// window_base == base^(2^(wj)), its powers fill the window and the last one times it starts the next
+	big_unsigned window_base = _context.to_montgomery(base);
+	for (uint64_t j = 0; j < _windows_count; ++j)
+	{
+		_table.push_back(window_base);
+		for (uint64_t d = 1; d < digits_count; ++d)
+		{
+			_table.push_back(_context.multiply(_table.back(), window_base));
+		}
+
+		window_base = _context.multiply(_table.back(), window_base);
+	}
+}
+
+big_unsigned fixed_base_power_table::power(const big_unsigned& exponent) const
+{
+	if (_window_bits == 0 || exponent.bitLength() > _exponent_bits)
+	{
+		return _context.exp(_base, exponent);
+	}
+
+	const uint64_t digits_count = (uint64_t(1) << _window_bits) - 1;
+
+	big_unsigned result = _context.get_one();
+	for (uint64_t j = 0; j < _windows_count; ++j)
+	{
+		uint32_t digit = 0;
+		for (uint32_t i = _window_bits; i > 0; --i)
+		{
+			digit = (digit << 1) | (exponent.getBit(j * _window_bits + i - 1) ? 1 : 0);
+		}
+
+		// zero digits multiply by one, so the count of multiplications does not depend on the exponent
+		result = _context.multiply(result, digit == 0 ? _context.get_one() : _table[j * digits_count + digit - 1]);
+	}
+
+	return _context.from_montgomery(result);
+}
+
+uint32_t fixed_base_power_table::get_window_bits() const
+{
+	return _window_bits;
+}
+
+uint64_t fixed_base_power_table::get_memory_size() const
+{
+	return _window_bits == 0 ? 0 : get_memory_size(_context.get_module(), _exponent_bits, _window_bits);
+}
+
+uint64_t fixed_base_power_table::get_memory_size(const big_unsigned& module, uint64_t exponent_bits, uint32_t window_bits)
+{
+	const uint64_t windows_count = (exponent_bits + window_bits - 1) / window_bits;
+	const uint64_t powers_count = windows_count * ((uint64_t(1) << window_bits) - 1);
+
+	return powers_count * (sizeof(big_unsigned) + module.getLength() * sizeof(big_unsigned::Blk));
+}
+
+uint32_t fixed_base_power_table::_pick_window_bits(const big_unsigned& module, uint64_t exponent_bits, uint64_t memory_budget)
+{
+	uint32_t window_bits = 0;
+	while (window_bits < MAX_POWER_TABLE_WINDOW_BITS &&
+		get_memory_size(module, exponent_bits, window_bits + 1) <= memory_budget)
+	{
+		++window_bits;
+	}
+
+	return window_bits;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "big_integer.hpp"
+#include "montgomery_context.hpp"
+#include <vector>
+
+constexpr uint32_t MAX_POWER_TABLE_WINDOW_BITS = 12;
+constexpr uint64_t DEFAULT_POWER_TABLE_BYTES = 1 << 20;
+
+/*
+  Fixed-base windowed powers: for every window j of the exponent it keeps base^(d * 2^(wj)) in
+  montgomery form for all digits d in [1, 2^w). An exponentiation then takes one multiplication per
+  window, zero digits included, and no squarings at all. The window is the widest one whose
+  (2^w - 1) * bits / w powers fit the memory budget
+*/
+class fixed_base_power_table
+{
+public:
+	// exponents of up to exponent_bits bits. When not even 1-bit windows fit memory_budget bytes the
+	// table stays empty, get_window_bits() is 0 and every power goes through montgomery_context::exp
+	fixed_base_power_table(
+		const montgomery_context& context,
+		const big_unsigned& base,
+		uint64_t exponent_bits,
+		uint64_t memory_budget = DEFAULT_POWER_TABLE_BYTES);
+	~fixed_base_power_table() = default;
+
+	// plain base ^ exponent % module; exponents wider than exponent_bits fall back to montgomery_context::exp
+	big_unsigned power(const big_unsigned& exponent) const;
+
+	uint32_t get_window_bits() const;
+	// bytes taken by the stored powers
+	uint64_t get_memory_size() const;
+
+	// bytes the powers of window_bits wide windows would take
+	static uint64_t get_memory_size(const big_unsigned& module, uint64_t exponent_bits, uint32_t window_bits);
+
+private:
+	static uint32_t _pick_window_bits(const big_unsigned& module, uint64_t exponent_bits, uint64_t memory_budget);
+
+	montgomery_context _context;
+	big_unsigned _base;
+	uint64_t _exponent_bits;
+	uint32_t _window_bits;
+	uint64_t _windows_count;
+
+	// _table[j * (2^w - 1) + d - 1] == base^(d * 2^(wj)) in montgomery form
+	std::vector<big_unsigned> _table;
+};
@@ -0,0 +1,117 @@
+#include "cpu_features.hpp"
+#include "gost_kernel.hpp"
+
+#if defined(CRYPTO_X86)
+#include <immintrin.h>
+
+// everything defined below may use avx2; the scalar inline functions of gost_kernel.hpp are included
+// above, so the copies other files link against never get compiled for avx2
+#if defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+namespace
+{
+	// 4 blocks of 8 bytes to their 8 32-bit halves, each read big-endian
+	inline __m256i load_halves(const uint8_t* bytes)
+	{
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		return _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes)), swap);
+	}
+
+	inline void store_halves(__m256i halves, uint8_t* bytes)
+	{
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes), _mm256_shuffle_epi8(halves, swap));
+	}
+
+	// first halves of blocks 0, 1, 4, 5, 2, 3, 6, 7 in first, the second ones in second
+	inline void load_block_halves(const uint8_t* bytes, __m256i& first, __m256i& second)
+	{
+		const __m256i low = load_halves(bytes);
+		const __m256i high = load_halves(bytes + 32);
+
+		first = _mm256_castps_si256(_mm256_shuffle_ps(
+			_mm256_castsi256_ps(low), _mm256_castsi256_ps(high), _MM_SHUFFLE(2, 0, 2, 0)));
+		second = _mm256_castps_si256(_mm256_shuffle_ps(
+			_mm256_castsi256_ps(low), _mm256_castsi256_ps(high), _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	// first || second per block, interleaving undoes the lane order of load_block_halves
+	inline void store_block_halves(__m256i first, __m256i second, uint8_t* bytes)
+	{
+		store_halves(_mm256_unpacklo_epi32(first, second), bytes);
+		store_halves(_mm256_unpackhi_epi32(first, second), bytes + 32);
+	}
+
+	inline __m256i lookup(const uint32_t* table, __m256i indices)
+	{
+		return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), indices, 4);
+	}
+
+	inline __m256i round_function(__m256i half, __m256i key, const gost_round_tables& tables)
+	{
+		const __m256i byte_mask = _mm256_set1_epi32(0xff);
+		const __m256i sum = _mm256_add_epi32(half, key);
+
+		const __m256i first = lookup(tables.bytes[0], _mm256_srli_epi32(sum, 24));
+		const __m256i second = lookup(tables.bytes[1], _mm256_and_si256(_mm256_srli_epi32(sum, 16), byte_mask));
+		const __m256i third = lookup(tables.bytes[2], _mm256_and_si256(_mm256_srli_epi32(sum, 8), byte_mask));
+		const __m256i fourth = lookup(tables.bytes[3], _mm256_and_si256(sum, byte_mask));
+
+		return _mm256_xor_si256(_mm256_xor_si256(first, second), _mm256_xor_si256(third, fourth));
+	}
+
+	// groups_count groups of lanes per call, so the gathers of one hide the latency of the others'
+	template <uint32_t groups_count>
+	inline void crypt_groups(const uint8_t* input, uint8_t* output, const __m256i round_keys[32], const gost_round_tables& tables)
+	{
+		__m256i a[groups_count], b[groups_count];
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			load_block_halves(input + group * GOST_AVX2_LANES * 8, a[group], b[group]);
+		}
+
+		for (uint32_t round = 0; round < 32; ++round)
+		{
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				const __m256i new_a = _mm256_xor_si256(b[group], round_function(a[group], round_keys[round], tables));
+				b[group] = a[group];
+				a[group] = new_a;
+			}
+		}
+
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			store_block_halves(b[group], a[group], output + group * GOST_AVX2_LANES * 8);
+		}
+	}
+}
+
+void gost_crypt_blocks_avx2(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables)
+{
+	__m256i round_keys[32];
+	for (uint32_t round = 0; round < 32; ++round)
+	{
+		round_keys[round] = _mm256_set1_epi32(static_cast<int>(keys[round]));
+	}
+
+	uint64_t block = 0;
+	for (; block + 2 * GOST_AVX2_LANES <= blocks_count; block += 2 * GOST_AVX2_LANES)
+	{
+		crypt_groups<2>(input + block * 8, output + block * 8, round_keys, tables);
+	}
+	for (; block + GOST_AVX2_LANES <= blocks_count; block += GOST_AVX2_LANES)
+	{
+		crypt_groups<1>(input + block * 8, output + block * 8, round_keys, tables);
+	}
+
+	gost_crypt_blocks(input + block * 8, output + block * 8, blocks_count - block, keys, tables);
+}
+#endif
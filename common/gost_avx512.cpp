@@ -0,0 +1,121 @@
+#include "cpu_features.hpp"
+#include "gost_kernel.hpp"
+
+#if defined(CRYPTO_X86)
+// gcc 12 flags the deliberately undefined registers inside its own avx-512 intrinsics (bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+// everything defined below may use avx-512; the scalar inline functions of gost_kernel.hpp are included
+// above, so the copies other files link against never get compiled for avx-512
+#if defined(__GNUC__)
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+namespace
+{
+	// 8 blocks of 8 bytes to their 16 32-bit halves, each read big-endian
+	inline __m512i load_halves(const uint8_t* bytes)
+	{
+		const __m512i swap = _mm512_set4_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203);
+		return _mm512_shuffle_epi8(_mm512_loadu_si512(bytes), swap);
+	}
+
+	inline void store_halves(__m512i halves, uint8_t* bytes)
+	{
+		const __m512i swap = _mm512_set4_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203);
+		_mm512_storeu_si512(bytes, _mm512_shuffle_epi8(halves, swap));
+	}
+
+	// first halves of 16 blocks in order in first, the second ones in second
+	inline void load_block_halves(const uint8_t* bytes, __m512i& first, __m512i& second)
+	{
+		const __m512i low = load_halves(bytes);
+		const __m512i high = load_halves(bytes + 64);
+
+		const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+		const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+		first = _mm512_permutex2var_epi32(low, even, high);
+		second = _mm512_permutex2var_epi32(low, odd, high);
+	}
+
+	// first || second per block
+	inline void store_block_halves(__m512i first, __m512i second, uint8_t* bytes)
+	{
+		const __m512i low = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+		const __m512i high = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+		store_halves(_mm512_permutex2var_epi32(first, low, second), bytes);
+		store_halves(_mm512_permutex2var_epi32(first, high, second), bytes + 64);
+	}
+
+	inline __m512i lookup(const uint32_t* table, __m512i indices)
+	{
+		return _mm512_i32gather_epi32(indices, table, 4);
+	}
+
+	inline __m512i round_function(__m512i half, __m512i key, const gost_round_tables& tables)
+	{
+		const __m512i byte_mask = _mm512_set1_epi32(0xff);
+		const __m512i sum = _mm512_add_epi32(half, key);
+
+		const __m512i first = lookup(tables.bytes[0], _mm512_srli_epi32(sum, 24));
+		const __m512i second = lookup(tables.bytes[1], _mm512_and_si512(_mm512_srli_epi32(sum, 16), byte_mask));
+		const __m512i third = lookup(tables.bytes[2], _mm512_and_si512(_mm512_srli_epi32(sum, 8), byte_mask));
+		const __m512i fourth = lookup(tables.bytes[3], _mm512_and_si512(sum, byte_mask));
+
+		// one three-way XOR (0x96) and one more
+		return _mm512_xor_si512(_mm512_ternarylogic_epi32(first, second, third, 0x96), fourth);
+	}
+
+	// groups_count groups of lanes per call, so the gathers of one hide the latency of the others'
+	template <uint32_t groups_count>
+	inline void crypt_groups(const uint8_t* input, uint8_t* output, const __m512i round_keys[32], const gost_round_tables& tables)
+	{
+		__m512i a[groups_count], b[groups_count];
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			load_block_halves(input + group * GOST_AVX512_LANES * 8, a[group], b[group]);
+		}
+
+		for (uint32_t round = 0; round < 32; ++round)
+		{
+			for (uint32_t group = 0; group < groups_count; ++group)
+			{
+				const __m512i new_a = _mm512_xor_si512(b[group], round_function(a[group], round_keys[round], tables));
+				b[group] = a[group];
+				a[group] = new_a;
+			}
+		}
+
+		for (uint32_t group = 0; group < groups_count; ++group)
+		{
+			store_block_halves(b[group], a[group], output + group * GOST_AVX512_LANES * 8);
+		}
+	}
+}
+
+void gost_crypt_blocks_avx512(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables)
+{
+	__m512i round_keys[32];
+	for (uint32_t round = 0; round < 32; ++round)
+	{
+		round_keys[round] = _mm512_set1_epi32(static_cast<int>(keys[round]));
+	}
+
+	uint64_t block = 0;
+	for (; block + 2 * GOST_AVX512_LANES <= blocks_count; block += 2 * GOST_AVX512_LANES)
+	{
+		crypt_groups<2>(input + block * 8, output + block * 8, round_keys, tables);
+	}
+	for (; block + GOST_AVX512_LANES <= blocks_count; block += GOST_AVX512_LANES)
+	{
+		crypt_groups<1>(input + block * 8, output + block * 8, round_keys, tables);
+	}
+
+	gost_crypt_blocks(input + block * 8, output + block * 8, blocks_count - block, keys, tables);
+}
+#endif
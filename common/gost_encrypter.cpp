@@ -1,26 +1,49 @@
 #include "gost_encrypter.hpp"
 #include <string>
+#include <cstring>
+#include <algorithm>
 
 #include "bit_utils.hpp"
+#include "kernel_table.hpp"
 
 constexpr uint32_t ROUNDS_COUNT = 32;
+// blocks of gamma made per kernel call, and the unit the pool splits a message in
+constexpr uint64_t GAMMA_BATCH_BLOCKS = 8 * GOST_AVX512_LANES;
 
-// id-tc26-gost-28147-param-Z id of S box
-const std::vector<std::vector<uint8_t>> S_BOX =
+namespace _gost_utils
 {
-	{13, 4, 6, 2, 11, 5, 12, 9, 15, 8, 14, 7, 0, 3, 0, 1},
-	{6, 8, 2, 3, 9, 11, 5, 13, 1, 15, 4, 7, 12, 14, 0, 0},
-	{12, 3, 5, 8, 2, 0, 11, 14, 15, 1, 7, 4, 13, 9, 6, 0},
-	{13, 8, 2, 1, 14, 4, 0, 6, 7, 0, 11, 5, 3, 15, 9, 12},
-	{7, 0, 5, 11, 8, 1, 6, 14, 0, 9, 3, 15, 12, 4, 2, 13},
-	{5, 14, 0, 6, 9, 2, 13, 11, 12, 7, 8, 1, 4, 3, 15, 0},
-	{8, 15, 2, 5, 6, 9, 1, 13, 0, 4, 12, 0, 14, 11, 3, 7},
-	{1, 7, 15, 14, 0, 5, 8, 3, 4, 0, 11, 6, 9, 13, 12, 2},
-};
+#if defined(CRYPTO_X86)
+	constexpr kernel_table<gost_crypt_function> CRYPT_KERNELS =
+	{
+		{ gost_crypt_blocks, nullptr, gost_crypt_blocks_avx2, gost_crypt_blocks_avx512 },
+	};
+#else
+	constexpr kernel_table<gost_crypt_function> CRYPT_KERNELS = { { gost_crypt_blocks } };
+#endif
+}
 
-gost_encrypter::gost_encrypter(const std::string& key)
-	: _key(_check_key(key))
+std::vector<cpu_features::isa> gost_encrypter::get_kernels()
 {
+	return _gost_utils::CRYPT_KERNELS.get_supported();
+}
+
+gost_encrypter::gost_encrypter(const std::string& key, cpu_features::isa level)
+	: gost_encrypter(key, gost_param_set::legacy, level)
+{
+}
+
+gost_encrypter::gost_encrypter(const std::string& key, gost_param_set set, cpu_features::isa level)
+	: _kernel(_gost_utils::CRYPT_KERNELS.select(level))
+	, _crypt(_gost_utils::CRYPT_KERNELS.get(level))
+	, _set(set)
+	, _tables(&gost_get_round_tables(set))
+	, _key(_check_key(key))
+{
+	if (!cpu_features::is_supported(level))
+	{
+		throw unsupported_kernel();
+	}
+
 	_generate_keys();
 }
 
@@ -34,23 +57,140 @@ std::string gost_encrypter::decrypt(const std::string& message) const
 	return _internal_run(message, _e_action::decrypt);
 }
 
-std::vector<std::string> gost_encrypter::_build_message_blocks(const std::string& message)
+std::string gost_encrypter::crypt_ctr(const std::string& message, const std::string& iv) const
+{
+	_check_iv(iv);
+
+	uint64_t counter = 0;
+	for (char byte : iv)
+	{
+		counter = (counter << CHAR_BIT) | static_cast<uint8_t>(byte);
+	}
+
+	// keystream for a few kernel steps at a time
+	constexpr uint64_t batch_blocks = 8 * GOST_AVX512_LANES;
+	uint8_t keystream[batch_blocks * BLOCK_SIZE];
+
+	std::string output = message;
+	const uint64_t blocks_count = (message.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	for (uint64_t batch_begin = 0; batch_begin < blocks_count; batch_begin += batch_blocks)
+	{
+		const uint64_t batch_end = std::min(blocks_count, batch_begin + batch_blocks);
+		for (uint64_t block = batch_begin; block < batch_end; ++block)
+		{
+			// the counter wraps around modulo 2^64
+			uint64_t block_counter = counter + block;
+			for (uint32_t i = BLOCK_SIZE; i > 0; --i)
+			{
+				keystream[(block - batch_begin) * BLOCK_SIZE + i - 1] = static_cast<uint8_t>(block_counter);
+				block_counter >>= CHAR_BIT;
+			}
+		}
+
+		encrypt_blocks(keystream, keystream, batch_end - batch_begin);
+
+		// a block at a time, then the bytes of a partial last block
+		const uint64_t bytes_begin = batch_begin * BLOCK_SIZE;
+		const uint64_t bytes_end = std::min<uint64_t>(output.size(), batch_end * BLOCK_SIZE);
+		uint64_t i = bytes_begin;
+		for (; i + BLOCK_SIZE <= bytes_end; i += BLOCK_SIZE)
+		{
+			uint64_t data = 0, pad = 0;
+			std::memcpy(&data, &output[i], BLOCK_SIZE);
+			std::memcpy(&pad, keystream + i - bytes_begin, BLOCK_SIZE);
+			data ^= pad;
+			std::memcpy(&output[i], &data, BLOCK_SIZE);
+		}
+		for (; i < bytes_end; ++i)
+		{
+			output[i] ^= keystream[i - bytes_begin];
+		}
+	}
+
+	return output;
+}
+
+std::string gost_encrypter::crypt_gamma(const std::string& message, const std::string& iv) const
+{
+	return _crypt_gamma(message, iv, nullptr);
+}
+
+std::string gost_encrypter::crypt_gamma(const std::string& message, const std::string& iv, thread_pool& pool) const
+{
+	return _crypt_gamma(message, iv, &pool);
+}
+
+std::string gost_encrypter::encrypt_cfb(const std::string& message, const std::string& iv) const
+{
+	_check_iv(iv);
+
+	// each gamma block needs the ciphertext before it
+	uint8_t gamma[BLOCK_SIZE];
+	std::memcpy(gamma, iv.data(), BLOCK_SIZE);
+
+	std::string output = message;
+	for (uint64_t i = 0; i < output.size(); i += BLOCK_SIZE)
+	{
+		encrypt_blocks(gamma, gamma, 1);
+
+		const uint64_t block_size = std::min<uint64_t>(BLOCK_SIZE, output.size() - i);
+		for (uint64_t j = 0; j < block_size; ++j)
+		{
+			output[i + j] ^= gamma[j];
+			gamma[j] = static_cast<uint8_t>(output[i + j]);
+		}
+	}
+
+	return output;
+}
+
+std::string gost_encrypter::decrypt_cfb(const std::string& message, const std::string& iv) const
 {
-	std::vector<std::string> blocks;
-	size_t blocks_count = message.size() / BLOCK_SIZE;
-	blocks.reserve(blocks_count);
-	for (uint32_t i = 0; i < blocks_count; ++i)
+	_check_iv(iv);
+
+	if (message.empty())
+	{
+		return message;
+	}
+
+	// the gamma is E(iv || every full ciphertext block but the last), all known up front
+	const uint64_t blocks_count = (message.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	std::string gamma = iv + message.substr(0, (blocks_count - 1) * BLOCK_SIZE);
+	encrypt_blocks(bit_utils::stob(gamma), bit_utils::stob(gamma), blocks_count);
+
+	std::string output = message;
+	for (uint64_t i = 0; i < output.size(); ++i)
 	{
-		blocks.push_back(message.substr(static_cast<size_t>(i) * BLOCK_SIZE, BLOCK_SIZE));
+		output[i] ^= gamma[i];
 	}
 
-	return blocks;
+	return output;
+}
+
+void gost_encrypter::encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt_blocks(input, output, blocks_count, _generated_keys.data());
+}
+
+void gost_encrypter::decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const
+{
+	_crypt_blocks(input, output, blocks_count, _reversed_keys.data());
+}
+
+cpu_features::isa gost_encrypter::get_kernel() const
+{
+	return _kernel;
+}
+
+gost_param_set gost_encrypter::get_param_set() const
+{
+	return _set;
 }
 
 std::string gost_encrypter::_try_remove_padding(const std::string& message)
 {
-	char padding_size = message[message.size() - 1];
-	if (padding_size < BLOCK_SIZE)
+	uint8_t padding_size = message[message.size() - 1];
+	if (padding_size < static_cast<uint8_t>(BLOCK_SIZE))
 	{
 		return message.substr(0, message.size() - padding_size);
 	}
@@ -76,107 +216,122 @@ std::string gost_encrypter::_construct_padding_message(const std::string& messag
 
 void gost_encrypter::_generate_keys()
 {
-	_generated_keys.reserve(ROUNDS_COUNT);
-
-	auto key = bit_utils::bytes_to_bitset<KEY_LENGTH>(bit_utils::stob(_key));
-	auto subkeys = bit_utils::split_bitset<KEY_LENGTH, BLOCK_SIZE>(key);
+	// eight big-endian 32-bit subkeys, used k0..k7 three times and then k7..k0
+	std::vector<uint32_t> subkeys;
+	subkeys.reserve(KEY_LENGTH / 4);
+	for (uint64_t i = 0; i < KEY_LENGTH; i += 4)
+	{
+		subkeys.push_back(bit_utils::string_to_int32(_key.substr(i, 4)));
+	}
 
+	_generated_keys.reserve(ROUNDS_COUNT);
 	for (uint64_t i = 0; i < ROUNDS_COUNT - BLOCK_SIZE; ++i)
 	{
-		auto current_key = subkeys[i % BLOCK_SIZE];
-		_generated_keys.push_back(std::move(current_key));
+		_generated_keys.push_back(subkeys[i % BLOCK_SIZE]);
 	}
 
 	for (int64_t i = BLOCK_SIZE - 1; i >= 0; --i)
 	{
-		auto current_key = subkeys[i];
-		_generated_keys.push_back(std::move(current_key));
+		_generated_keys.push_back(subkeys[i]);
 	}
+
+	_reversed_keys.assign(_generated_keys.rbegin(), _generated_keys.rend());
 }
 
-std::bitset<HALF_BLOCK_SIZE_BITS> gost_encrypter::feistel_function(
-	const std::bitset<HALF_BLOCK_SIZE_BITS> & a_data,
-	const std::bitset<HALF_BLOCK_SIZE_BITS> & x_key) const
+void gost_encrypter::_crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count, const uint32_t keys[32]) const
 {
-	auto [overflow, mod_2_product] = bit_utils::add_mod_2<BLOCK_SIZE / 2>(a_data, x_key);
-	auto sequences = bit_utils::split_bitset<BLOCK_SIZE / 2, BLOCK_SIZE>(mod_2_product);
-	
-	std::bitset<HALF_BLOCK_SIZE_BITS> result_subs;
+	_crypt(input, output, blocks_count, keys, *_tables);
+}
 
-	for (uint64_t i = 0; i < BLOCK_SIZE; ++i)
+void gost_encrypter::_check_iv(const std::string& iv)
+{
+	if (iv.size() != BLOCK_SIZE)
 	{
-		const auto & sequence = sequences[i];
-		uint32_t s_input = 0b1000 * sequence[0] + 0b0100 * sequence[1] + 0b0010 * sequence[2] + 0b0001 * sequence[3];
-		std::bitset<BLOCK_SIZE / 2> s_output(S_BOX[i][s_input]);
-
-		for (uint64_t j = 0; j < BLOCK_SIZE / 2; ++j)
-		{
-			// default bitset conversion inversed, because of that we have to flip values
-			result_subs[i * BLOCK_SIZE / 2 + j] = s_output[BLOCK_SIZE / 2 - j - 1];
-		}
+		throw invalid_iv();
 	}
-
-	auto shifted_result = bit_utils::shift_bitset_cyclic<HALF_BLOCK_SIZE_BITS>(result_subs, 11);
-	return shifted_result;
 }
 
-std::string gost_encrypter::_internal_run(const std::string& message, _e_action action) const
+std::string gost_encrypter::_crypt_gamma(const std::string& message, const std::string& iv, thread_pool* pool) const
 {
-	std::string message_to_process = _construct_padding_message(message);
-	std::vector<std::string> source_blocks = _build_message_blocks(message_to_process);
-	std::vector<std::bitset<BLOCK_SIZE * CHAR_BIT>> result_blocks;
-	result_blocks.reserve(source_blocks.size());
-
-	for (const auto& block : source_blocks)
+	_check_iv(iv);
+
+	uint8_t counter[BLOCK_SIZE];
+	encrypt_blocks(reinterpret_cast<const uint8_t*>(iv.data()), counter, 1);
+	const std::string counter_bytes(reinterpret_cast<const char*>(counter), BLOCK_SIZE);
+	const uint32_t n1 = bit_utils::string_to_int32(counter_bytes);
+	const uint32_t n2 = bit_utils::string_to_int32(counter_bytes.substr(4));
+
+	std::string output = message;
+	const uint64_t blocks_count = (message.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const uint64_t batches_count = (blocks_count + GAMMA_BATCH_BLOCKS - 1) / GAMMA_BATCH_BLOCKS;
+	if (pool != nullptr && batches_count > 1)
 	{
-        auto&& encrypted_block = _encrypt_block(block, action);
-		result_blocks.push_back(std::move(encrypted_block));
+		pool->parallel_for_chunks(batches_count, [&](uint64_t, uint64_t begin, uint64_t end)
+		{
+			_crypt_gamma_range(n1, n2, output, begin * GAMMA_BATCH_BLOCKS, std::min(blocks_count, end * GAMMA_BATCH_BLOCKS));
+		});
 	}
-	
-	std::string result_message;
-	result_message.reserve(BLOCK_SIZE * result_blocks.size());
-	
-	for (const auto& block : result_blocks)
+	else
 	{
-		result_message += bit_utils::bitset_to_bytes<BLOCK_SIZE>(block);
+		_crypt_gamma_range(n1, n2, output, 0, blocks_count);
 	}
 
-	if (action == _e_action::decrypt)
-	{
-		result_message = _try_remove_padding(result_message);
-	}
-
-	return result_message;
+	return output;
 }
 
-std::bitset<BLOCK_SIZE * CHAR_BIT> gost_encrypter::_encrypt_block(const std::string& block, _e_action action) const
+void gost_encrypter::_crypt_gamma_range(uint32_t n1, uint32_t n2, std::string& output, uint64_t begin, uint64_t end) const
 {
-	auto bitset_block = bit_utils::bytes_to_bitset<BLOCK_SIZE>(bit_utils::stob(block));
+	// the state before block begin straight from E(iv), so any range can start on its own;
+	// n2 stays in 1..2^32 - 1 from the first step on, begin == 0 keeps it as it is
+	constexpr uint64_t modulus = 0xffffffff;
+	uint32_t first = n1 + static_cast<uint32_t>(begin) * GOST_GAMMA_C2;
+	uint32_t second = begin == 0 ? n2 :
+		static_cast<uint32_t>((n2 + modulus - 1 + begin % modulus * GOST_GAMMA_C1) % modulus + 1);
+
+	uint8_t gamma[GAMMA_BATCH_BLOCKS * BLOCK_SIZE];
+	for (uint64_t batch_begin = begin; batch_begin < end; batch_begin += GAMMA_BATCH_BLOCKS)
+	{
+		const uint64_t batch_end = std::min(end, batch_begin + GAMMA_BATCH_BLOCKS);
+		for (uint64_t block = batch_begin; block < batch_end; ++block)
+		{
+			// n2 + C1 with the carry added back in is (n2 + C1 - 1) mod (2^32 - 1) + 1
+			first += GOST_GAMMA_C2;
+			second += GOST_GAMMA_C1;
+			second += second < GOST_GAMMA_C1 ? 1 : 0;
+
+			uint8_t* counter = gamma + (block - batch_begin) * BLOCK_SIZE;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				counter[i] = static_cast<uint8_t>(first >> (24 - 8 * i));
+				counter[4 + i] = static_cast<uint8_t>(second >> (24 - 8 * i));
+			}
+		}
 
-	auto pair = bit_utils::split_bitset<BLOCK_SIZE>(bitset_block);
-	auto a_data = pair[0], b_data = pair[1];
+		encrypt_blocks(gamma, gamma, batch_end - batch_begin);
 
-	auto keys = _generated_keys;
-	switch (action)
-	{
-	case gost_encrypter::_e_action::decrypt:
-		std::reverse(keys.begin(), keys.end());
-		break;
-	default:
-		break;
+		const uint64_t bytes_begin = batch_begin * BLOCK_SIZE;
+		const uint64_t bytes_end = std::min<uint64_t>(output.size(), batch_end * BLOCK_SIZE);
+		for (uint64_t i = bytes_begin; i < bytes_end; ++i)
+		{
+			output[i] ^= gamma[i - bytes_begin];
+		}
 	}
+}
 
-	for (uint64_t i = 0; i < ROUNDS_COUNT; ++i)
-	{
-		auto new_A_data = b_data ^ feistel_function(a_data, keys[i]);
+std::string gost_encrypter::_internal_run(const std::string& message, _e_action action) const
+{
+	std::string result_message = _construct_padding_message(message);
+	uint8_t* data = bit_utils::stob(result_message);
+	const uint64_t blocks_count = result_message.size() / BLOCK_SIZE;
 
-		b_data = a_data;
-		a_data = new_A_data;
+	if (action == _e_action::decrypt)
+	{
+		decrypt_blocks(data, data, blocks_count);
+		return _try_remove_padding(result_message);
 	}
 
-	auto merged_bitset = bit_utils::merge_bitset<BLOCK_SIZE>(b_data, a_data);
-
-	return merged_bitset;
+	encrypt_blocks(data, data, blocks_count);
+	return result_message;
 }
 
 const char* gost_encrypter::invalid_key::what() const throw ()
@@ -184,6 +339,16 @@ const char* gost_encrypter::invalid_key::what() const throw ()
 	return "Invalid key! Key should be no less than 32 chars";
 }
 
+const char* gost_encrypter::invalid_iv::what() const throw ()
+{
+	return "Invalid initial counter block! It should be exactly 8 bytes";
+}
+
+const char* gost_encrypter::unsupported_kernel::what() const throw ()
+{
+	return "The CPU does not support the requested GOST kernel!";
+}
+
 const char* gost_encrypter::invalid_action::what() const throw ()
 {
 	return "Invalid action passed! Encrypt logical error";
@@ -4,9 +4,17 @@
 #include <vector>
 #include <bitset>
 
+#include "cpu_features.hpp"
+#include "gost_kernel.hpp"
+#include "gost_param_set.hpp"
+#include "thread_pool.hpp"
+
 constexpr uint32_t BLOCK_SIZE = 8;
 constexpr uint32_t KEY_LENGTH = 32;
 constexpr uint32_t HALF_BLOCK_SIZE_BITS = BLOCK_SIZE * CHAR_BIT / 2;
+// the constants the gamma mode adds to the two counter words, modulo 2^32 - 1 and 2^32
+constexpr uint32_t GOST_GAMMA_C1 = 0x01010104;
+constexpr uint32_t GOST_GAMMA_C2 = 0x01010101;
 
 class gost_encrypter
 {
@@ -16,12 +24,54 @@ public:
 		const char* what() const throw ();
 	};
 
-	gost_encrypter(const std::string& key);
+	struct invalid_iv : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct unsupported_kernel : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// the tiers with a block kernel of their own this CPU runs: scalar one block at a time, avx2 and
+	// avx512 8 and 16 blocks at once with gathered table lookups
+	static std::vector<cpu_features::isa> get_kernels();
+
+	// runs the best kernel at or below level, throws unsupported_kernel for a level this CPU lacks.
+	// Without a parameter set the legacy S-boxes are used, see gost_param_set.hpp
+	gost_encrypter(const std::string& key, cpu_features::isa level = cpu_features::get_isa());
+	gost_encrypter(const std::string& key, gost_param_set set, cpu_features::isa level = cpu_features::get_isa());
 	~gost_encrypter() = default;
 
+	// ECB
 	std::string encrypt(const std::string& message) const;
 	std::string decrypt(const std::string& message) const;
 
+	// CTR: message ^ E(iv) || E(iv + 1) || ..., iv being BLOCK_SIZE bytes read as a big-endian counter.
+	// The same call encrypts and decrypts, the output is as long as the message. Throws invalid_iv
+	std::string crypt_ctr(const std::string& message, const std::string& iv) const;
+
+	// gamma mode of GOST 28147-89: E(iv) gives the counter words (n1, n2), block i = 1, 2, ... is xored
+	// with E(n1 + i * C2 modulo 2^32, n2 + i * C1 modulo 2^32 - 1 and kept in 1..2^32 - 1). Encrypts and
+	// decrypts, a partial last block takes the start of its gamma. Throws invalid_iv
+	std::string crypt_gamma(const std::string& message, const std::string& iv) const;
+	// the same output, the gamma of separate ranges of blocks made on the workers of the pool
+	std::string crypt_gamma(const std::string& message, const std::string& iv, thread_pool& pool) const;
+
+	// gamma with feedback (CFB): c_i = p_i ^ E(c_{i - 1}), c_0 being the iv, the output as long as the
+	// message. Encryption goes a block at a time, decryption runs every E through the kernel at once
+	std::string encrypt_cfb(const std::string& message, const std::string& iv) const;
+	std::string decrypt_cfb(const std::string& message, const std::string& iv) const;
+
+	// blocks_count blocks of BLOCK_SIZE bytes each, input and output may be the same buffer
+	void encrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+	void decrypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count) const;
+
+	// the tier of the kernel in use
+	cpu_features::isa get_kernel() const;
+	gost_param_set get_param_set() const;
+
 private:
 	struct invalid_action : public std::exception
 	{
@@ -35,19 +85,25 @@ private:
 		undefined,
 	};
 
-	static std::vector<std::string> _build_message_blocks(const std::string& message);
 	static std::string _try_remove_padding(const std::string& message);
 	static std::string _check_key(const std::string& key);
 	static std::string _construct_padding_message(const std::string& message);
 
-	std::bitset<BLOCK_SIZE * CHAR_BIT> _encrypt_block(const std::string& block, _e_action action) const;
+	void _crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count, const uint32_t keys[32]) const;
 	std::string _internal_run(const std::string& message, _e_action action) const;
+	static void _check_iv(const std::string& iv);
+	// gamma blocks [begin, end) xored into output, which holds the message; n1 and n2 are E(iv)
+	void _crypt_gamma_range(uint32_t n1, uint32_t n2, std::string& output, uint64_t begin, uint64_t end) const;
+	std::string _crypt_gamma(const std::string& message, const std::string& iv, thread_pool* pool) const;
 
 	void _generate_keys();
-	std::bitset<HALF_BLOCK_SIZE_BITS> feistel_function(
-		const std::bitset<HALF_BLOCK_SIZE_BITS>& a_data,
-		const std::bitset<HALF_BLOCK_SIZE_BITS>& x_key) const;
 
+	cpu_features::isa _kernel;
+	gost_crypt_function _crypt;
+	gost_param_set _set;
+	const gost_round_tables* _tables;
 	std::string _key;
-	std::vector<std::bitset<HALF_BLOCK_SIZE_BITS>> _generated_keys;
+	// the 32 round keys in encryption order, and reversed for decryption
+	std::vector<uint32_t> _generated_keys;
+	std::vector<uint32_t> _reversed_keys;
 };
@@ -1,240 +1,175 @@
 #include "gost_hash.hpp"
-#include <cmath>
+#include <cstring>
+#include <climits>
+#include <algorithm>
 
-#include "gost_encrypter.hpp"
-#include "bit_utils.hpp"
+#include "kernel_table.hpp"
 
-// id-tc26-gost-28147-param-Z id of S box
-const std::vector<std::vector<uint8_t>> S_BOX =
+namespace _hash_utils
 {
-	{13, 4, 6, 2, 11, 5, 12, 9, 15, 8, 14, 7, 0, 3, 0, 1},
-	{6, 8, 2, 3, 9, 11, 5, 13, 1, 15, 4, 7, 12, 14, 0, 0},
-	{12, 3, 5, 8, 2, 0, 11, 14, 15, 1, 7, 4, 13, 9, 6, 0},
-	{13, 8, 2, 1, 14, 4, 0, 6, 7, 0, 11, 5, 3, 15, 9, 12},
-	{7, 0, 5, 11, 8, 1, 6, 14, 0, 9, 3, 15, 12, 4, 2, 13},
-	{5, 14, 0, 6, 9, 2, 13, 11, 12, 7, 8, 1, 4, 3, 15, 0},
-	{8, 15, 2, 5, 6, 9, 1, 13, 0, 4, 12, 0, 14, 11, 3, 7},
-	{1, 7, 15, 14, 0, 5, 8, 3, 4, 0, 11, 6, 9, 13, 12, 2},
-};
-
-const uint8_t CONSTANT_2 = 0;
-
-const uint8_t CONSTANT_3[32] =
-{
-	0xff, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0xff,
-	0xff, 0x00, 0x00, 0xff, 0x00, 0xff, 0xff, 0x00,
-	0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff,
-	0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00,
-};
-
-const uint8_t CONSTANT_4 = 0;
-
-static std::vector<std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>> KEYGEN_CONSTANTS;
-
-gost_hash::gost_hash(const std::string& starting_hash_block)
-{
-	uint8_t* hash_bytes = bit_utils::stob(_check_starting_block(starting_hash_block));
-	_starting_hash_block = bit_utils::bytes_to_bitset<HASH_BLOCK_SIZE>(hash_bytes);
+	void compress_scalar(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+		const gost_round_tables& tables)
+	{
+		gost_hash_compress(h, m, tables);
+	}
 
-	if (KEYGEN_CONSTANTS.empty())
+#if defined(CRYPTO_X86)
+	constexpr kernel_table<gost_hash_compress_function> COMPRESS_KERNELS =
+	{
+		{ compress_scalar, gost_hash_compress_sse41, nullptr, nullptr },
+	};
+#else
+	constexpr kernel_table<gost_hash_compress_function> COMPRESS_KERNELS = { { compress_scalar } };
+#endif
+
+	void compress_r3411(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+		const gost_round_tables& tables)
 	{
-		KEYGEN_CONSTANTS.push_back(CONSTANT_2);
-		KEYGEN_CONSTANTS.push_back(bit_utils::bytes_to_bitset<HASH_BLOCK_SIZE>(CONSTANT_3));
-		KEYGEN_CONSTANTS.push_back(CONSTANT_4);
+		gost_r3411_compress(h, m, tables);
 	}
-}
 
-std::string gost_hash::generate_hash(const std::string& message) const
-{
-	return _internal_run(message);
-}
+	// the standard step of every set but the legacy one
+	constexpr kernel_table<gost_hash_compress_function> R3411_COMPRESS_KERNELS = { { compress_r3411 } };
 
-std::vector<std::string> gost_hash::_build_message_blocks(const std::string& message)
-{
-	std::vector<std::string> blocks;
-	size_t blocks_count = message.size() / HASH_BLOCK_SIZE;
-	blocks.reserve(blocks_count);
-	for (uint32_t i = 0; i < blocks_count; ++i)
+	const kernel_table<gost_hash_compress_function>& get_compress_kernels(gost_param_set set)
 	{
-		blocks.push_back(message.substr(static_cast<size_t>(i) * HASH_BLOCK_SIZE, HASH_BLOCK_SIZE));
+		return set == gost_param_set::legacy ? COMPRESS_KERNELS : R3411_COMPRESS_KERNELS;
 	}
 
-	return blocks;
-}
-
-std::string gost_hash::_check_starting_block(const std::string& key)
-{
-	if (key.size() < HASH_BLOCK_SIZE)
+	// sum += block modulo 2^256, both read big-endian
+	void add_block(uint8_t sum[HASH_BLOCK_SIZE], const uint8_t block[HASH_BLOCK_SIZE])
 	{
-		throw invalid_key();
+		uint32_t carry = 0;
+		for (uint32_t i = HASH_BLOCK_SIZE; i > 0; --i)
+		{
+			carry += uint32_t(sum[i - 1]) + block[i - 1];
+			sum[i - 1] = static_cast<uint8_t>(carry);
+			carry >>= CHAR_BIT;
+		}
 	}
 
-	return key.substr(0, HASH_BLOCK_SIZE);
+	// the same sum, both read little-endian as the standard does
+	void add_block_little_endian(uint8_t sum[HASH_BLOCK_SIZE], const uint8_t block[HASH_BLOCK_SIZE])
+	{
+		uint32_t carry = 0;
+		for (uint32_t i = 0; i < HASH_BLOCK_SIZE; ++i)
+		{
+			carry += uint32_t(sum[i]) + block[i];
+			sum[i] = static_cast<uint8_t>(carry);
+			carry >>= CHAR_BIT;
+		}
+	}
 }
 
-std::string gost_hash::_construct_padding_message(const std::string& message)
+std::vector<cpu_features::isa> gost_hash::get_kernels(gost_param_set set)
 {
-	uint8_t padding_len = (HASH_BLOCK_SIZE - message.size()) % HASH_BLOCK_SIZE;
-
-	// msvc16 bug?
-	uint8_t zero_character = 0;
-	return message + std::string(zero_character, padding_len);
+	return _hash_utils::get_compress_kernels(set).get_supported();
 }
 
-uint64_t gost_hash::_get_phi_index(uint64_t input_index)
+gost_hash::gost_hash(const std::string& starting_hash_block, cpu_features::isa level)
+	: gost_hash(starting_hash_block, gost_param_set::legacy, level)
 {
-	uint64_t x = input_index + 1;
-	uint64_t k = static_cast<uint64_t>(ceil(x / 4.0f));
-	uint64_t i = x - 4 * k + 3;
-	return 8 * i + k - 1;
 }
 
-std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> gost_hash::_a_transform(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& block)
+gost_hash::gost_hash(gost_param_set set, cpu_features::isa level)
+	: gost_hash(std::string(HASH_BLOCK_SIZE, '\0'), set, level)
 {
-	auto y_blocks = bit_utils::split_bitset<HASH_BLOCK_SIZE, 4>(block);
-	auto first_merge = bit_utils::merge_bitset<HASH_BLOCK_SIZE / 2>(y_blocks[0] ^ y_blocks[1], y_blocks[3]);
-	auto second_merge = bit_utils::merge_bitset<HASH_BLOCK_SIZE / 2>(y_blocks[2], y_blocks[3]);
-	auto result_merge = bit_utils::merge_bitset<HASH_BLOCK_SIZE>(first_merge, second_merge);
-
-	return result_merge;
 }
 
-std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> gost_hash::_p_transform(const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& block)
+gost_hash::gost_hash(const std::string& starting_hash_block, gost_param_set set, cpu_features::isa level)
+	: _kernel(_hash_utils::get_compress_kernels(set).select(level))
+	, _compress(_hash_utils::get_compress_kernels(set).get(level))
+	, _set(set)
+	, _tables(&gost_get_round_tables(set))
+	, _starting_hash_block(_check_starting_block(starting_hash_block))
 {
-	std::vector<std::bitset<CHAR_BIT>> y_blocks = bit_utils::split_bitset<HASH_BLOCK_SIZE, 32>(block);
-	std::vector<std::bitset<CHAR_BIT>> y_blocks_permutated;
-	y_blocks_permutated.resize(y_blocks.size());
-
-	for (int64_t i = 31; i >= 0; --i)
+	if (!cpu_features::is_supported(level))
 	{
-		y_blocks_permutated[31 - i] = y_blocks[_get_phi_index(i)];
+		throw unsupported_kernel();
 	}
-
-	auto merged_bitset = bit_utils::merge_bitsets<HASH_BLOCK_SIZE, 1>(y_blocks_permutated);
-	return merged_bitset;
 }
 
-std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> gost_hash::_psi_transform(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& block)
+std::string gost_hash::generate_hash(const std::string& message) const
 {
-	auto y_subkeys = bit_utils::split_bitset<HASH_BLOCK_SIZE, 16>(block);
-	std::vector<std::bitset<CHAR_BIT * 2>> y_blocks_permutated;
-	y_blocks_permutated.resize(y_subkeys.size());
-
-	y_blocks_permutated[0] = y_subkeys[0] ^ y_subkeys[1] ^ y_subkeys[2] ^ y_subkeys[3] ^ y_subkeys[12] ^ y_subkeys[15];
-
-	for (int64_t i = 15; i >= 1; --i)
-	{
-		// we start from 1 index
-		y_blocks_permutated[16 - i] = y_subkeys[i];
-	}
-
-	auto merged_bitset = bit_utils::merge_bitsets<HASH_BLOCK_SIZE, 2>(y_blocks_permutated);
-	return merged_bitset;
+	return _internal_run(message);
 }
 
-std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> gost_hash::_generate_s_block(
-	const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& block, const std::vector<std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>>& keys)
+cpu_features::isa gost_hash::get_kernel() const
 {
-	auto h_subblocks = bit_utils::split_bitset<HASH_BLOCK_SIZE, 4>(block);
-	std::vector<std::bitset<HASH_BLOCK_SIZE * 2>> s_subblocks;
-	s_subblocks.reserve(4);
-
-	for (uint64_t i = 0; i < 4; ++i)
-	{
-		std::string gost_key = bit_utils::bitset_to_bytes<HASH_BLOCK_SIZE>(keys[i]);
-		gost_encrypter encrypter(gost_key);
-
-		std::string h_message = bit_utils::bitset_to_bytes<HASH_BLOCK_SIZE / 4>(h_subblocks[i]);
-		std::string s_subblock = encrypter.encrypt(h_message);
-		s_subblocks.push_back(bit_utils::bytes_to_bitset<HASH_BLOCK_SIZE / 4>(bit_utils::stob(s_subblock)));
-	}
-
-	auto merged_bitset = bit_utils::merge_bitsets<HASH_BLOCK_SIZE, HASH_BLOCK_SIZE / 4>(s_subblocks);
-	return merged_bitset;
+	return _kernel;
 }
 
-std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> gost_hash::_permutate_hash_step(
-	const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& m_block, 
-	const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& h_block, 
-	const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& s_block)
+gost_param_set gost_hash::get_param_set() const
 {
-	std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> first_step = s_block;
-
-	for (uint64_t i = 0; i < 12; ++i)
-	{
-		first_step = _psi_transform(first_step);
-	}
-
-	std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> second_step = first_step ^ m_block;
-	second_step = _psi_transform(second_step);
-
-	std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> third_step = h_block ^ second_step;
-
-	for (uint64_t i = 0; i < 61; ++i)
-	{
-		third_step = _psi_transform(third_step);
-	}
-
-	return third_step;
+	return _set;
 }
 
-std::vector<std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>> gost_hash::_generate_keys(
-	const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& h_block, const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& m_block)
+std::string gost_hash::_check_starting_block(const std::string& key)
 {
-	auto u_block = h_block, v_block = m_block;
-	auto W_block = u_block ^ v_block;
-
-	std::vector<std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>> generated_keys;
-	generated_keys.reserve(4);
-	generated_keys.push_back(_p_transform(W_block));
-
-	for (uint64_t i = 0; i < 3; ++i)
+	if (key.size() < HASH_BLOCK_SIZE)
 	{
-		u_block = _a_transform(u_block) ^ KEYGEN_CONSTANTS[i];
-		v_block = _a_transform(_a_transform(v_block));
-		W_block = u_block ^ W_block;
-		generated_keys.push_back(_p_transform(W_block));
+		throw invalid_key();
 	}
 
-	return generated_keys;
+	return key.substr(0, HASH_BLOCK_SIZE);
 }
 
 std::string gost_hash::_internal_run(const std::string& message) const
 {
-	uint64_t message_len = message.size() * CHAR_BIT;
+	const gost_round_tables& tables = *_tables;
+	const bool legacy = _set == gost_param_set::legacy;
 
-	std::string message_to_process = _construct_padding_message(message);
-	std::vector<std::string> source_blocks = _build_message_blocks(message_to_process);
-	std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> result_block = _starting_hash_block;
-	std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> control_sum = 0;
+	uint8_t result_block[HASH_BLOCK_SIZE];
+	std::memcpy(result_block, _starting_hash_block.data(), HASH_BLOCK_SIZE);
+	uint8_t control_sum[HASH_BLOCK_SIZE] = {};
 
-	for (const auto& block : source_blocks)
+	// zeros fill a trailing partial block up, without them it would not be hashed at all
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+	for (uint64_t offset = 0; offset < message.size(); offset += HASH_BLOCK_SIZE)
 	{
-		auto block_bitset = bit_utils::bytes_to_bitset<HASH_BLOCK_SIZE>(bit_utils::stob(block));
-		result_block = _hash_block(result_block, block_bitset);
-		std::tie(std::ignore, control_sum) = bit_utils::add_mod_2<HASH_BLOCK_SIZE>(control_sum, block_bitset);
+		uint8_t block[HASH_BLOCK_SIZE] = {};
+		std::memcpy(block, data + offset, std::min<uint64_t>(HASH_BLOCK_SIZE, message.size() - offset));
+
+		_compress(result_block, block, tables);
+		if (legacy)
+		{
+			_hash_utils::add_block(control_sum, block);
+		}
+		else
+		{
+			_hash_utils::add_block_little_endian(control_sum, block);
+		}
 	}
 
-	auto len_bitset = bit_utils::bytes_to_bitset<HASH_BLOCK_SIZE>(bit_utils::int_to_bytes(message_len).data());
+	// the message length in bits. The standard has it little-endian; the legacy set keeps it big-endian
+	// and repeated in every 8 bytes: the bitset version shifted the 64-bit length by up to 248 bits,
+	// which x86 takes modulo 64, and digests keep that
+	uint8_t length_block[HASH_BLOCK_SIZE] = {};
+	const uint64_t message_bits = message.size() * CHAR_BIT;
+	for (uint32_t i = 0; i < HASH_BLOCK_SIZE; ++i)
+	{
+		if (legacy)
+		{
+			length_block[HASH_BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(message_bits >> (i % 8 * CHAR_BIT));
+		}
+		else if (i < sizeof(message_bits))
+		{
+			length_block[i] = static_cast<uint8_t>(message_bits >> (i * CHAR_BIT));
+		}
+	}
 
-	result_block = _hash_block(result_block, len_bitset);
-	result_block = _hash_block(result_block, control_sum);
-	
-	std::string result_message = bit_utils::bitset_to_bytes<HASH_BLOCK_SIZE>(result_block);
+	_compress(result_block, length_block, tables);
+	_compress(result_block, control_sum, tables);
 
-	return result_message;
+	return std::string(reinterpret_cast<const char*>(result_block), HASH_BLOCK_SIZE);
 }
 
-std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> gost_hash::_hash_block(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& h_block, 
-	const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& message_block) const
+const char* gost_hash::invalid_key::what() const throw ()
 {
-	auto keys = _generate_keys(h_block, message_block);
-	auto s_block = _generate_s_block(h_block, keys);
-	auto permutate_block = _permutate_hash_step(message_block, h_block, s_block);
-	return permutate_block;
+	return "Invalid start hash! Hash should be no less than 32 chars";
 }
 
-const char* gost_hash::invalid_key::what() const throw ()
+const char* gost_hash::unsupported_kernel::what() const throw ()
 {
-	return "Invalid start hash! Hash should be no less than 32 chars";
+	return "The CPU does not support the requested GOST hash kernel!";
 }
@@ -2,9 +2,12 @@
 
 #include <string>
 #include <vector>
-#include <bitset>
 
-constexpr uint32_t HASH_BLOCK_SIZE = 32;
+#include "cpu_features.hpp"
+#include "gost_hash_kernel.hpp"
+#include "gost_param_set.hpp"
+
+constexpr uint32_t HASH_BLOCK_SIZE = GOST_HASH_BLOCK_SIZE;
 
 class gost_hash
 {
@@ -14,32 +17,40 @@ public:
 		const char* what() const throw ();
 	};
 
-	gost_hash(const std::string& starting_hash_block);
+	struct unsupported_kernel : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// the tiers with a step function of their own this CPU runs for set, see gost_hash_kernel.hpp
+	static std::vector<cpu_features::isa> get_kernels(gost_param_set set = gost_param_set::legacy);
+
+	// runs the best step function at or below level, throws unsupported_kernel for a level this CPU lacks.
+	// The block cipher inside uses the S-boxes of set, the legacy ones by default. Only the legacy set
+	// keeps the step function, length block and byte order this class always had, which match no other
+	// implementation; every other set is GOST R 34.11-94 as OpenSSL's ccgost computes it, digest bytes
+	// included, the starting block read as a little-endian number
+	gost_hash(const std::string& starting_hash_block, cpu_features::isa level = cpu_features::get_isa());
+	gost_hash(const std::string& starting_hash_block, gost_param_set set,
+		cpu_features::isa level = cpu_features::get_isa());
+	// starting from 32 zero bytes, as the examples of the standard and OpenSSL do
+	explicit gost_hash(gost_param_set set, cpu_features::isa level = cpu_features::get_isa());
 	~gost_hash() = default;
 
 	std::string generate_hash(const std::string& message) const;
 
+	// the tier of the step function in use
+	cpu_features::isa get_kernel() const;
+	gost_param_set get_param_set() const;
+
 private:
-	static std::vector<std::string> _build_message_blocks(const std::string& message);
 	static std::string _check_starting_block(const std::string& key);
-	static std::string _construct_padding_message(const std::string& message);
-
-	static uint64_t _get_phi_index(uint64_t x);
-	static std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> _a_transform(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& block);
-	static std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> _p_transform(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& block);
-	static std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> _psi_transform(const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& block);
-
-	static std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> _generate_s_block(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& block, 
-		const std::vector<std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>>& keys);	
-	static std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> _permutate_hash_step(const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& m_block,
-		const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& h_block, const std::bitset<HASH_BLOCK_SIZE* CHAR_BIT>& s_block);
-
-	static std::vector<std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>> _generate_keys(
-		const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& h_block, const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& m_block);
 
-	std::bitset<HASH_BLOCK_SIZE * CHAR_BIT> _hash_block(const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& h_block, 
-		const std::bitset<HASH_BLOCK_SIZE * CHAR_BIT>& message_block) const;
 	std::string _internal_run(const std::string& message) const;
 
-	std::bitset<HASH_BLOCK_SIZE* CHAR_BIT> _starting_hash_block;
+	cpu_features::isa _kernel;
+	gost_hash_compress_function _compress;
+	gost_param_set _set;
+	const gost_round_tables* _tables;
+	std::string _starting_hash_block;
 };
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gost_kernel.hpp"
+
+/*
+  The step function of gost_hash on raw bytes. A 32-byte block is read the way the bitset version
+  read it: byte 0 first, 8-byte chunks y0..y3 and 16-bit words w0..w15 counted from there. A, P and
+  psi are the transformations of GOST R 34.11-94, the four encryptions use the block rounds of
+  gost_encrypter
+*/
+constexpr uint32_t GOST_HASH_BLOCK_SIZE = 32;
+
+// the constant C3 of the key generation, C2 and C4 are zeros
+constexpr uint8_t GOST_HASH_C3[GOST_HASH_BLOCK_SIZE] =
+{
+	0xff, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0xff,
+	0xff, 0x00, 0x00, 0xff, 0x00, 0xff, 0xff, 0x00,
+	0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff,
+	0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00,
+};
+
+// the round keys of gost_encrypter: eight big-endian words used k0..k7 three times, then k7..k0
+inline void gost_hash_expand_key(const uint8_t key[GOST_HASH_BLOCK_SIZE], uint32_t keys[32])
+{
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		const uint8_t* word = key + 4 * i;
+		keys[i] = (uint32_t(word[0]) << 24) | (uint32_t(word[1]) << 16) | (uint32_t(word[2]) << 8) | word[3];
+	}
+	for (uint32_t i = 8; i < 24; ++i)
+	{
+		keys[i] = keys[i % 8];
+	}
+	for (uint32_t i = 24; i < 32; ++i)
+	{
+		keys[i] = keys[31 - i];
+	}
+}
+
+// A(y0 || y1 || y2 || y3) = (y0 ^ y1) || y3 || y2 || y3
+inline void gost_hash_a(const uint8_t* input, uint8_t* output)
+{
+	uint8_t result[GOST_HASH_BLOCK_SIZE];
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		result[i] = input[i] ^ input[8 + i];
+		result[8 + i] = input[24 + i];
+		result[16 + i] = input[16 + i];
+		result[24 + i] = input[24 + i];
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		output[i] = result[i];
+	}
+}
+
+// P, the byte transposition phi of the standard read from the other end: byte o of the result is
+// byte 31 - 8 * (o % 4) - o / 4 of the input
+inline void gost_hash_p(const uint8_t* input, uint8_t* output)
+{
+	for (uint32_t o = 0; o < GOST_HASH_BLOCK_SIZE; ++o)
+	{
+		output[o] = input[31 - 8 * (o % 4) - o / 4];
+	}
+}
+
+// psi(w0 || ... || w15) = (w0 ^ w1 ^ w2 ^ w3 ^ w12 ^ w15) || w15 || w14 || ... || w1, in place
+inline void gost_hash_psi(uint8_t* block)
+{
+	uint8_t result[GOST_HASH_BLOCK_SIZE];
+	for (uint32_t byte = 0; byte < 2; ++byte)
+	{
+		result[byte] = block[byte] ^ block[2 + byte] ^ block[4 + byte] ^ block[6 + byte] ^
+			block[24 + byte] ^ block[30 + byte];
+	}
+	for (uint32_t word = 1; word < 16; ++word)
+	{
+		result[2 * word] = block[2 * (16 - word)];
+		result[2 * word + 1] = block[2 * (16 - word) + 1];
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		block[i] = result[i];
+	}
+}
+
+// the four 32-byte keys of one step
+inline void gost_hash_generate_keys(const uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	uint8_t keys[4][GOST_HASH_BLOCK_SIZE])
+{
+	uint8_t u[GOST_HASH_BLOCK_SIZE], w[GOST_HASH_BLOCK_SIZE];
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		u[i] = h[i];
+		w[i] = h[i] ^ m[i];
+	}
+	gost_hash_p(w, keys[0]);
+
+	for (uint32_t key = 1; key < 4; ++key)
+	{
+		gost_hash_a(u, u);
+		for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+		{
+			u[i] ^= key == 2 ? GOST_HASH_C3[i] : 0;
+			w[i] ^= u[i];
+		}
+		gost_hash_p(w, keys[key]);
+	}
+}
+
+// s: the four 8-byte chunks of h, each encrypted under its own key
+inline void gost_hash_encrypt(const uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t keys[4][GOST_HASH_BLOCK_SIZE],
+	uint8_t s[GOST_HASH_BLOCK_SIZE], const gost_round_tables& tables)
+{
+	for (uint32_t chunk = 0; chunk < 4; ++chunk)
+	{
+		uint32_t round_keys[32];
+		gost_hash_expand_key(keys[chunk], round_keys);
+		gost_crypt_blocks(h + 8 * chunk, s + 8 * chunk, 1, round_keys, tables);
+	}
+}
+
+// h = psi^61(h ^ psi(m ^ psi^12(s))), the step function over one message block
+inline void gost_hash_compress(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	const gost_round_tables& tables)
+{
+	uint8_t keys[4][GOST_HASH_BLOCK_SIZE];
+	gost_hash_generate_keys(h, m, keys);
+
+	uint8_t s[GOST_HASH_BLOCK_SIZE];
+	gost_hash_encrypt(h, keys, s, tables);
+
+	for (uint32_t i = 0; i < 12; ++i)
+	{
+		gost_hash_psi(s);
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		s[i] ^= m[i];
+	}
+	gost_hash_psi(s);
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		h[i] ^= s[i];
+	}
+	for (uint32_t i = 0; i < 61; ++i)
+	{
+		gost_hash_psi(h);
+	}
+}
+
+/*
+  The step function of GOST R 34.11-94 itself, which the one above is not: A, the key generation
+  and the byte order all differ. A 32-byte block is a little-endian 256-bit number as in the standard
+  and OpenSSL's ccgost, y1 and w1 being its lowest 8 bytes and 2 bytes, and the cipher reads key and
+  data words little-endian
+*/
+
+// A(y4 || y3 || y2 || y1) = (y1 ^ y2) || y4 || y3 || y2
+inline void gost_r3411_a(const uint8_t* input, uint8_t* output)
+{
+	uint8_t result[GOST_HASH_BLOCK_SIZE];
+	for (uint32_t i = 0; i < 24; ++i)
+	{
+		result[i] = input[8 + i];
+	}
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		result[24 + i] = input[i] ^ input[8 + i];
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		output[i] = result[i];
+	}
+}
+
+// P: byte i + 4 * j of the result is byte 8 * i + j of the input
+inline void gost_r3411_p(const uint8_t* input, uint8_t* output)
+{
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		for (uint32_t j = 0; j < 8; ++j)
+		{
+			output[i + 4 * j] = input[8 * i + j];
+		}
+	}
+}
+
+// psi(w16 || ... || w1) = (w1 ^ w2 ^ w3 ^ w4 ^ w13 ^ w16) || w16 || ... || w2, in place
+inline void gost_r3411_psi(uint8_t* block)
+{
+	uint8_t first[2];
+	for (uint32_t byte = 0; byte < 2; ++byte)
+	{
+		first[byte] = block[byte] ^ block[2 + byte] ^ block[4 + byte] ^ block[6 + byte] ^
+			block[24 + byte] ^ block[30 + byte];
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE - 2; ++i)
+	{
+		block[i] = block[i + 2];
+	}
+	block[30] = first[0];
+	block[31] = first[1];
+}
+
+// one block of GOST 28147-89 with key and data words read little-endian
+inline void gost_r3411_encrypt_block(const uint8_t key[GOST_HASH_BLOCK_SIZE], const uint8_t* input, uint8_t* output,
+	const gost_round_tables& tables)
+{
+	uint32_t keys[8];
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		const uint8_t* word = key + 4 * i;
+		keys[i] = (uint32_t(word[3]) << 24) | (uint32_t(word[2]) << 16) | (uint32_t(word[1]) << 8) | word[0];
+	}
+
+	uint32_t a = (uint32_t(input[3]) << 24) | (uint32_t(input[2]) << 16) | (uint32_t(input[1]) << 8) | input[0];
+	uint32_t b = (uint32_t(input[7]) << 24) | (uint32_t(input[6]) << 16) | (uint32_t(input[5]) << 8) | input[4];
+	for (uint32_t round = 0; round < 32; ++round)
+	{
+		const uint32_t new_a = b ^ gost_round(a, keys[round < 24 ? round % 8 : 31 - round], tables);
+		b = a;
+		a = new_a;
+	}
+
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		output[i] = static_cast<uint8_t>(b >> (8 * i));
+		output[4 + i] = static_cast<uint8_t>(a >> (8 * i));
+	}
+}
+
+// h = psi^61(h ^ psi(m ^ psi^12(s))), the keys being P(U ^ V) for U = h, A(U) ^ C and V = m, A(A(V)),
+// C nonzero only for the third key
+inline void gost_r3411_compress(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	const gost_round_tables& tables)
+{
+	uint8_t u[GOST_HASH_BLOCK_SIZE], v[GOST_HASH_BLOCK_SIZE], w[GOST_HASH_BLOCK_SIZE];
+	uint8_t key[GOST_HASH_BLOCK_SIZE], s[GOST_HASH_BLOCK_SIZE];
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		u[i] = h[i];
+		v[i] = m[i];
+	}
+
+	for (uint32_t chunk = 0; chunk < 4; ++chunk)
+	{
+		if (chunk > 0)
+		{
+			gost_r3411_a(u, u);
+			gost_r3411_a(v, v);
+			gost_r3411_a(v, v);
+		}
+		for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+		{
+			// C3 as the standard writes it, least significant byte first
+			u[i] ^= chunk == 2 ? GOST_HASH_C3[GOST_HASH_BLOCK_SIZE - 1 - i] : 0;
+			w[i] = u[i] ^ v[i];
+		}
+
+		gost_r3411_p(w, key);
+		gost_r3411_encrypt_block(key, h + 8 * chunk, s + 8 * chunk, tables);
+	}
+
+	for (uint32_t i = 0; i < 12; ++i)
+	{
+		gost_r3411_psi(s);
+	}
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		s[i] ^= m[i];
+	}
+	gost_r3411_psi(s);
+	for (uint32_t i = 0; i < GOST_HASH_BLOCK_SIZE; ++i)
+	{
+		h[i] ^= s[i];
+	}
+	for (uint32_t i = 0; i < 61; ++i)
+	{
+		gost_r3411_psi(h);
+	}
+}
+
+using gost_hash_compress_function = void (*)(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	const gost_round_tables& tables);
+
+// the same step with A, P and psi on 128-bit registers (pshufb, palignr, pblendw), the encryptions
+// stay scalar; x86 builds only, picked through a kernel_table
+void gost_hash_compress_sse41(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	const gost_round_tables& tables);
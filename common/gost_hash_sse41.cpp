@@ -0,0 +1,122 @@
+#include "cpu_features.hpp"
+#include "gost_hash_kernel.hpp"
+
+#if defined(CRYPTO_X86)
+#include <immintrin.h>
+
+// everything defined below may use sse4.1; the scalar inline functions of gost_hash_kernel.hpp are
+// included above, so the copies other files link against never get compiled for it
+#if defined(__GNUC__)
+#pragma GCC target("sse4.1,ssse3")
+#endif
+
+namespace
+{
+	// a 32-byte block as bytes 0..15 and 16..31
+	struct hash_block
+	{
+		__m128i low;
+		__m128i high;
+	};
+
+	inline hash_block load_block(const uint8_t* bytes)
+	{
+		return {
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16)),
+		};
+	}
+
+	inline void store_block(const hash_block& block, uint8_t* bytes)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), block.low);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + 16), block.high);
+	}
+
+	inline hash_block xor_blocks(const hash_block& first, const hash_block& second)
+	{
+		return { _mm_xor_si128(first.low, second.low), _mm_xor_si128(first.high, second.high) };
+	}
+
+	inline hash_block a_transform(const hash_block& block)
+	{
+		// y0 ^ y1 in the low half, y3 next to it
+		const __m128i y0_y1 = _mm_xor_si128(block.low, _mm_shuffle_epi32(block.low, _MM_SHUFFLE(1, 0, 3, 2)));
+		return { _mm_unpacklo_epi64(y0_y1, _mm_srli_si128(block.high, 8)), block.high };
+	}
+
+	// every output byte takes its input byte from one half, the shuffle of the other half zeroes it
+	inline hash_block p_transform(const hash_block& block)
+	{
+		const __m128i low_from_low = _mm_setr_epi8(-1, -1, 15, 7, -1, -1, 14, 6, -1, -1, 13, 5, -1, -1, 12, 4);
+		const __m128i low_from_high = _mm_setr_epi8(15, 7, -1, -1, 14, 6, -1, -1, 13, 5, -1, -1, 12, 4, -1, -1);
+		const __m128i high_from_low = _mm_setr_epi8(-1, -1, 11, 3, -1, -1, 10, 2, -1, -1, 9, 1, -1, -1, 8, 0);
+		const __m128i high_from_high = _mm_setr_epi8(11, 3, -1, -1, 10, 2, -1, -1, 9, 1, -1, -1, 8, 0, -1, -1);
+
+		return {
+			_mm_or_si128(_mm_shuffle_epi8(block.low, low_from_low), _mm_shuffle_epi8(block.high, low_from_high)),
+			_mm_or_si128(_mm_shuffle_epi8(block.low, high_from_low), _mm_shuffle_epi8(block.high, high_from_high)),
+		};
+	}
+
+	inline hash_block psi_transform(const hash_block& block)
+	{
+		const __m128i reverse_words = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+
+		// w0 ^ w1 ^ w2 ^ w3 and w12 ^ w15 in word 0
+		const __m128i low_pairs = _mm_xor_si128(block.low, _mm_srli_si128(block.low, 4));
+		const __m128i low_sum = _mm_xor_si128(low_pairs, _mm_srli_si128(low_pairs, 2));
+		const __m128i high_sum = _mm_xor_si128(_mm_srli_si128(block.high, 8), _mm_srli_si128(block.high, 14));
+		const __m128i first_word = _mm_xor_si128(low_sum, high_sum);
+
+		// w15..w8 and w7..w0
+		const __m128i reversed_high = _mm_shuffle_epi8(block.high, reverse_words);
+		const __m128i reversed_low = _mm_shuffle_epi8(block.low, reverse_words);
+
+		return {
+			_mm_blend_epi16(_mm_slli_si128(reversed_high, 2), first_word, 0x01),
+			_mm_alignr_epi8(reversed_low, reversed_high, 14),
+		};
+	}
+}
+
+void gost_hash_compress_sse41(uint8_t h[GOST_HASH_BLOCK_SIZE], const uint8_t m[GOST_HASH_BLOCK_SIZE],
+	const gost_round_tables& tables)
+{
+	const hash_block h_block = load_block(h);
+	const hash_block m_block = load_block(m);
+	const hash_block c3 = load_block(GOST_HASH_C3);
+
+	uint8_t keys[4][GOST_HASH_BLOCK_SIZE];
+	hash_block u = h_block;
+	hash_block w = xor_blocks(h_block, m_block);
+	store_block(p_transform(w), keys[0]);
+	for (uint32_t key = 1; key < 4; ++key)
+	{
+		u = a_transform(u);
+		if (key == 2)
+		{
+			u = xor_blocks(u, c3);
+		}
+		w = xor_blocks(w, u);
+		store_block(p_transform(w), keys[key]);
+	}
+
+	uint8_t s_bytes[GOST_HASH_BLOCK_SIZE];
+	gost_hash_encrypt(h, keys, s_bytes, tables);
+
+	hash_block s = load_block(s_bytes);
+	for (uint32_t i = 0; i < 12; ++i)
+	{
+		s = psi_transform(s);
+	}
+	s = psi_transform(xor_blocks(s, m_block));
+
+	hash_block result = xor_blocks(h_block, s);
+	for (uint32_t i = 0; i < 61; ++i)
+	{
+		result = psi_transform(result);
+	}
+	store_block(result, h);
+}
+#endif
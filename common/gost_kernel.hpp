@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+// blocks the vector kernels take at a time, one per 32-bit lane
+constexpr uint64_t GOST_AVX2_LANES = 8;
+constexpr uint64_t GOST_AVX512_LANES = 16;
+
+/*
+  The round function of gost_encrypter as four byte lookups: bytes[i][v] is the byte v sitting i bytes
+  from the most significant end of the sum, pushed through its two 4-bit S-boxes, put back in place and
+  rotated left by 11. The four results occupy disjoint bits before the rotation, so XOR joins them
+*/
+struct gost_round_tables
+{
+	uint32_t bytes[4][256];
+};
+
+inline uint32_t gost_round(uint32_t half, uint32_t key, const gost_round_tables& tables)
+{
+	const uint32_t sum = half + key;
+	return tables.bytes[0][sum >> 24] ^ tables.bytes[1][(sum >> 16) & 0xff] ^
+		tables.bytes[2][(sum >> 8) & 0xff] ^ tables.bytes[3][sum & 0xff];
+}
+
+// blocks_count BLOCK_SIZE-byte blocks through the 32 rounds keyed by keys in order (reversed for
+// decryption), input and output may be the same buffer
+inline void gost_crypt_blocks(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables)
+{
+	for (uint64_t block = 0; block < blocks_count; ++block)
+	{
+		const uint8_t* in = input + block * 8;
+		uint32_t a = (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | in[3];
+		uint32_t b = (uint32_t(in[4]) << 24) | (uint32_t(in[5]) << 16) | (uint32_t(in[6]) << 8) | in[7];
+
+		for (uint32_t round = 0; round < 32; ++round)
+		{
+			const uint32_t new_a = b ^ gost_round(a, keys[round], tables);
+			b = a;
+			a = new_a;
+		}
+
+		uint8_t* out = output + block * 8;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			out[i] = static_cast<uint8_t>(b >> (24 - 8 * i));
+			out[4 + i] = static_cast<uint8_t>(a >> (24 - 8 * i));
+		}
+	}
+}
+
+// one block of the MAC mode: state ^= block, then 16 rounds keyed k0..k7 twice with no swap at the end;
+// state holds a and b, the words of a block read big-endian
+inline void gost_mac_block(uint32_t state[2], const uint8_t block[8], const uint32_t keys[16],
+	const gost_round_tables& tables)
+{
+	uint32_t a = state[0] ^ ((uint32_t(block[0]) << 24) | (uint32_t(block[1]) << 16) | (uint32_t(block[2]) << 8) | block[3]);
+	uint32_t b = state[1] ^ ((uint32_t(block[4]) << 24) | (uint32_t(block[5]) << 16) | (uint32_t(block[6]) << 8) | block[7]);
+	for (uint32_t round = 0; round < 16; ++round)
+	{
+		const uint32_t new_a = b ^ gost_round(a, keys[round], tables);
+		b = a;
+		a = new_a;
+	}
+
+	state[0] = a;
+	state[1] = b;
+}
+
+using gost_crypt_function = void (*)(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables);
+
+// the same rounds on GOST_AVX2_LANES (GOST_AVX512_LANES) blocks per step with vpgatherdd doing the lookups,
+// a tail of fewer blocks goes through gost_crypt_blocks; x86 builds only, picked through a kernel_table
+void gost_crypt_blocks_avx2(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables);
+void gost_crypt_blocks_avx512(const uint8_t* input, uint8_t* output, uint64_t blocks_count,
+	const uint32_t keys[32], const gost_round_tables& tables);
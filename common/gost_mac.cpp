@@ -0,0 +1,98 @@
+#include "gost_mac.hpp"
+#include <algorithm>
+
+#include "gost_encrypter.hpp"
+#include "bit_utils.hpp"
+
+gost_mac::gost_mac(const std::string& key, gost_param_set set)
+	: _tables(&gost_get_round_tables(set))
+{
+	const std::string checked_key = _check_key(key);
+	for (uint32_t round = 0; round < 16; ++round)
+	{
+		_keys.push_back(bit_utils::string_to_int32(checked_key.substr(round % 8 * 4, 4)));
+	}
+
+	reset();
+}
+
+void gost_mac::update(const std::string& data)
+{
+	uint64_t offset = 0;
+	if (!_partial.empty())
+	{
+		offset = std::min<uint64_t>(data.size(), BLOCK_SIZE - _partial.size());
+		_partial += data.substr(0, offset);
+		if (_partial.size() < BLOCK_SIZE)
+		{
+			return;
+		}
+
+		gost_mac_block(_state, reinterpret_cast<const uint8_t*>(_partial.data()), _keys.data(), *_tables);
+		++_blocks_count;
+		_partial.clear();
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+	for (; offset + BLOCK_SIZE <= data.size(); offset += BLOCK_SIZE)
+	{
+		gost_mac_block(_state, bytes + offset, _keys.data(), *_tables);
+		++_blocks_count;
+	}
+
+	_partial = data.substr(offset);
+}
+
+std::string gost_mac::finalize() const
+{
+	uint32_t state[2] = { _state[0], _state[1] };
+	uint64_t blocks_count = _blocks_count;
+
+	uint8_t block[BLOCK_SIZE] = {};
+	if (!_partial.empty())
+	{
+		std::copy(_partial.begin(), _partial.end(), block);
+		gost_mac_block(state, block, _keys.data(), *_tables);
+		++blocks_count;
+	}
+
+	if (blocks_count == 1)
+	{
+		std::fill(block, block + BLOCK_SIZE, 0);
+		gost_mac_block(state, block, _keys.data(), *_tables);
+	}
+
+	return bit_utils::int32_to_string(state[0]);
+}
+
+void gost_mac::reset()
+{
+	_state[0] = 0;
+	_state[1] = 0;
+	_partial.clear();
+	_blocks_count = 0;
+}
+
+std::string gost_mac::generate_mac(const std::string& message) const
+{
+	gost_mac mac = *this;
+	mac.reset();
+	mac.update(message);
+
+	return mac.finalize();
+}
+
+std::string gost_mac::_check_key(const std::string& key)
+{
+	if (key.size() < KEY_LENGTH)
+	{
+		throw invalid_key();
+	}
+
+	return key.substr(0, KEY_LENGTH);
+}
+
+const char* gost_mac::invalid_key::what() const throw ()
+{
+	return "Invalid key! Key should be no less than 32 chars";
+}
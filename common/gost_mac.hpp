@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "gost_kernel.hpp"
+#include "gost_param_set.hpp"
+
+// the MAC (imitovstavka) is the first 32-bit word of the final state
+constexpr uint32_t GOST_MAC_SIZE = 4;
+
+/*
+  MAC mode of GOST 28147-89, fed a piece at a time: each 8-byte block is xored into the state and
+  put through 16 rounds keyed k0..k7 twice. A partial last block is padded with zeros and a message of
+  one block gets a zero block after it, as OpenSSL's ccgost does; words are read big-endian as in
+  gost_encrypter
+*/
+class gost_mac
+{
+public:
+	struct invalid_key : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	gost_mac(const std::string& key, gost_param_set set = gost_param_set::legacy);
+	~gost_mac() = default;
+
+	// any split of a message over calls gives the same MAC
+	void update(const std::string& data);
+	// GOST_MAC_SIZE bytes over everything fed since construction or reset, which update may continue
+	std::string finalize() const;
+	void reset();
+
+	// the MAC of message alone, the state of the instance is left as it is
+	std::string generate_mac(const std::string& message) const;
+
+private:
+	static std::string _check_key(const std::string& key);
+
+	const gost_round_tables* _tables;
+	// k0..k7 twice
+	std::vector<uint32_t> _keys;
+
+	uint32_t _state[2];
+	// bytes fed after the last whole block
+	std::string _partial;
+	uint64_t _blocks_count;
+};
@@ -0,0 +1,167 @@
+#include "gost_param_set.hpp"
+
+namespace _gost_utils
+{
+	constexpr gost_s_box LEGACY =
+	{{
+		{13, 4, 6, 2, 11, 5, 12, 9, 15, 8, 14, 7, 0, 3, 0, 1},
+		{6, 8, 2, 3, 9, 11, 5, 13, 1, 15, 4, 7, 12, 14, 0, 0},
+		{12, 3, 5, 8, 2, 0, 11, 14, 15, 1, 7, 4, 13, 9, 6, 0},
+		{13, 8, 2, 1, 14, 4, 0, 6, 7, 0, 11, 5, 3, 15, 9, 12},
+		{7, 0, 5, 11, 8, 1, 6, 14, 0, 9, 3, 15, 12, 4, 2, 13},
+		{5, 14, 0, 6, 9, 2, 13, 11, 12, 7, 8, 1, 4, 3, 15, 0},
+		{8, 15, 2, 5, 6, 9, 1, 13, 0, 4, 12, 0, 14, 11, 3, 7},
+		{1, 7, 15, 14, 0, 5, 8, 3, 4, 0, 11, 6, 9, 13, 12, 2},
+	}};
+
+	constexpr gost_s_box TC26_Z =
+	{{
+		{1, 7, 14, 13, 0, 5, 8, 3, 4, 15, 10, 6, 9, 12, 11, 2},
+		{8, 14, 2, 5, 6, 9, 1, 12, 15, 4, 11, 0, 13, 10, 3, 7},
+		{5, 13, 15, 6, 9, 2, 12, 10, 11, 7, 8, 1, 4, 3, 14, 0},
+		{7, 15, 5, 10, 8, 1, 6, 13, 0, 9, 3, 14, 11, 4, 2, 12},
+		{12, 8, 2, 1, 13, 4, 15, 6, 7, 0, 10, 5, 3, 14, 9, 11},
+		{11, 3, 5, 8, 2, 15, 10, 13, 14, 1, 7, 4, 12, 9, 6, 0},
+		{6, 8, 2, 3, 9, 10, 5, 12, 1, 14, 4, 7, 11, 13, 0, 15},
+		{12, 4, 6, 2, 10, 5, 11, 9, 14, 8, 13, 7, 0, 3, 15, 1},
+	}};
+
+	constexpr gost_s_box CRYPTOPRO_A =
+	{{
+		{11, 10, 15, 5, 0, 12, 14, 8, 6, 2, 3, 9, 1, 7, 13, 4},
+		{1, 13, 2, 9, 7, 10, 6, 0, 8, 12, 4, 5, 15, 3, 11, 14},
+		{3, 10, 13, 12, 1, 2, 0, 11, 7, 5, 9, 4, 8, 15, 14, 6},
+		{11, 5, 1, 9, 8, 13, 15, 0, 14, 4, 2, 3, 12, 7, 10, 6},
+		{14, 7, 10, 12, 13, 1, 3, 9, 0, 2, 11, 4, 15, 8, 5, 6},
+		{14, 4, 6, 2, 11, 3, 13, 8, 12, 15, 5, 10, 0, 7, 1, 9},
+		{3, 7, 14, 9, 8, 10, 15, 0, 5, 2, 6, 12, 11, 4, 13, 1},
+		{9, 6, 3, 2, 8, 11, 1, 7, 10, 4, 14, 15, 12, 0, 13, 5},
+	}};
+
+	constexpr gost_s_box CRYPTOPRO_B =
+	{{
+		{0, 4, 11, 14, 8, 3, 7, 1, 10, 2, 9, 6, 15, 13, 5, 12},
+		{5, 2, 10, 11, 9, 1, 12, 3, 7, 4, 13, 0, 6, 15, 8, 14},
+		{8, 3, 2, 6, 4, 13, 14, 11, 12, 1, 7, 15, 10, 0, 9, 5},
+		{2, 7, 12, 15, 9, 5, 10, 11, 1, 4, 0, 13, 6, 8, 14, 3},
+		{7, 5, 0, 13, 11, 6, 1, 2, 3, 10, 12, 15, 4, 14, 9, 8},
+		{14, 12, 0, 10, 9, 2, 13, 11, 7, 5, 8, 15, 3, 6, 1, 4},
+		{0, 1, 2, 10, 4, 13, 5, 12, 9, 7, 3, 15, 11, 8, 6, 14},
+		{8, 4, 11, 1, 3, 5, 0, 9, 2, 14, 10, 12, 13, 6, 7, 15},
+	}};
+
+	constexpr gost_s_box CRYPTOPRO_C =
+	{{
+		{7, 4, 0, 5, 10, 2, 15, 14, 12, 6, 1, 11, 13, 9, 3, 8},
+		{10, 9, 6, 8, 13, 14, 2, 0, 15, 3, 5, 11, 4, 1, 12, 7},
+		{12, 9, 11, 1, 8, 14, 2, 4, 7, 3, 6, 5, 10, 0, 15, 13},
+		{8, 13, 11, 0, 4, 5, 1, 2, 9, 3, 12, 14, 6, 15, 10, 7},
+		{3, 6, 0, 1, 5, 13, 10, 8, 11, 2, 9, 7, 14, 15, 12, 4},
+		{8, 2, 5, 0, 4, 9, 15, 10, 3, 7, 12, 13, 6, 14, 1, 11},
+		{0, 1, 7, 13, 11, 4, 5, 2, 8, 14, 15, 12, 9, 10, 6, 3},
+		{1, 11, 12, 2, 9, 13, 0, 15, 4, 5, 8, 14, 10, 7, 6, 3},
+	}};
+
+	constexpr gost_s_box CRYPTOPRO_D =
+	{{
+		{1, 10, 6, 8, 15, 11, 0, 4, 12, 3, 5, 9, 7, 13, 2, 14},
+		{3, 0, 6, 15, 1, 14, 9, 2, 13, 8, 12, 4, 11, 10, 5, 7},
+		{8, 0, 15, 3, 2, 5, 14, 11, 1, 10, 4, 7, 12, 9, 13, 6},
+		{0, 12, 8, 9, 13, 2, 10, 11, 7, 3, 6, 5, 4, 14, 15, 1},
+		{1, 5, 14, 12, 10, 7, 0, 13, 6, 2, 11, 4, 9, 3, 15, 8},
+		{1, 12, 11, 0, 15, 14, 6, 5, 10, 13, 4, 8, 9, 3, 7, 2},
+		{11, 6, 3, 4, 12, 15, 14, 2, 7, 13, 8, 0, 5, 10, 9, 1},
+		{15, 12, 2, 10, 6, 4, 5, 0, 7, 9, 14, 13, 1, 11, 8, 3},
+	}};
+
+	constexpr gost_s_box R3411_94_TEST =
+	{{
+		{1, 15, 13, 0, 5, 7, 10, 4, 9, 2, 3, 14, 6, 11, 8, 12},
+		{13, 11, 4, 1, 3, 15, 5, 9, 0, 10, 14, 7, 6, 8, 2, 12},
+		{4, 11, 10, 0, 7, 2, 1, 13, 3, 6, 8, 5, 9, 12, 15, 14},
+		{6, 12, 7, 1, 5, 15, 13, 8, 4, 10, 9, 14, 0, 3, 11, 2},
+		{7, 13, 10, 1, 0, 8, 9, 15, 14, 4, 6, 12, 11, 2, 5, 3},
+		{5, 8, 1, 13, 10, 3, 4, 2, 14, 15, 12, 7, 6, 0, 9, 11},
+		{14, 11, 4, 12, 6, 13, 15, 10, 2, 3, 8, 1, 0, 7, 5, 9},
+		{4, 10, 9, 2, 13, 8, 0, 14, 6, 11, 1, 12, 7, 15, 5, 3},
+	}};
+
+	constexpr gost_s_box R3411_94_CRYPTOPRO =
+	{{
+		{1, 3, 10, 9, 5, 11, 4, 15, 8, 6, 7, 14, 13, 0, 2, 12},
+		{13, 14, 4, 1, 7, 0, 5, 10, 3, 12, 8, 15, 6, 2, 9, 11},
+		{7, 6, 2, 4, 13, 9, 15, 0, 10, 1, 5, 11, 8, 14, 12, 3},
+		{7, 6, 4, 11, 9, 12, 2, 10, 1, 8, 0, 14, 15, 13, 3, 5},
+		{4, 10, 7, 12, 0, 15, 2, 8, 14, 1, 6, 5, 13, 11, 9, 3},
+		{7, 15, 12, 14, 9, 4, 1, 0, 3, 11, 5, 2, 6, 10, 8, 13},
+		{5, 15, 4, 0, 2, 13, 11, 9, 1, 7, 6, 3, 12, 14, 10, 8},
+		{10, 4, 5, 6, 8, 1, 3, 7, 13, 12, 14, 0, 9, 2, 11, 15},
+	}};
+
+	constexpr gost_s_box S_BOXES[GOST_PARAM_SETS_COUNT] =
+	{
+		LEGACY, TC26_Z, CRYPTOPRO_A, CRYPTOPRO_B, CRYPTOPRO_C, CRYPTOPRO_D, R3411_94_TEST, R3411_94_CRYPTOPRO,
+	};
+
+	constexpr bool is_permutation(const gost_s_box& s_box)
+	{
+		for (const auto& row : s_box)
+		{
+			uint32_t seen = 0;
+			for (uint8_t value : row)
+			{
+				seen |= 1u << value;
+			}
+			if (seen != 0xffff)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static_assert(!is_permutation(LEGACY), "the legacy set is the mis-transcribed one");
+	static_assert(is_permutation(TC26_Z) && is_permutation(CRYPTOPRO_A) && is_permutation(CRYPTOPRO_B) &&
+		is_permutation(CRYPTOPRO_C) && is_permutation(CRYPTOPRO_D) && is_permutation(R3411_94_TEST) &&
+		is_permutation(R3411_94_CRYPTOPRO), "every row of a standard S-box is a permutation of 0..15");
+
+	constexpr gost_round_tables build_round_tables(const gost_s_box& s_box)
+	{
+		gost_round_tables tables = {};
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			const uint32_t shift = 24 - 8 * i;
+			for (uint32_t value = 0; value < 256; ++value)
+			{
+				const uint32_t substituted = (uint32_t(s_box[2 * i][value >> 4]) << 4) | s_box[2 * i + 1][value & 0x0f];
+				const uint32_t placed = substituted << shift;
+				tables.bytes[i][value] = (placed << 11) | (placed >> 21);
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr gost_round_tables ROUND_TABLES[GOST_PARAM_SETS_COUNT] =
+	{
+		build_round_tables(LEGACY),
+		build_round_tables(TC26_Z),
+		build_round_tables(CRYPTOPRO_A),
+		build_round_tables(CRYPTOPRO_B),
+		build_round_tables(CRYPTOPRO_C),
+		build_round_tables(CRYPTOPRO_D),
+		build_round_tables(R3411_94_TEST),
+		build_round_tables(R3411_94_CRYPTOPRO),
+	};
+}
+
+const gost_s_box& gost_get_s_box(gost_param_set set)
+{
+	return _gost_utils::S_BOXES[static_cast<uint32_t>(set)];
+}
+
+const gost_round_tables& gost_get_round_tables(gost_param_set set)
+{
+	return _gost_utils::ROUND_TABLES[static_cast<uint32_t>(set)];
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "gost_kernel.hpp"
+
+// eight 4-bit S-boxes, row j substituting the j-th nibble counted from the most significant end
+// (K8 first in the numbering of the standard)
+using gost_s_box = std::array<std::array<uint8_t, 16>, 8>;
+
+/*
+  S-box parameter sets of GOST 28147-89. Each has its round tables (gost_kernel.hpp) expanded at
+  compile time, so every kernel runs the same for all of them. The standard sets agree with
+  OpenSSL's ccgost engine once each 32-bit word of key, input and output is byte-reversed: this
+  implementation reads words big-endian. gost_hash runs them in the byte order of GOST R 34.11-94
+*/
+enum class gost_param_set
+{
+	// what gost_encrypter and gost_hash always used: param-Z transcribed with shifted values and
+	// its rows in reverse order. Not a permutation in every row; kept so earlier output still decrypts
+	legacy = 0,
+	// id-tc26-gost-28147-param-Z of RFC 7836, the S-boxes of Magma (GOST R 34.12-2015); Magma
+	// vectors match with the two halves of the block swapped on input and output
+	tc26_z,
+	// id-Gost28147-89-CryptoPro-A..D-ParamSet of RFC 4357
+	cryptopro_a,
+	cryptopro_b,
+	cryptopro_c,
+	cryptopro_d,
+	// id-GostR3411-94-TestParamSet, the examples of GOST R 34.11-94
+	r3411_94_test,
+	// id-GostR3411-94-CryptoProParamSet of RFC 4357
+	r3411_94_cryptopro,
+};
+
+constexpr uint32_t GOST_PARAM_SETS_COUNT = 8;
+
+const gost_s_box& gost_get_s_box(gost_param_set set);
+const gost_round_tables& gost_get_round_tables(gost_param_set set);
@@ -0,0 +1,105 @@
+#include "hmac_drbg.hpp"
+#include <random>
+
+const uint8_t HMAC_INNER_PAD = 0x36;
+const uint8_t HMAC_OUTER_PAD = 0x5c;
+
+hmac_drbg::hmac_drbg(const gost_hash& hash, const std::string& seed_material)
+	: _hash(hash)
+	, _key(HASH_BLOCK_SIZE, '\x00')
+	, _value(HASH_BLOCK_SIZE, '\x01')
+{
+	_update(seed_material);
+}
+
+std::string hmac_drbg::generate(uint64_t bytes_count)
+{
+	std::string result;
+	result.reserve(bytes_count + HASH_BLOCK_SIZE);
+	while (result.size() < bytes_count)
+	{
+		_value = hmac(_hash, _key, _value);
+		result += _value;
+	}
+
+	_update(std::string());
+
+	result.resize(bytes_count);
+	return result;
+}
+
+void hmac_drbg::reseed(const std::string& seed_material)
+{
+	_update(seed_material);
+}
+
+big_unsigned hmac_drbg::generate_below(const big_unsigned& module)
+{
+	while (true)
+	{
+		big_unsigned value = bits_to_int(generate(big_unsigned_bytes_count(module)), module);
+		if (!value.isZero() && value < module)
+		{
+			return value;
+		}
+	}
+}
+
+big_unsigned hmac_drbg::bits_to_int(const std::string& bits, const big_unsigned& module)
+{
+	big_unsigned value = bytes_to_big_unsigned(bits);
+	const uint64_t bits_count = bits.size() * CHAR_BIT;
+	if (bits_count > module.bitLength())
+	{
+		value >>= static_cast<int>(bits_count - module.bitLength());
+	}
+
+	return value;
+}
+
+std::string hmac_drbg::int_to_octets(const big_unsigned& x, const big_unsigned& module)
+{
+	return big_unsigned_to_bytes(x, big_unsigned_bytes_count(module));
+}
+
+std::string hmac_drbg::get_entropy(uint64_t bytes_count)
+{
+	std::random_device device;
+	std::string entropy;
+	entropy.reserve(bytes_count);
+	for (uint64_t i = 0; i < bytes_count; ++i)
+	{
+		entropy += static_cast<char>(device() & 0xff);
+	}
+
+	return entropy;
+}
+
+std::string hmac_drbg::hmac(const gost_hash& hash, const std::string& key, const std::string& message)
+{
+	std::string block_key = key.size() > HASH_BLOCK_SIZE ? hash.generate_hash(key) : key;
+	block_key.resize(HASH_BLOCK_SIZE, '\0');
+
+	std::string inner_key = block_key;
+	std::string outer_key = block_key;
+	for (uint32_t i = 0; i < HASH_BLOCK_SIZE; ++i)
+	{
+		inner_key[i] ^= HMAC_INNER_PAD;
+		outer_key[i] ^= HMAC_OUTER_PAD;
+	}
+
+	return hash.generate_hash(outer_key + hash.generate_hash(inner_key + message));
+}
+
+void hmac_drbg::_update(const std::string& provided_data)
+{
+	_key = hmac(_hash, _key, _value + '\x00' + provided_data);
+	_value = hmac(_hash, _key, _value);
+	if (provided_data.empty())
+	{
+		return;
+	}
+
+	_key = hmac(_hash, _key, _value + '\x01' + provided_data);
+	_value = hmac(_hash, _key, _value);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include "gost_hash.hpp"
+#include "big_integer.hpp"
+
+// bytes of entropy get_entropy() is asked for when seeding a generator that must not repeat itself
+constexpr uint64_t DRBG_SEED_SIZE = 32;
+
+/*
+  HMAC_DRBG of NIST SP 800-90A over HMAC with gost_hash (blocks of HASH_BLOCK_SIZE bytes). Instantiated
+  from int2octets(x) || bits2octets(h) and read rlen bytes at a time, it is the deterministic nonce
+  generator of RFC 6979: the update after every generate call is the retry step of section 3.2 h.3
+*/
+class hmac_drbg
+{
+public:
+	// K = 0x00.., V = 0x01.., then update(seed_material)
+	hmac_drbg(const gost_hash& hash, const std::string& seed_material);
+	~hmac_drbg() = default;
+
+	// bytes_count pseudorandom bytes, followed by an update without data
+	std::string generate(uint64_t bytes_count);
+	void reseed(const std::string& seed_material);
+	// a value in [1, module): bits_to_int of generate(bytes of module), out of range ones skipped as in RFC 6979 3.2 h.3
+	big_unsigned generate_below(const big_unsigned& module);
+
+	// bits2int of RFC 6979: the leftmost bits of the string, as many as module has
+	static big_unsigned bits_to_int(const std::string& bits, const big_unsigned& module);
+	// int2octets of RFC 6979: x as many big-endian bytes as module takes
+	static std::string int_to_octets(const big_unsigned& x, const big_unsigned& module);
+
+	// bytes_count bytes of std::random_device
+	static std::string get_entropy(uint64_t bytes_count);
+
+	// HMAC of RFC 2104, keys longer than a block are hashed first
+	static std::string hmac(const gost_hash& hash, const std::string& key, const std::string& message);
+
+private:
+	void _update(const std::string& provided_data);
+
+	gost_hash _hash;
+	std::string _key;
+	std::string _value;
+};
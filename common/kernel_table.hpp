@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "cpu_features.hpp"
+
+/*
+  One function pointer per cpu_features::isa tier for a primitive, nullptr where the primitive has
+  no variant of its own at that tier. A table is an aggregate of constants, so it needs no static
+  initializer; the scalar entry always exists and is what every lookup falls back to
+*/
+template <typename Function>
+struct kernel_table
+{
+	Function variants[cpu_features::ISA_COUNT];
+
+	// the highest tier at or below level that has a variant and runs on this CPU
+	cpu_features::isa select(cpu_features::isa level) const
+	{
+		for (uint32_t i = static_cast<uint32_t>(level); i > 0; --i)
+		{
+			const auto tier = static_cast<cpu_features::isa>(i);
+			if (variants[i] != nullptr && cpu_features::is_supported(tier))
+			{
+				return tier;
+			}
+		}
+
+		return cpu_features::isa::scalar;
+	}
+
+	Function get(cpu_features::isa level) const
+	{
+		return variants[static_cast<uint32_t>(select(level))];
+	}
+
+	// every tier with a variant of its own this CPU runs, scalar first, for cross-checking them
+	std::vector<cpu_features::isa> get_supported() const
+	{
+		std::vector<cpu_features::isa> tiers;
+		for (uint32_t i = 0; i < cpu_features::ISA_COUNT; ++i)
+		{
+			const auto tier = static_cast<cpu_features::isa>(i);
+			if (variants[i] != nullptr && cpu_features::is_supported(tier))
+			{
+				tiers.push_back(tier);
+			}
+		}
+
+		return tiers;
+	}
+};
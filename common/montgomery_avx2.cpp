@@ -0,0 +1,18 @@
+#include "cpu_features.hpp"
+#include "big_integer.hpp"
+
+#if defined(CRYPTO_X86)
+// unlike the other kernel files the header goes below the pragma: its loop is static, and this
+// private copy is the one meant to be compiled with mulx
+#if defined(__GNUC__)
+#pragma GCC target("avx2,bmi2")
+#endif
+
+#include "montgomery_kernel.hpp"
+
+void montgomery_multiply_avx2(const montgomery_block* first, const montgomery_block* second,
+	const montgomery_block* module, uint64_t blocks_count, montgomery_block module_inv, montgomery_block* t)
+{
+	montgomery_multiply_blocks(first, second, module, blocks_count, module_inv, t);
+}
+#endif
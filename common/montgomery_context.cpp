@@ -0,0 +1,228 @@
+#include "montgomery_context.hpp"
+#include <vector>
+#include <algorithm>
+
+#include "kernel_table.hpp"
+
+namespace _montgomery_utils
+{
+	void multiply_portable(const montgomery_block* first, const montgomery_block* second,
+		const montgomery_block* module, uint64_t blocks_count, montgomery_block module_inv, montgomery_block* t)
+	{
+		montgomery_multiply_blocks(first, second, module, blocks_count, module_inv, t);
+	}
+
+#if defined(CRYPTO_X86)
+	constexpr kernel_table<montgomery_multiply_function> KERNELS = { { multiply_portable, nullptr, montgomery_multiply_avx2, nullptr } };
+#else
+	constexpr kernel_table<montgomery_multiply_function> KERNELS = { { multiply_portable } };
+#endif
+
+	// the low blocks_count blocks of value, zero-padded
+	void load_blocks(const big_unsigned& value, big_unsigned::Index blocks_count, std::vector<montgomery_block>& blocks)
+	{
+		blocks.resize(blocks_count);
+		for (big_unsigned::Index i = 0; i < blocks_count; ++i)
+		{
+			blocks[i] = value.getBlock(i);
+		}
+	}
+}
+
+std::vector<cpu_features::isa> montgomery_context::get_kernels()
+{
+	return _montgomery_utils::KERNELS.get_supported();
+}
+
+montgomery_context::montgomery_context(const big_unsigned& module, cpu_features::isa level)
+	: _kernel(_montgomery_utils::KERNELS.select(level))
+	, _multiply(_montgomery_utils::KERNELS.get(level))
+	, _module(module)
+	, _blocks_count(module.getLength())
+{
+	if (!module.getBit(0))
+	{
+		throw even_module();
+	}
+	if (!cpu_features::is_supported(level))
+	{
+		throw unsupported_kernel();
+	}
+	_montgomery_utils::load_blocks(module, _blocks_count, _module_blocks);
+
+	// Newton iteration for m^-1 mod 2^N, every step doubles the count of correct low bits
+	const big_unsigned::Blk m_0 = module.getBlock(0);
+	big_unsigned::Blk inv = 1;
+	for (unsigned int bits = 1; bits < big_unsigned::N; bits *= 2)
+	{
+		inv *= 2 - m_0 * inv;
+	}
+	_module_inv = big_unsigned::Blk(0) - inv;
+
+	const big_unsigned r = big_unsigned(1) << static_cast<int>(_blocks_count * big_unsigned::N);
+	_r = r % _module;
+	_r_2 = (_r * _r) % _module;
+	_r_3 = (_r_2 * _r) % _module;
+}
+
+big_unsigned montgomery_context::to_montgomery(const big_unsigned& x) const
+{
+	if (x < _module)
+	{
+		return multiply(x, _r_2);
+	}
+
+	return multiply(x % _module, _r_2);
+}
+
+big_unsigned montgomery_context::from_montgomery(const big_unsigned& x) const
+{
+	return multiply(x, 1);
+}
+
+big_unsigned montgomery_context::multiply(const big_unsigned& first, const big_unsigned& second) const
+{
+	const big_unsigned::Index n = _blocks_count;
+
+	// reused between calls, so a multiplication only allocates its result
+	thread_local std::vector<montgomery_block> first_blocks, second_blocks, t;
+	_montgomery_utils::load_blocks(first, n, first_blocks);
+	_montgomery_utils::load_blocks(second, n, second_blocks);
+	t.resize(n + 2);
+
+	_multiply(first_blocks.data(), second_blocks.data(), _module_blocks.data(), n, _module_inv, t.data());
+
+	big_unsigned result(t.data(), n + 1);
+	if (result >= _module)
+	{
+		result -= _module;
+	}
+
+	return result;
+}
+
+big_unsigned montgomery_context::square(const big_unsigned& x) const
+{
+	return multiply(x, x);
+}
+
+big_unsigned montgomery_context::inverse(const big_unsigned& x) const
+{
+	// modinv(x R) == x^-1 R^-1, one more R^2 brings it back to montgomery form
+	return multiply(modinv(x, _module), _r_3);
+}
+
+big_unsigned montgomery_context::exp(const big_unsigned& base, const big_unsigned& exponent) const
+{
+	constexpr unsigned int window_bits = 4;
+	constexpr unsigned int window_size = 1 << window_bits;
+
+	big_unsigned table[window_size];
+	table[0] = _r;
+	table[1] = to_montgomery(base);
+	for (unsigned int i = 2; i < window_size; ++i)
+	{
+		table[i] = multiply(table[i - 1], table[1]);
+	}
+
+	big_unsigned result = _r;
+	big_unsigned::Index bit = (exponent.bitLength() + window_bits - 1) / window_bits * window_bits;
+	while (bit > 0)
+	{
+		bit -= window_bits;
+
+		unsigned int digit = 0;
+		for (unsigned int i = window_bits; i > 0; --i)
+		{
+			result = square(result);
+			digit = (digit << 1) | (exponent.getBit(bit + i - 1) ? 1 : 0);
+		}
+
+		if (digit != 0)
+		{
+			result = multiply(result, table[digit]);
+		}
+	}
+
+	return from_montgomery(result);
+}
+
+big_unsigned montgomery_context::dual_exp(
+	const big_unsigned& base1, 
+	const big_unsigned& exponent1, 
+	const big_unsigned& base2, 
+	const big_unsigned& exponent2) const
+{
+	constexpr unsigned int window_bits = 2;
+	constexpr unsigned int window_size = 1 << window_bits;
+
+	// table[i * window_size + j] == base1^i * base2^j
+	big_unsigned table[window_size * window_size];
+	table[0] = _r;
+	table[1] = to_montgomery(base2);
+	table[window_size] = to_montgomery(base1);
+	for (unsigned int j = 2; j < window_size; ++j)
+	{
+		table[j] = multiply(table[j - 1], table[1]);
+	}
+	for (unsigned int i = 1; i < window_size; ++i)
+	{
+		if (i > 1)
+		{
+			table[i * window_size] = multiply(table[(i - 1) * window_size], table[window_size]);
+		}
+		for (unsigned int j = 1; j < window_size; ++j)
+		{
+			table[i * window_size + j] = multiply(table[i * window_size], table[j]);
+		}
+	}
+
+	big_unsigned result = _r;
+	const big_unsigned::Index bits = std::max(exponent1.bitLength(), exponent2.bitLength());
+	big_unsigned::Index bit = (bits + window_bits - 1) / window_bits * window_bits;
+	while (bit > 0)
+	{
+		bit -= window_bits;
+
+		unsigned int digit1 = 0;
+		unsigned int digit2 = 0;
+		for (unsigned int i = window_bits; i > 0; --i)
+		{
+			result = square(result);
+			digit1 = (digit1 << 1) | (exponent1.getBit(bit + i - 1) ? 1 : 0);
+			digit2 = (digit2 << 1) | (exponent2.getBit(bit + i - 1) ? 1 : 0);
+		}
+
+		if (digit1 != 0 || digit2 != 0)
+		{
+			result = multiply(result, table[digit1 * window_size + digit2]);
+		}
+	}
+
+	return from_montgomery(result);
+}
+
+const big_unsigned& montgomery_context::get_one() const
+{
+	return _r;
+}
+
+const big_unsigned& montgomery_context::get_module() const
+{
+	return _module;
+}
+
+cpu_features::isa montgomery_context::get_kernel() const
+{
+	return _kernel;
+}
+
+const char* montgomery_context::even_module::what() const throw ()
+{
+	return "Montgomery reduction needs an odd module!";
+}
+
+const char* montgomery_context::unsupported_kernel::what() const throw ()
+{
+	return "The CPU does not support the requested montgomery multiplication kernel!";
+}
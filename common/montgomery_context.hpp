@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "big_integer.hpp"
+#include "cpu_features.hpp"
+#include "montgomery_kernel.hpp"
+
+/*
+  Montgomery arithmetic modulo an odd module m with R = 2^(N * blocks of m). Values in montgomery form
+  are x * R mod m; multiply() works on the limbs directly (CIOS) and replaces the bit-by-bit division
+  behind % with one extra multiplication per limb. Building the context divides once, so it is meant
+  to be created once per module and shared. The limb loop is picked per cpu_features::isa tier,
+  see montgomery_kernel.hpp.
+*/
+class montgomery_context
+{
+public:
+	struct even_module : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	struct unsupported_kernel : public std::exception
+	{
+		const char* what() const throw ();
+	};
+
+	// the tiers with a multiplication loop of their own this CPU runs
+	static std::vector<cpu_features::isa> get_kernels();
+
+	// multiplies with the best loop at or below level, throws unsupported_kernel for a level this CPU lacks
+	explicit montgomery_context(const big_unsigned& module, cpu_features::isa level = cpu_features::get_isa());
+	~montgomery_context() = default;
+
+	// any x, reduced first
+	big_unsigned to_montgomery(const big_unsigned& x) const;
+	big_unsigned from_montgomery(const big_unsigned& x) const;
+
+	// both operands in montgomery form and below the module
+	big_unsigned multiply(const big_unsigned& first, const big_unsigned& second) const;
+	big_unsigned square(const big_unsigned& x) const;
+	// montgomery form of x^-1 for x in montgomery form
+	big_unsigned inverse(const big_unsigned& x) const;
+
+	// plain base ^ exponent % module, computed in montgomery form over 4-bit windows
+	big_unsigned exp(const big_unsigned& base, const big_unsigned& exponent) const;
+	// plain base1 ^ exponent1 * base2 ^ exponent2 % module, one shared chain of squarings over 2-bit
+	// joint windows (Straus-Shamir) as in dual_modexp
+	big_unsigned dual_exp(
+		const big_unsigned& base1, 
+		const big_unsigned& exponent1, 
+		const big_unsigned& base2, 
+		const big_unsigned& exponent2) const;
+
+	// montgomery form of 1
+	const big_unsigned& get_one() const;
+	const big_unsigned& get_module() const;
+	cpu_features::isa get_kernel() const;
+
+private:
+	cpu_features::isa _kernel;
+	montgomery_multiply_function _multiply;
+
+	big_unsigned _module;
+	big_unsigned::Index _blocks_count;
+	std::vector<montgomery_block> _module_blocks;
+	// -m^-1 mod 2^N
+	big_unsigned::Blk _module_inv;
+
+	big_unsigned _r;
+	big_unsigned _r_2;
+	big_unsigned _r_3;
+};
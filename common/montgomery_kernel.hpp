@@ -0,0 +1,99 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+
+#include "big_integer.hpp"
+
+/*
+  The CIOS loop behind montgomery_context::multiply on raw limbs. The functions here are static, so
+  every file including this one compiles a private copy for its own target: montgomery_avx2.cpp
+  includes it after its target pragma and gets mulx from BMI2 without that copy ever replacing the
+  portable one elsewhere
+*/
+using montgomery_block = big_unsigned::Blk;
+
+// t (blocks_count + 2 blocks) = first * second * 2^(-N * blocks_count) mod module, possibly plus module;
+// first and second are zero-padded to blocks_count blocks
+using montgomery_multiply_function = void (*)(const montgomery_block* first, const montgomery_block* second,
+	const montgomery_block* module, uint64_t blocks_count, montgomery_block module_inv, montgomery_block* t);
+
+// returns the high block of a * b + c + d and stores the low one, the sum always fits two blocks
+static inline montgomery_block montgomery_multiply_add(montgomery_block a, montgomery_block b,
+	montgomery_block c, montgomery_block d, montgomery_block& low)
+{
+	using block = montgomery_block;
+
+#if defined(__SIZEOF_INT128__)
+	if constexpr (sizeof(block) == 8)
+	{
+		__extension__ typedef unsigned __int128 wide_block;
+
+		const wide_block result = wide_block(a) * b + c + d;
+		low = static_cast<block>(result);
+		return static_cast<block>(result >> 64);
+	}
+#endif
+	// portable path, schoolbook on half blocks
+	constexpr unsigned int half_bits = sizeof(block) * CHAR_BIT / 2;
+	constexpr block half_mask = (block(1) << half_bits) - 1;
+
+	const block a_low = a & half_mask, a_high = a >> half_bits;
+	const block b_low = b & half_mask, b_high = b >> half_bits;
+
+	const block low_low = a_low * b_low;
+	const block low_high = a_low * b_high;
+	const block high_low = a_high * b_low;
+	const block high_high = a_high * b_high;
+
+	const block middle = (low_low >> half_bits) + (low_high & half_mask) + (high_low & half_mask);
+	block high = high_high + (low_high >> half_bits) + (high_low >> half_bits) + (middle >> half_bits);
+	low = (low_low & half_mask) | (middle << half_bits);
+
+	low += c;
+	high += low < c;
+	low += d;
+	high += low < d;
+
+	return high;
+}
+
+static inline void montgomery_multiply_blocks(const montgomery_block* first, const montgomery_block* second,
+	const montgomery_block* module, uint64_t blocks_count, montgomery_block module_inv, montgomery_block* t)
+{
+	using block = montgomery_block;
+
+	const uint64_t n = blocks_count;
+	for (uint64_t i = 0; i < n + 2; ++i)
+	{
+		t[i] = 0;
+	}
+
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		// t += first * second[i]
+		const block second_i = second[i];
+		block carry = 0;
+		for (uint64_t j = 0; j < n; ++j)
+		{
+			carry = montgomery_multiply_add(first[j], second_i, t[j], carry, t[j]);
+		}
+		t[n] += carry;
+		t[n + 1] = t[n] < carry;
+
+		// t = (t + m * module) / 2^N, with m chosen so the low block vanishes
+		const block m = t[0] * module_inv;
+		block low;
+		carry = montgomery_multiply_add(m, module[0], t[0], 0, low);
+		for (uint64_t j = 1; j < n; ++j)
+		{
+			carry = montgomery_multiply_add(m, module[j], t[j], carry, t[j - 1]);
+		}
+		t[n - 1] = t[n] + carry;
+		t[n] = t[n + 1] + (t[n - 1] < carry);
+	}
+}
+
+// the same loop built for AVX2 with BMI2; x86 builds only, picked through a kernel_table
+void montgomery_multiply_avx2(const montgomery_block* first, const montgomery_block* second,
+	const montgomery_block* module, uint64_t blocks_count, montgomery_block module_inv, montgomery_block* t);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "bounded_queue.hpp"
+
+// values a pool keeps when its owner does not say otherwise
+constexpr uint64_t DEFAULT_PRECOMPUTATION_CAPACITY = 64;
+
+/*
+  Values that do not depend on the request, generated ahead of time by one background thread.
+  Consumers take them from a bounded_queue without locking; once a take leaves refill_watermark
+  values or fewer the thread wakes up and fills the queue to its capacity again. generate must not
+  throw, it runs only on the background thread
+*/
+template <typename T>
+class precomputation_pool
+{
+public:
+	// capacity of at least 1, refill_watermark is capped below it
+	precomputation_pool(uint64_t capacity, uint64_t refill_watermark, std::function<T()> generate)
+		: _queue(capacity)
+		, _capacity(capacity)
+		, _refill_watermark(std::min(refill_watermark, capacity - 1))
+		, _generate(std::move(generate))
+		, _worker([this]() { _worker_loop(); })
+	{
+	}
+
+	// stops after the value being generated, the values left in the queue are dropped
+	~precomputation_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+
+		_condition.notify_one();
+		_worker.join();
+	}
+
+	precomputation_pool(const precomputation_pool&) = delete;
+	precomputation_pool& operator = (const precomputation_pool&) = delete;
+
+	// false when the pool has run dry, the caller computes the value itself then
+	bool try_take(T& value)
+	{
+		const bool taken = _queue.try_pop(value);
+		if (_queue.size() <= _refill_watermark)
+		{
+			// taking the lock orders the notification after the worker's check of the size, so it cannot be lost
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+			}
+
+			_condition.notify_one();
+		}
+
+		return taken;
+	}
+
+	uint64_t size() const
+	{
+		return _queue.size();
+	}
+
+private:
+	void _worker_loop()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_condition.wait(lock, [this]() { return _stopping || _queue.size() <= _refill_watermark; });
+
+			// the only producer: pops can only shrink the queue, so a push below the capacity never fails
+			while (!_stopping && _queue.size() < _capacity)
+			{
+				lock.unlock();
+				_queue.try_push(_generate());
+				lock.lock();
+			}
+
+			if (_stopping)
+			{
+				return;
+			}
+		}
+	}
+
+	bounded_queue<T> _queue;
+	const uint64_t _capacity;
+	const uint64_t _refill_watermark;
+	std::function<T()> _generate;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stopping = false;
+
+	// started last, once everything it touches is constructed
+	std::thread _worker;
+};
@@ -1,93 +1,273 @@
 #include "prime_utils.hpp"
 #include <random>
 #include <vector>
+#include <climits>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
 
-namespace prime_utils
+#include "montgomery_context.hpp"
+
+namespace _prime_utils
 {
-    // implement this someday to speedup and generate 2048 bit primes https://github.com/cslarsen/miller-rabin
-	bool is_prime(const big_unsigned &num, uint64_t tests_count /*= 10*/)
+	// odd primes below SMALL_PRIMES_LIMIT, sieved once on first use
+	const std::vector<uint32_t>& small_primes()
 	{
-		if (num == 2 || num == 3)
+		static const std::vector<uint32_t> primes = []()
+		{
+			std::vector<bool> composite(prime_utils::SMALL_PRIMES_LIMIT, false);
+			std::vector<uint32_t> result;
+			for (uint32_t i = 3; i < prime_utils::SMALL_PRIMES_LIMIT; i += 2)
+			{
+				if (composite[i])
+				{
+					continue;
+				}
+
+				result.push_back(i);
+				for (uint64_t j = uint64_t(i) * i; j < prime_utils::SMALL_PRIMES_LIMIT; j += 2 * i)
+				{
+					composite[j] = true;
+				}
+			}
+
+			return result;
+		}();
+
+		return primes;
+	}
+
+	// num % divisor for a divisor below 2^32, folding the limbs in from the top 32 bits at a time
+	uint32_t mod_small(const big_unsigned& num, uint32_t divisor)
+	{
+		uint64_t remainder = 0;
+		for (big_unsigned::Index i = num.getLength(); i > 0; --i)
+		{
+			const big_unsigned::Blk block = num.getBlock(i - 1);
+			for (int32_t shift = static_cast<int32_t>(big_unsigned::N) - 32; shift >= 0; shift -= 32)
+			{
+				remainder = ((remainder << 32) | ((block >> shift) & 0xffffffffu)) % divisor;
+			}
+		}
+
+		return static_cast<uint32_t>(remainder);
+	}
+
+	// one Miller-Rabin round with witness a, num - 1 == r * 2^s with r odd
+	bool miller_rabin_round(
+		const montgomery_context& context, 
+		const big_unsigned& a, 
+		const big_unsigned& r, 
+		big_unsigned::Index s)
+	{
+		const big_unsigned& num = context.get_module();
+		big_unsigned x = context.exp(a, r);
+		if (x == 1 || x == num - 1)
 		{
 			return true;
 		}
-		else if (num <= 1 || num % 2 == 0)
+
+		// squarings stay in montgomery form, compared against the forms of 1 and num - 1
+		const big_unsigned& one = context.get_one();
+		const big_unsigned minus_one = num - one;
+		x = context.to_montgomery(x);
+		for (big_unsigned::Index j = 1; j < s; ++j)
 		{
-			return false;
+			x = context.square(x);
+			if (x == minus_one)
+			{
+				return true;
+			}
+			if (x == one)
+			{
+				return false;
+			}
 		}
 
-		big_unsigned s = 0, r = num - 1;
-		while (r % 2 == 0)
+		return false;
+	}
+
+	// the search behind generate_prime_number: walks up from a random start congruent to 1 modulo step,
+	// polling stopped before every candidate. Returns false without a prime once stopped is set
+	bool sieved_search(
+		uint64_t bit_length, 
+		uint64_t top_bits_count, 
+		const big_unsigned& step, 
+		const std::atomic<bool>& stopped, 
+		big_unsigned& prime)
+	{
+		const std::vector<uint32_t>& primes = small_primes();
+
+		// below the sieve bound a candidate may itself be one of the small primes, only Miller-Rabin decides
+		const size_t sieve_size = bit_length > prime_utils::SMALL_PRIMES_BITS ? primes.size() : 0;
+
+		std::vector<uint32_t> step_residues(sieve_size);
+		for (size_t i = 0; i < sieve_size; ++i)
 		{
-			s += 1;
-			r /= 2;
+			step_residues[i] = mod_small(step, primes[i]);
 		}
 
-		for (uint64_t i = 0; i < tests_count; ++i)
+		std::vector<uint32_t> residues(sieve_size);
+		while (true)
 		{
-			big_unsigned a = rand_int(2, num - 1);
-			big_unsigned x = modexp(a, r, num);
-			if (x != 1 && x != num - 1)
+			big_unsigned candidate = prime_utils::generate_prime_candidate(bit_length, top_bits_count);
+			candidate -= candidate % step;
+			candidate += 1;
+			if (candidate.bitLength() < bit_length)
+			{
+				candidate += step;
+			}
+
+			// residues of the random start are divided out once, every step then only adds
+			for (size_t i = 0; i < sieve_size; ++i)
+			{
+				residues[i] = mod_small(candidate, primes[i]);
+			}
+
+			for (uint64_t steps = 0; steps < prime_utils::PRIME_SEARCH_STEPS; ++steps)
 			{
-				big_unsigned j = 1;
-				while (j < s && x != num - 1)
+				if (stopped.load(std::memory_order_relaxed))
 				{
-					x = modexp(x, 2, num);
-					if (x == 1)
+					return false;
+				}
+
+				if (steps != 0)
+				{
+					candidate += step;
+					for (size_t i = 0; i < sieve_size; ++i)
 					{
-						return false;
+						residues[i] += step_residues[i];
+						if (residues[i] >= primes[i])
+						{
+							residues[i] -= primes[i];
+						}
 					}
-					j += 1;
 				}
-				if (x != num - 1)
+
+				// walked past bit_length bits, start over from a new random point
+				if (candidate.bitLength() > bit_length)
 				{
-					return false;
+					break;
+				}
+
+				bool divisible = false;
+				for (size_t i = 0; i < sieve_size && !divisible; ++i)
+				{
+					divisible = residues[i] == 0;
+				}
+
+				// a single round rejects nearly every composite left by the sieve before the full test runs
+				if (!divisible && prime_utils::is_prime(candidate, 1) && prime_utils::is_prime(candidate))
+				{
+					prime = std::move(candidate);
+					return true;
 				}
 			}
 		}
+	}
 
-		return true;
+	// runs search(worker, stopped, prime) once per worker of the pool; the first one to return true
+	// sets stopped for the others and its prime is returned
+	big_unsigned race_workers(
+		thread_pool& pool, 
+		const std::function<bool(uint64_t, const std::atomic<bool>&, big_unsigned&)>& search)
+	{
+		std::atomic<bool> stopped(false);
+		std::mutex result_mutex;
+		big_unsigned result;
+
+		pool.parallel_for(pool.get_threads_count(), [&](uint64_t worker)
+		{
+			big_unsigned prime;
+			if (search(worker, stopped, prime))
+			{
+				std::lock_guard<std::mutex> lock(result_mutex);
+				if (!stopped.exchange(true))
+				{
+					result = std::move(prime);
+				}
+			}
+		});
+
+		return result;
 	}
+}
 
-	big_unsigned generate_prime_candidate(uint64_t bit_length)
+namespace prime_utils
+{
+	bool is_prime(const big_unsigned &num, uint64_t tests_count /*= 10*/)
 	{
-		std::vector<uint8_t> bits;
-		bits.resize(bit_length);
+		if (num == 2 || num == 3)
+		{
+			return true;
+		}
+		else if (num <= 1 || !num.getBit(0))
+		{
+			return false;
+		}
 
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<unsigned long long> num_dist(0, 1);
+		big_unsigned::Index s = 1;
+		while (!num.getBit(s))
+		{
+			++s;
+		}
+		const big_unsigned r = num >> static_cast<int>(s);
 
-		for (uint64_t i = 0; i < bit_length; ++i)
+		const montgomery_context context(num);
+		for (uint64_t i = 0; i < tests_count; ++i)
 		{
-			bits[i] = static_cast<uint8_t>(num_dist(gen));
+			if (!_prime_utils::miller_rabin_round(context, rand_int(2, num - 1), r, s))
+			{
+				return false;
+			}
 		}
 
-		bits[0] = 1;
-		bits[bit_length - 1] = 1;
+		return true;
+	}
 
-		big_unsigned result = 0;
+	big_unsigned generate_prime_candidate(uint64_t bit_length, uint64_t top_bits_count /*= 1*/)
+	{
+		const uint64_t bytes_count = (bit_length + CHAR_BIT - 1) / CHAR_BIT;
+		std::vector<uint8_t> bytes(bytes_count);
 
-		for (uint64_t i = 0; i < bit_length; ++i)
+		// every byte straight from the device: a generator seeded from it once would leave at most
+		// 2^32 candidates, and the sieved walk from a candidate is deterministic
+		std::random_device device;
+		for (uint64_t i = 0; i < bytes_count; i += sizeof(uint32_t))
 		{
-			// optimization
-			if (bits[bit_length - i - 1] != 0)
+			const uint32_t word = device();
+			for (uint64_t j = 0; j < sizeof(uint32_t) && i + j < bytes_count; ++j)
 			{
-				const big_unsigned two = 2;
-				result += pow(two, i);
+				bytes[i + j] = static_cast<uint8_t>(word >> (j * CHAR_BIT));
 			}
 		}
 
-		return result;
+		// exactly bit_length bits with the top ones set, and odd
+		const uint64_t top_bit = (bit_length - 1) % CHAR_BIT;
+		bytes[0] &= static_cast<uint8_t>((1u << (top_bit + 1)) - 1);
+		for (uint64_t bit = bit_length - std::min(top_bits_count, bit_length); bit < bit_length; ++bit)
+		{
+			bytes[bytes_count - 1 - bit / CHAR_BIT] |= static_cast<uint8_t>(1u << (bit % CHAR_BIT));
+		}
+		bytes[bytes_count - 1] |= 1;
+
+		return big_unsigned(bytes.data(), bytes.size(), big_unsigned::bigEndian);
 	}
 
-	big_unsigned generate_prime_number(uint64_t bit_length)
+	big_unsigned generate_prime_number(uint64_t bit_length, uint64_t top_bits_count /*= 1*/)
 	{
+		const std::atomic<bool> never_stopped(false);
 		big_unsigned prime;
-		do
-		{
-			prime = generate_prime_candidate(bit_length);
-		} while (!is_prime(prime));
+		_prime_utils::sieved_search(bit_length, top_bits_count, 2, never_stopped, prime);
+
+		return prime;
+	}
+
+	big_unsigned generate_prime_number_with_divider(uint64_t bit_length, const big_unsigned& divider)
+	{
+		const std::atomic<bool> never_stopped(false);
+		big_unsigned prime;
+		_prime_utils::sieved_search(bit_length, 1, divider * 2, never_stopped, prime);
 
 		return prime;
 	}
@@ -102,4 +282,72 @@ namespace prime_utils
 
 		return prime;
 	}
+
+	bool is_prime(const big_unsigned& num, uint64_t tests_count, thread_pool& pool)
+	{
+		if (num == 2 || num == 3)
+		{
+			return true;
+		}
+		else if (num <= 1 || !num.getBit(0))
+		{
+			return false;
+		}
+
+		big_unsigned::Index s = 1;
+		while (!num.getBit(s))
+		{
+			++s;
+		}
+		const big_unsigned r = num >> static_cast<int>(s);
+
+		// multiply() keeps its scratch per thread, one context serves every worker
+		const montgomery_context context(num);
+		std::atomic<bool> composite(false);
+		pool.parallel_for(tests_count, [&](uint64_t)
+		{
+			if (!composite.load(std::memory_order_relaxed) && 
+				!_prime_utils::miller_rabin_round(context, rand_int(2, num - 1), r, s))
+			{
+				composite.store(true, std::memory_order_relaxed);
+			}
+		});
+
+		return !composite.load();
+	}
+
+	big_unsigned generate_prime_number(uint64_t bit_length, thread_pool& pool, uint64_t top_bits_count /*= 1*/)
+	{
+		return _prime_utils::race_workers(pool, [=](uint64_t, const std::atomic<bool>& stopped, big_unsigned& prime)
+		{
+			return _prime_utils::sieved_search(bit_length, top_bits_count, 2, stopped, prime);
+		});
+	}
+
+	big_unsigned generate_prime_number_with_divider(uint64_t bit_length, const big_unsigned& divider, thread_pool& pool)
+	{
+		const big_unsigned step = divider * 2;
+		return _prime_utils::race_workers(pool, [&](uint64_t, const std::atomic<bool>& stopped, big_unsigned& prime)
+		{
+			return _prime_utils::sieved_search(bit_length, 1, step, stopped, prime);
+		});
+	}
+
+	big_unsigned find_prime(const std::function<big_unsigned(uint64_t)>& candidate, thread_pool& pool)
+	{
+		const uint64_t workers_count = pool.get_threads_count();
+		return _prime_utils::race_workers(pool, [&](uint64_t worker, const std::atomic<bool>& stopped, big_unsigned& prime)
+		{
+			for (uint64_t index = worker; !stopped.load(std::memory_order_relaxed); index += workers_count)
+			{
+				prime = candidate(index);
+				if (is_prime(prime))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		});
+	}
 }
\ No newline at end of file
@@ -1,11 +1,37 @@
 #pragma once
 
+#include <functional>
+
 #include "big_integer.hpp"
+#include "thread_pool.hpp"
 
 namespace prime_utils
 {
+	// generate_prime_number sieves candidates by the odd primes below this bound (1899 of them)
+	const uint32_t SMALL_PRIMES_LIMIT = 16384;
+	const uint64_t SMALL_PRIMES_BITS = 14;
+	// steps by 2 from one random start before a new start is drawn
+	const uint64_t PRIME_SEARCH_STEPS = 1 << 16;
+
 	bool is_prime(const big_unsigned& num, uint64_t tests_count = 10);
-	big_unsigned generate_prime_candidate(uint64_t bit_length);
-	big_unsigned generate_prime_number(uint64_t bit_length);
+	// odd and exactly bit_length bits, the top top_bits_count of them set
+	big_unsigned generate_prime_candidate(uint64_t bit_length, uint64_t top_bits_count = 1);
+	// random odd start, then steps by 2 keeping its residues modulo the small primes; Miller-Rabin
+	// runs only on candidates none of them divides. Below SMALL_PRIMES_BITS the walk is not sieved
+	big_unsigned generate_prime_number(uint64_t bit_length, uint64_t top_bits_count = 1);
 	big_unsigned generate_prime_number(const big_unsigned& lower, const big_unsigned& upper);
+	// a prime p of bit_length bits with divider | p - 1, the same walk stepping by 2 * divider over
+	// p == 1 mod 2 * divider; divider must be well below 2^bit_length
+	big_unsigned generate_prime_number_with_divider(uint64_t bit_length, const big_unsigned& divider);
+
+	// The overloads below block on the pool, so they must not be called from one of its own tasks.
+
+	// witnesses are split between the workers, the rest are skipped once any of them proves num composite
+	bool is_prime(const big_unsigned& num, uint64_t tests_count, thread_pool& pool);
+	// every worker walks from its own random start, the first prime found stops the others
+	big_unsigned generate_prime_number(uint64_t bit_length, thread_pool& pool, uint64_t top_bits_count = 1);
+	big_unsigned generate_prime_number_with_divider(uint64_t bit_length, const big_unsigned& divider, thread_pool& pool);
+	// tests candidate(0), candidate(1), ... with worker i taking the indices equal to i modulo the workers count.
+	// Returns the first prime found, which is not necessarily the one of the lowest index
+	big_unsigned find_prime(const std::function<big_unsigned(uint64_t)>& candidate, thread_pool& pool);
 }
\ No newline at end of file
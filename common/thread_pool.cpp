@@ -0,0 +1,110 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+thread_pool::thread_pool(uint64_t threads_count)
+{
+	if (threads_count == 0)
+	{
+		threads_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	_workers.reserve(threads_count);
+	for (uint64_t i = 0; i < threads_count; ++i)
+	{
+		_workers.emplace_back(&thread_pool::_worker_loop, this);
+	}
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_tasks_mutex);
+		_stopping = true;
+	}
+	_tasks_condition.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+std::future<void> thread_pool::submit(std::function<void()> task)
+{
+	std::packaged_task<void()> packaged_task(std::move(task));
+	std::future<void> result = packaged_task.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(_tasks_mutex);
+		_tasks.push(std::move(packaged_task));
+	}
+	_tasks_condition.notify_one();
+
+	return result;
+}
+
+void thread_pool::parallel_for(uint64_t count, const std::function<void(uint64_t)>& func)
+{
+	parallel_for_chunks(count, [&func](uint64_t, uint64_t begin, uint64_t end)
+	{
+		for (uint64_t i = begin; i < end; ++i)
+		{
+			func(i);
+		}
+	});
+}
+
+void thread_pool::parallel_for_chunks(uint64_t count, const std::function<void(uint64_t, uint64_t, uint64_t)>& func)
+{
+	const uint64_t chunks_count = std::min<uint64_t>(count, _workers.size());
+
+	std::vector<std::future<void>> chunks;
+	chunks.reserve(chunks_count);
+	for (uint64_t chunk = 0; chunk < chunks_count; ++chunk)
+	{
+		const uint64_t begin = count * chunk / chunks_count;
+		const uint64_t end = count * (chunk + 1) / chunks_count;
+
+		chunks.push_back(submit([chunk, begin, end, &func]()
+		{
+			func(chunk, begin, end);
+		}));
+	}
+
+	// wait for every chunk before rethrowing, func must not be used after returning
+	for (auto& chunk : chunks)
+	{
+		chunk.wait();
+	}
+	for (auto& chunk : chunks)
+	{
+		chunk.get();
+	}
+}
+
+uint64_t thread_pool::get_threads_count() const
+{
+	return _workers.size();
+}
+
+void thread_pool::_worker_loop()
+{
+	while (true)
+	{
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_tasks_mutex);
+			_tasks_condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+
+			if (_tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+
+		task();
+	}
+}
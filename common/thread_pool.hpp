@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+  Fixed set of worker threads fed from one task queue. Tasks are run in submission order by
+  whichever worker is free; the destructor finishes the queued tasks before joining.
+*/
+class thread_pool
+{
+public:
+	// 0 picks std::thread::hardware_concurrency()
+	explicit thread_pool(uint64_t threads_count = 0);
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator = (const thread_pool&) = delete;
+
+	std::future<void> submit(std::function<void()> task);
+
+	// runs func(i) for every i in [0, count) split into one contiguous chunk per worker,
+	// returns when all of them are done and rethrows the first exception thrown by func
+	void parallel_for(uint64_t count, const std::function<void(uint64_t)>& func);
+	// the same split, func(chunk, begin, end) is called once per chunk; chunk is below
+	// get_threads_count(), so callers can keep state per chunk that no other thread touches
+	void parallel_for_chunks(uint64_t count, const std::function<void(uint64_t, uint64_t, uint64_t)>& func);
+
+	uint64_t get_threads_count() const;
+
+private:
+	void _worker_loop();
+
+	std::vector<std::thread> _workers;
+	std::queue<std::packaged_task<void()>> _tasks;
+
+	std::mutex _tasks_mutex;
+	std::condition_variable _tasks_condition;
+	bool _stopping = false;
+};
@@ -10,6 +10,14 @@ void BigInteger::operator =(const BigInteger &x) {
 	mag = x.mag;
 }
 
+void BigInteger::operator =(BigInteger &&x) noexcept {
+	if (this == &x)
+		return;
+	sign = x.sign;
+	mag = std::move(x.mag);
+	x.sign = zero;
+}
+
 BigInteger::BigInteger(const Blk *b, Index blen, Sign s) : mag(b, blen) {
 	switch (s) {
 	case zero:
@@ -162,12 +170,14 @@ BigInteger::CmpRes BigInteger::compareTo(const BigInteger &x) const {
 	if (cond) { \
 		BigInteger tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		*this = std::move(tmpThis); \
 		return; \
 	}
 
+/* add and subtract need no temporary: every input sign is read before the
+ * result sign is written, and the magnitude operations they call are safe
+ * for aliased calls. */
 void BigInteger::add(const BigInteger &a, const BigInteger &b) {
-	DTRT_ALIASED(this == &a || this == &b, add(a, b));
 	// If one argument is zero, copy the other.
 	if (a.sign == zero)
 		operator =(b);
@@ -203,7 +213,6 @@ void BigInteger::add(const BigInteger &a, const BigInteger &b) {
 void BigInteger::subtract(const BigInteger &a, const BigInteger &b) {
 	// Notice that this routine is identical to BigInteger::add,
 	// if one replaces b.sign by its opposite.
-	DTRT_ALIASED(this == &a || this == &b, subtract(a, b));
 	// If a is zero, copy b and flip its sign.  If b is zero, copy a.
 	if (a.sign == zero) {
 		mag = b.mag;
@@ -37,6 +37,12 @@ public:
 	// Assignment operator
 	void operator=(const BigInteger &x);
 
+	// Move constructor and assignment: the magnitude's blocks are taken over.
+	BigInteger(BigInteger &&x) noexcept : sign(x.sign), mag(std::move(x.mag)) {
+		x.sign = zero;
+	}
+	void operator=(BigInteger &&x) noexcept;
+
 	// Constructor that copies from a given array of blocks with a sign.
 	BigInteger(const Blk *b, Index blen, Sign s);
 
@@ -53,6 +59,11 @@ public:
 		sign = mag.isZero() ? zero : positive;
 	}
 
+	// Ditto, but takes over the blocks of a temporary BigUnsigned
+	BigInteger(BigUnsigned &&x) : mag(std::move(x)) {
+		sign = mag.isZero() ? zero : positive;
+	}
+
 	// Constructors from primitive integer types
 	BigInteger(unsigned long  x);
 	BigInteger(         long  x);
@@ -116,12 +127,23 @@ public:
 	/* Bitwise operators are not provided for BigIntegers.  Use
 	 * getMagnitude to get the magnitude and operate on that instead. */
 
-	BigInteger operator +(const BigInteger &x) const;
-	BigInteger operator -(const BigInteger &x) const;
+	/* As in BigUnsigned, +, -, /, % and unary - have overloads for
+	 * temporary operands that reuse the temporary's blocks. */
+	BigInteger operator +(const BigInteger &x) const &;
+	BigInteger operator +(const BigInteger &x) &&;
+	BigInteger operator +(BigInteger &&x) const &;
+	BigInteger operator +(BigInteger &&x) &&;
+	BigInteger operator -(const BigInteger &x) const &;
+	BigInteger operator -(const BigInteger &x) &&;
+	BigInteger operator -(BigInteger &&x) const &;
+	BigInteger operator -(BigInteger &&x) &&;
 	BigInteger operator *(const BigInteger &x) const;
-	BigInteger operator /(const BigInteger &x) const;
-	BigInteger operator %(const BigInteger &x) const;
-	BigInteger operator -() const;
+	BigInteger operator /(const BigInteger &x) const &;
+	BigInteger operator /(const BigInteger &x) &&;
+	BigInteger operator %(const BigInteger &x) const &;
+	BigInteger operator %(const BigInteger &x) &&;
+	BigInteger operator -() const &;
+	BigInteger operator -() &&;
 
 	void operator +=(const BigInteger &x);
 	void operator -=(const BigInteger &x);
@@ -141,40 +163,80 @@ public:
 /* These create an object to hold the result and invoke
  * the appropriate put-here operation on it, passing
  * this and x.  The new object is then returned. */
-inline BigInteger BigInteger::operator +(const BigInteger &x) const {
+inline BigInteger BigInteger::operator +(const BigInteger &x) const & {
 	BigInteger ans;
 	ans.add(*this, x);
 	return ans;
 }
-inline BigInteger BigInteger::operator -(const BigInteger &x) const {
+inline BigInteger BigInteger::operator +(const BigInteger &x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator +(BigInteger &&x) const & {
+	x.add(*this, x);
+	return std::move(x);
+}
+inline BigInteger BigInteger::operator +(BigInteger &&x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -(const BigInteger &x) const & {
 	BigInteger ans;
 	ans.subtract(*this, x);
 	return ans;
 }
+inline BigInteger BigInteger::operator -(const BigInteger &x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -(BigInteger &&x) const & {
+	x.subtract(*this, x);
+	return std::move(x);
+}
+inline BigInteger BigInteger::operator -(BigInteger &&x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
 inline BigInteger BigInteger::operator *(const BigInteger &x) const {
 	BigInteger ans;
 	ans.multiply(*this, x);
 	return ans;
 }
-inline BigInteger BigInteger::operator /(const BigInteger &x) const {
+inline BigInteger BigInteger::operator /(const BigInteger &x) const & {
 	if (x.isZero()) throw "BigInteger::operator /: division by zero";
 	BigInteger q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return q;
 }
-inline BigInteger BigInteger::operator %(const BigInteger &x) const {
+inline BigInteger BigInteger::operator /(const BigInteger &x) && {
+	if (x.isZero()) throw "BigInteger::operator /: division by zero";
+	BigInteger q;
+	divideWithRemainder(x, q);
+	return q;
+}
+inline BigInteger BigInteger::operator %(const BigInteger &x) const & {
 	if (x.isZero()) throw "BigInteger::operator %: division by zero";
 	BigInteger q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return r;
 }
-inline BigInteger BigInteger::operator -() const {
+inline BigInteger BigInteger::operator %(const BigInteger &x) && {
+	if (x.isZero()) throw "BigInteger::operator %: division by zero";
+	BigInteger q;
+	divideWithRemainder(x, q);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -() const & {
 	BigInteger ans;
 	ans.negate(*this);
 	return ans;
 }
+inline BigInteger BigInteger::operator -() && {
+	flipSign();
+	return std::move(*this);
+}
 
 /*
  * ASSIGNMENT OPERATORS
@@ -199,7 +261,7 @@ inline void BigInteger::operator /=(const BigInteger &x) {
 	BigInteger q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	*this = std::move(q);
 }
 inline void BigInteger::operator %=(const BigInteger &x) {
 	if (x.isZero()) throw "BigInteger::operator %=: division by zero";
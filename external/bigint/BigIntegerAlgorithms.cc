@@ -2,6 +2,7 @@
 #include "BigIntegerUtils.hh"
 #include "BigUnsigned.hh"
 #include <random>
+#include <algorithm>
 
 BigUnsigned gcd(BigUnsigned a, BigUnsigned b) {
 	BigUnsigned trash;
@@ -72,6 +73,48 @@ BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 	return ans;
 }
 
+BigUnsigned dual_modexp(const BigInteger &base1, const BigUnsigned &exponent1,
+		const BigInteger &base2, const BigUnsigned &exponent2,
+		const BigUnsigned &modulus) {
+	const unsigned int windowBits = 2, windowSize = 1 << windowBits;
+
+	// table[i * windowSize + j] == base1^i * base2^j % modulus
+	BigUnsigned table[windowSize * windowSize];
+	table[0] = BigUnsigned(1) % modulus;
+	table[1] = (base2 % modulus).getMagnitude();
+	table[windowSize] = (base1 % modulus).getMagnitude();
+	for (unsigned int j = 2; j < windowSize; j++)
+		table[j] = table[j - 1] * table[1] % modulus;
+	for (unsigned int i = 1; i < windowSize; i++) {
+		if (i > 1)
+			table[i * windowSize] = table[(i - 1) * windowSize] * table[windowSize] % modulus;
+		for (unsigned int j = 1; j < windowSize; j++)
+			table[i * windowSize + j] = table[i * windowSize] * table[j] % modulus;
+	}
+
+	BigUnsigned::Index bits = std::max(exponent1.bitLength(), exponent2.bitLength());
+	BigUnsigned::Index i = (bits + windowBits - 1) / windowBits * windowBits;
+	BigUnsigned ans = table[0];
+	// For each window of both exponents, most to least significant...
+	while (i > 0) {
+		i -= windowBits;
+		unsigned int digit1 = 0, digit2 = 0;
+		for (unsigned int b = windowBits; b > 0; b--) {
+			// Square.
+			ans *= ans;
+			ans %= modulus;
+			digit1 = (digit1 << 1) | (exponent1.getBit(i + b - 1) ? 1 : 0);
+			digit2 = (digit2 << 1) | (exponent2.getBit(i + b - 1) ? 1 : 0);
+		}
+		// And multiply by the table entry if either digit is nonzero.
+		if (digit1 != 0 || digit2 != 0) {
+			ans *= table[digit1 * windowSize + digit2];
+			ans %= modulus;
+		}
+	}
+	return ans;
+}
+
 BigUnsigned rand_int(const BigUnsigned& lower, const BigUnsigned& upper) {
 	auto lower_bound = bigUnsignedToString(lower).size(), upper_bound = bigUnsignedToString(upper).size();
 
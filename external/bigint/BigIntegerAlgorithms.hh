@@ -23,6 +23,14 @@ BigUnsigned modinv(const BigInteger &x, const BigUnsigned &n);
 BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 		const BigUnsigned &modulus);
 
+/* Returns (base1 ^ exponent1 * base2 ^ exponent2) % modulus.
+ * Straus-Shamir simultaneous exponentiation: both exponents are scanned two
+ * bits at a time against a table of the 15 products base1^i * base2^j, so
+ * the two powers share one chain of squarings. */
+BigUnsigned dual_modexp(const BigInteger &base1, const BigUnsigned &exponent1,
+		const BigInteger &base2, const BigUnsigned &exponent2,
+		const BigUnsigned &modulus);
+
 // returns random int in range;
 BigUnsigned rand_int(const BigUnsigned& lower, const BigUnsigned& upper);
 
@@ -12,6 +12,21 @@ BigUnsigned::BigUnsigned(         long  x) { initFromSignedPrimitive(x); }
 BigUnsigned::BigUnsigned(         int   x) { initFromSignedPrimitive(x); }
 BigUnsigned::BigUnsigned(         short x) { initFromSignedPrimitive(x); }
 
+BigUnsigned::BigUnsigned(const unsigned char *bytes, size_t count, ByteOrder order) {
+	const size_t blockBytes = sizeof(Blk);
+	Index blocks = Index((count + blockBytes - 1) / blockBytes);
+	allocate(blocks);
+	for (Index i = 0; i < blocks; i++)
+		blk[i] = 0;
+	// i counts bytes from the least significant one.
+	for (size_t i = 0; i < count; i++) {
+		unsigned char byte = (order == littleEndian) ? bytes[i] : bytes[count - 1 - i];
+		blk[i / blockBytes] |= Blk(byte) << (i % blockBytes * 8);
+	}
+	len = blocks;
+	zapLeadingZeros();
+}
+
 unsigned long  BigUnsigned::toUnsignedLong () const { return convertToPrimitive      <unsigned long >(); }
 unsigned int   BigUnsigned::toUnsignedInt  () const { return convertToPrimitive      <unsigned int  >(); }
 unsigned short BigUnsigned::toUnsignedShort() const { return convertToPrimitive      <unsigned short>(); }
@@ -19,6 +34,18 @@ long           BigUnsigned::toLong         () const { return convertToSignedPrim
 int            BigUnsigned::toInt          () const { return convertToSignedPrimitive<         int  >(); }
 short          BigUnsigned::toShort        () const { return convertToSignedPrimitive<         short>(); }
 
+void BigUnsigned::toBytes(unsigned char *bytes, size_t count, ByteOrder order) const {
+	const size_t blockBytes = sizeof(Blk);
+	// i counts bytes from the least significant one.
+	for (size_t i = 0; i < count; i++) {
+		unsigned char byte = (unsigned char)(getBlock(Index(i / blockBytes)) >> (i % blockBytes * 8));
+		if (order == littleEndian)
+			bytes[i] = byte;
+		else
+			bytes[count - 1 - i] = byte;
+	}
+}
+
 // BIT/BLOCK ACCESSORS
 
 void BigUnsigned::setBlock(Index i, Blk newBlock) {
@@ -107,22 +134,24 @@ BigUnsigned::CmpRes BigUnsigned::compareTo(const BigUnsigned &x) const {
  * 
  * Some of the put-here operations can probably handle aliased calls safely
  * without the extra copy because (for example) they process blocks strictly
- * right-to-left.  At some point I might determine which ones don't need the
- * copy, but my reasoning would need to be verified very carefully.  For now
- * I'll leave in the copy.
+ * right-to-left.  `add' and `subtract' are such operations: block i of the
+ * result depends only on block i of the inputs and the carry, so they now
+ * work in place and only have to keep the aliased input's blocks alive when
+ * growing the array.  The others still use the copy, which is moved (not
+ * copied again) into *this.
  */
 #define DTRT_ALIASED(cond, op) \
 	if (cond) { \
 		BigUnsigned tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		*this = std::move(tmpThis); \
 		return; \
 	}
 
 
 
 void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
-	DTRT_ALIASED(this == &a || this == &b, add(a, b));
+	// Aliased calls are handled in place, see above.
 	// If one argument is zero, copy the other.
 	if (a.len == 0) {
 		operator =(b);
@@ -145,11 +174,17 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 		a2 = &b;
 		b2 = &a;
 	}
-	// Set prelimiary length and make room in this BigUnsigned
-	len = a2->len + 1;
-	allocate(len);
+	// Remember the input lengths: an aliased input's len changes below.
+	Index aLen = a2->len, bLen = b2->len;
+	// Make room in this BigUnsigned, keeping the blocks of an aliased input,
+	// and set preliminary length
+	if (this == &a || this == &b)
+		allocateAndCopy(aLen + 1);
+	else
+		allocate(aLen + 1);
+	len = aLen + 1;
 	// For each block index that is present in both inputs...
-	for (i = 0, carryIn = false; i < b2->len; i++) {
+	for (i = 0, carryIn = false; i < bLen; i++) {
 		// Add input blocks
 		temp = a2->blk[i] + b2->blk[i];
 		// If a rollover occurred, the result is less than either input.
@@ -165,14 +200,14 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 	}
 	// If there is a carry left over, increase blocks until
 	// one does not roll over.
-	for (; i < a2->len && carryIn; i++) {
+	for (; i < aLen && carryIn; i++) {
 		temp = a2->blk[i] + 1;
 		carryIn = (temp == 0);
 		blk[i] = temp;
 	}
 	// If the carry was resolved but the larger number
 	// still has blocks, copy them over.
-	for (; i < a2->len; i++)
+	for (; i < aLen; i++)
 		blk[i] = a2->blk[i];
 	// Set the extra block if there's still a carry, decrease length otherwise
 	if (carryIn)
@@ -182,24 +217,31 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 }
 
 void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
-	DTRT_ALIASED(this == &a || this == &b, subtract(a, b));
+	// Aliased calls are handled in place, see above.
 	if (b.len == 0) {
 		// If b is zero, copy a.
 		operator =(a);
 		return;
-	} else if (a.len < b.len)
-		// If a is shorter than b, the result is negative.
+	} else if (a.compareTo(b) == less)
+		// The result is negative. Checked before any block is written, so
+		// that *this, which may be a or b, is left as it was.
 		throw "BigUnsigned::subtract: "
 			"Negative result in unsigned calculation";
 	// Some variables...
 	bool borrowIn, borrowOut;
 	Blk temp;
 	Index i;
-	// Set preliminary length and make room
-	len = a.len;
-	allocate(len);
+	// Remember the input lengths: an aliased input's len changes below.
+	Index aLen = a.len, bLen = b.len;
+	// Make room, keeping the blocks of an aliased b (an aliased a already
+	// fits), and set preliminary length
+	if (this == &b)
+		allocateAndCopy(aLen);
+	else
+		allocate(aLen);
+	len = aLen;
 	// For each block index that is present in both inputs...
-	for (i = 0, borrowIn = false; i < b.len; i++) {
+	for (i = 0, borrowIn = false; i < bLen; i++) {
 		temp = a.blk[i] - b.blk[i];
 		// If a reverse rollover occurred,
 		// the result is greater than the block from a.
@@ -214,20 +256,13 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
 	}
 	// If there is a borrow left over, decrease blocks until
 	// one does not reverse rollover.
-	for (; i < a.len && borrowIn; i++) {
+	for (; i < aLen && borrowIn; i++) {
 		borrowIn = (a.blk[i] == 0);
 		blk[i] = a.blk[i] - 1;
 	}
-	/* If there's still a borrow, the result is negative.
-	 * Throw an exception, but zero out this object so as to leave it in a
-	 * predictable state. */
-	if (borrowIn) {
-		len = 0;
-		throw "BigUnsigned::subtract: Negative result in unsigned calculation";
-	} else
-		// Copy over the rest of the blocks
-		for (; i < a.len; i++)
-			blk[i] = a.blk[i];
+	// a >= b, so no borrow is left; copy over the rest of the blocks
+	for (; i < aLen; i++)
+		blk[i] = a.blk[i];
 	// Zap leading zeros
 	zapLeadingZeros();
 }
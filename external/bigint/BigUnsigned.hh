@@ -2,6 +2,8 @@
 #define BIGUNSIGNED_H
 
 #include "NumberlikeArray.hh"
+#include <utility>
+#include <cstddef>
 
 /* A BigUnsigned object represents a nonnegative integer of size limited only by
  * available memory.  BigUnsigneds support most mathematical operators and can
@@ -44,12 +46,27 @@ public:
 		NumberlikeArray<Blk>::operator =(x);
 	}
 
+	// Move constructor: takes over the block array of x, no copy is made.
+	BigUnsigned(BigUnsigned &&x) noexcept : NumberlikeArray<Blk>(std::move(x)) {}
+
+	// Move assignment operator
+	void operator=(BigUnsigned &&x) noexcept {
+		NumberlikeArray<Blk>::operator =(std::move(x));
+	}
+
 	// Constructor that copies from a given array of blocks.
 	BigUnsigned(const Blk *b, Index blen) : NumberlikeArray<Blk>(b, blen) {
 		// Eliminate any leading zeros we may have been passed.
 		zapLeadingZeros();
 	}
 
+	// Byte order for the byte import and export below.
+	enum ByteOrder { bigEndian, littleEndian };
+
+	/* Constructor that packs count bytes straight into blocks, in O(count).
+	 * Leading zero bytes are allowed and dropped. */
+	BigUnsigned(const unsigned char *bytes, size_t count, ByteOrder order);
+
 	// Destructor.  NumberlikeArray does the delete for us.
 	~BigUnsigned() {}
 	
@@ -81,6 +98,10 @@ protected:
 	template <class X> X convertToPrimitive      () const;
 public:
 
+	/* Writes the number into exactly count bytes, zero-padded on the
+	 * most significant side; bytes that do not fit are dropped. */
+	void toBytes(unsigned char *bytes, size_t count, ByteOrder order) const;
+
 	// BIT/BLOCK ACCESSORS
 
 	// Expose these from NumberlikeArray directly.
@@ -170,6 +191,12 @@ public:
 	 *     // ``Aliased'' calls now do the right thing using a temporary
 	 *     // copy, but see note on `divideWithRemainder'.
 	 *     a.add(a, b); 
+	 *
+	 * The return-by-value operators +, -, / and % are also overloaded for
+	 * an rvalue left operand (and, for + and -, an rvalue right operand).
+	 * Those overloads compute the result into the block array of the
+	 * temporary and move it out, so a chain like `(a * b + c - d) % m'
+	 * allocates for the product only instead of once per operator.
 	 */
 
 	// COPY-LESS OPERATIONS
@@ -198,11 +225,19 @@ public:
 	 * `divideWithRemainder' instead. */
 
 	// OVERLOADED RETURN-BY-VALUE OPERATORS
-	BigUnsigned operator +(const BigUnsigned &x) const;
-	BigUnsigned operator -(const BigUnsigned &x) const;
+	BigUnsigned operator +(const BigUnsigned &x) const &;
+	BigUnsigned operator +(const BigUnsigned &x) &&;
+	BigUnsigned operator +(BigUnsigned &&x) const &;
+	BigUnsigned operator +(BigUnsigned &&x) &&;
+	BigUnsigned operator -(const BigUnsigned &x) const &;
+	BigUnsigned operator -(const BigUnsigned &x) &&;
+	BigUnsigned operator -(BigUnsigned &&x) const &;
+	BigUnsigned operator -(BigUnsigned &&x) &&;
 	BigUnsigned operator *(const BigUnsigned &x) const;
-	BigUnsigned operator /(const BigUnsigned &x) const;
-	BigUnsigned operator %(const BigUnsigned &x) const;
+	BigUnsigned operator /(const BigUnsigned &x) const &;
+	BigUnsigned operator /(const BigUnsigned &x) &&;
+	BigUnsigned operator %(const BigUnsigned &x) const &;
+	BigUnsigned operator %(const BigUnsigned &x) &&;
 	/* OK, maybe unary minus could succeed in one case, but it really
 	 * shouldn't be used, so it isn't provided. */
 	BigUnsigned operator &(const BigUnsigned &x) const;
@@ -244,35 +279,72 @@ public:
  * copy-less operations.  The copy-less operations are responsible for making
  * any necessary temporary copies to work around aliasing. */
 
-inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) const & {
 	BigUnsigned ans;
 	ans.add(*this, x);
 	return ans;
 }
-inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator +(BigUnsigned &&x) const & {
+	x.add(*this, x);
+	return std::move(x);
+}
+inline BigUnsigned BigUnsigned::operator +(BigUnsigned &&x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) const & {
 	BigUnsigned ans;
 	ans.subtract(*this, x);
 	return ans;
 }
+inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator -(BigUnsigned &&x) const & {
+	x.subtract(*this, x);
+	return std::move(x);
+}
+inline BigUnsigned BigUnsigned::operator -(BigUnsigned &&x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
 inline BigUnsigned BigUnsigned::operator *(const BigUnsigned &x) const {
 	BigUnsigned ans;
 	ans.multiply(*this, x);
 	return ans;
 }
-inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) const & {
 	if (x.isZero()) throw "BigUnsigned::operator /: division by zero";
 	BigUnsigned q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return q;
 }
-inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) && {
+	if (x.isZero()) throw "BigUnsigned::operator /: division by zero";
+	// The temporary is free to hold the remainder; no copy of it is needed.
+	BigUnsigned q;
+	divideWithRemainder(x, q);
+	return q;
+}
+inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) const & {
 	if (x.isZero()) throw "BigUnsigned::operator %: division by zero";
 	BigUnsigned q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return r;
 }
+inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) && {
+	if (x.isZero()) throw "BigUnsigned::operator %: division by zero";
+	BigUnsigned q;
+	divideWithRemainder(x, q);
+	return std::move(*this);
+}
 inline BigUnsigned BigUnsigned::operator &(const BigUnsigned &x) const {
 	BigUnsigned ans;
 	ans.bitAnd(*this, x);
@@ -315,7 +387,7 @@ inline void BigUnsigned::operator /=(const BigUnsigned &x) {
 	BigUnsigned q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	*this = std::move(q);
 }
 inline void BigUnsigned::operator %=(const BigUnsigned &x) {
 	if (x.isZero()) throw "BigUnsigned::operator %=: division by zero";
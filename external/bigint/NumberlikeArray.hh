@@ -65,6 +65,18 @@ public:
 	// Assignment operator
 	void operator=(const NumberlikeArray<Blk> &x);
 
+	/* Move constructor: steals the block array of x and leaves x as an
+	 * unallocated zero. */
+	NumberlikeArray(NumberlikeArray<Blk> &&x) noexcept
+			: cap(x.cap), len(x.len), blk(x.blk) {
+		x.cap = 0;
+		x.len = 0;
+		x.blk = NULL;
+	}
+
+	// Move assignment operator; same idea as the move constructor.
+	void operator=(NumberlikeArray<Blk> &&x) noexcept;
+
 	// Constructor that copies from a given array of blocks
 	NumberlikeArray(const Blk *b, Index blen);
 
@@ -147,6 +159,20 @@ void NumberlikeArray<Blk>::operator=(const NumberlikeArray<Blk> &x) {
 		blk[i] = x.blk[i];
 }
 
+template <class Blk>
+void NumberlikeArray<Blk>::operator=(NumberlikeArray<Blk> &&x) noexcept {
+	if (this == &x)
+		return;
+	// Drop our own array and take over the one of x
+	delete [] blk;
+	cap = x.cap;
+	len = x.len;
+	blk = x.blk;
+	x.cap = 0;
+	x.len = 0;
+	x.blk = NULL;
+}
+
 template <class Blk>
 NumberlikeArray<Blk>::NumberlikeArray(const Blk *b, Index blen)
 		: cap(blen), len(blen) {